@@ -0,0 +1,95 @@
+#include "alloc_counter.h"
+
+#include <stdlib.h>
+
+#include <new>
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+void* allocate(size_t size, size_t alignment) {
+    ++t_allocations;
+    for (;;) {
+        void* p = nullptr;
+        if (alignment <= alignof(std::max_align_t)) {
+            p = malloc(size == 0 ? 1 : size);
+        } else if (posix_memalign(&p, alignment, size == 0 ? 1 : size) != 0) {
+            p = nullptr;
+        }
+        if (p != nullptr) return p;
+        const std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* allocateNothrow(size_t size, size_t alignment) noexcept {
+    try {
+        return allocate(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}  // namespace
+
+namespace MoproboGui {
+
+uint64_t allocationCount() { return t_allocations; }
+
+void* countedAlloc(size_t size, void*) {
+    ++t_allocations;
+    return malloc(size);
+}
+
+void countedFree(void* p, void*) { free(p); }
+
+};  // namespace MoproboGui
+
+// malloc和posix_memalign的内存都用free释放，各种delete不必区分
+void* operator new(size_t size) { return allocate(size, 0); }
+void* operator new[](size_t size) { return allocate(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, 0);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, 0);
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+
+#if defined(__cpp_aligned_new)
+void* operator new(size_t size, std::align_val_t al) {
+    return allocate(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al) {
+    return allocate(size, static_cast<size_t>(al));
+}
+void* operator new(size_t size, std::align_val_t al,
+                   const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al,
+                     const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, static_cast<size_t>(al));
+}
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    free(p);
+}
+void operator delete(void* p, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    free(p);
+}
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    free(p);
+}
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file alloc_counter.h
+ * @brief
+ * 内存分配计数，仅链接进基准测试程序。
+ *
+ * alloc_counter.cpp替换了全局operator new/delete的全部形式(包括nothrow、
+ * sized和对齐的版本)，每次分配给本线程的计数加一；ImGui/ImPlot不经过
+ * operator new，用countedAlloc()/countedFree()通过
+ * ImGui::SetAllocatorFunctions()计入同一个计数。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MoproboGui {
+
+// 本线程到目前为止的内存分配次数
+uint64_t allocationCount();
+
+// 传给ImGui::SetAllocatorFunctions()
+void* countedAlloc(size_t size, void* user);
+void countedFree(void* p, void* user);
+
+};  // namespace MoproboGui
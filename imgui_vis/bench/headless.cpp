@@ -0,0 +1,209 @@
+#include "headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Implot/imgui_histogram.h"
+#include "Implot/imgui_oscilloscope.h"
+#include "alloc_counter.h"
+#include "cmd_option.h"
+#include "imgui.h"
+#include "implot.h"
+#include "soft_raster.h"
+
+namespace {
+
+int64_t monoNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    const size_t k = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+}  // namespace
+
+namespace MoproboGui {
+
+bool parseHeadless(int argc, char** argv, HeadlessConfig* config) {
+    bool headless = false;
+    std::vector<const char*> unknown;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        if (strcmp(arg, "--headless") == 0) {
+            headless = true;
+        } else if ((value = option(arg, "--frames")) != nullptr) {
+            config->frames = std::max(1, atoi(value));
+        } else if ((value = option(arg, "--channels")) != nullptr) {
+            config->channels = std::max(0, atoi(value));
+        } else if ((value = option(arg, "--rate")) != nullptr) {
+            config->rate = std::max(0.0, atof(value));
+        } else if ((value = option(arg, "--fps")) != nullptr) {
+            config->fps = std::max(1.0, atof(value));
+        } else if ((value = option(arg, "--size")) != nullptr) {
+            if (!parseSize(value, &config->width, &config->height)) {
+                fprintf(stderr, "无效的尺寸: %s\n", value);
+            }
+        } else if ((value = option(arg, "--png")) != nullptr) {
+            config->png = value;
+        } else {
+            unknown.push_back(arg);
+        }
+    }
+    // 其他参数可能属于别的模式，只在无界面模式下提示
+    if (headless) {
+        for (const char* arg : unknown) {
+            fprintf(stderr, "忽略未知参数: %s\n", arg);
+        }
+    }
+    return headless;
+}
+
+int runHeadless(const HeadlessConfig& config) {
+    ImGui::SetAllocatorFunctions(countedAlloc, countedFree);
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(static_cast<float>(config.width),
+                            static_cast<float>(config.height));
+    io.DeltaTime = static_cast<float>(1.0 / config.fps);
+    if (!config.font.empty()) {
+        FILE* file = fopen(config.font.c_str(), "rb");
+        if (file != nullptr) {
+            fclose(file);
+            io.Fonts->AddFontFromFileTTF(
+                config.font.c_str(), 16.0f, NULL,
+                io.Fonts->GetGlyphRangesChineseSimplifiedCommon());
+        }
+    }
+    unsigned char* font = nullptr;
+    int fontWidth = 0;
+    int fontHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&font, &fontWidth, &fontHeight);
+    // 没有GPU纹理，用像素地址作为字体纹理的标识
+    io.Fonts->SetTexID(font);
+    ImGui::StyleColorsLight();
+
+    SoftRasterizer raster(config.width, config.height);
+    raster.setFontTexture(font, font, fontWidth, fontHeight);
+
+    const std::string fold = "合成负载";
+    auto scope = OscilloscopeFactory::getInstance().createScopes(fold, fold);
+    std::vector<std::shared_ptr<OscilloscopeBuffer>> plots;
+    for (int c = 0; c < config.channels; ++c) {
+        plots.push_back(scope->createPlot("通道" + std::to_string(c)));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    const int total = config.warmup + config.frames;
+    const int64_t start = monoNs();
+    uint64_t sent = 0;
+    std::vector<int64_t> times;
+    std::vector<float> values;
+    std::vector<double> frameMs;
+    frameMs.reserve(config.frames);
+    double rasterMs = 0;
+    uint64_t vertices = 0;
+    uint64_t indices = 0;
+    uint64_t allocations = 0;
+
+    for (int frame = 0; frame < total; ++frame) {
+        // 按模拟时间生成本帧的数据，相当于采样线程在帧间写入
+        const uint64_t target = static_cast<uint64_t>(
+            std::llround((frame + 1) / config.fps * config.rate));
+        const size_t n = static_cast<size_t>(target - sent);
+        times.resize(n);
+        values.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            times[i] = start + static_cast<int64_t>((sent + i) * 1e9 /
+                                                    config.rate);
+        }
+        for (int c = 0; c < config.channels; ++c) {
+            const double freq = 1.0 + c;
+            for (size_t i = 0; i < n; ++i) {
+                const double t = (times[i] - start) * 1e-9;
+                values[i] = static_cast<float>(
+                    std::sin(2 * M_PI * freq * t) +
+                    0.1 * std::sin(2 * M_PI * 37 * freq * t));
+            }
+            plots[c]->addPoints(values.data(), times.data(), n);
+        }
+        sent = target;
+
+        const uint64_t allocationsBefore = allocationCount();
+        const auto begin = Clock::now();
+        ImGui::NewFrame();
+        if (frame == 0) {
+            // 示波器窗口铺满画面并展开合成负载，否则只会画出标题栏
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("软件示波器");
+            ImGui::GetStateStorage()->SetInt(ImGui::GetID(fold.c_str()), 1);
+            ImGui::End();
+        }
+        OscilloscopeFactory::getInstance().showMoproboWindow();
+        HistogramFactory::getInstance().showHistogram();
+        ImGui::Render();
+        const auto end = Clock::now();
+        if (frame < config.warmup) continue;
+
+        frameMs.push_back(Ms(end - begin).count());
+        allocations += allocationCount() - allocationsBefore;
+        const ImDrawData* drawData = ImGui::GetDrawData();
+        vertices += drawData->TotalVtxCount;
+        indices += drawData->TotalIdxCount;
+        if (!config.png.empty()) {
+            raster.clear(0.45f, 0.55f, 0.60f);
+            raster.render(drawData);
+            rasterMs += Ms(Clock::now() - end).count();
+        }
+    }
+
+    double busy = 0;
+    for (double ms : frameMs) busy += ms;
+    const double frames = static_cast<double>(config.frames);
+    printf("无界面模式: %dx%d, %d 通道 x %.0f 点/s, %d 帧(另有预热 %d 帧)\n",
+           config.width, config.height, config.channels, config.rate,
+           config.frames, config.warmup);
+    printf("帧率: %.1f fps  帧耗时 p50 %.3f ms  p95 %.3f ms  p99 %.3f ms\n",
+           frames * 1000 / busy, percentile(frameMs, 0.50),
+           percentile(frameMs, 0.95), percentile(frameMs, 0.99));
+    printf("每帧顶点: %.0f  索引: %.0f\n", vertices / frames,
+           indices / frames);
+    printf("每帧内存分配: %.1f 次\n", allocations / frames);
+
+    int ret = 0;
+    if (!config.png.empty()) {
+        printf("软件光栅化: %.2f ms/帧\n", rasterMs / frames);
+        std::string error;
+        if (raster.writePng(config.png, &error)) {
+            printf("最后一帧已保存到 %s\n", config.png.c_str());
+        } else {
+            fprintf(stderr, "保存PNG失败: %s\n", error.c_str());
+            ret = 1;
+        }
+    }
+
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+    return ret;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,45 @@
+/**
+ * @file headless.h
+ * @brief
+ * 无界面模式：不创建窗口和GL上下文，直接生成ImGui帧和ImDrawData，
+ * 用于在没有显示器和GPU的构建服务器上测量和回归测试示波器的绘制开销。
+ *
+ * 按配置生成若干通道的合成数据，以模拟时间每帧推进1/fps秒，
+ * 与主循环一样调用showMoproboWindow()和showHistogram()，尽快跑完指定帧数，
+ * 最后输出帧率、每帧顶点/索引数和每帧内存分配次数。
+ * 指定PNG文件时每帧用SoftRasterizer光栅化，保存最后一帧。
+ * 分配次数由alloc_counter.cpp统计，它替换了全局operator new，
+ * 因此无界面模式只编译进单独的基准测试程序，不进入主程序。
+ *
+ * 用法：imgui_bench --headless [--frames=N] [--channels=N] [--rate=Hz]
+ *                   [--fps=N] [--size=WxH] [--png=文件]
+ */
+
+#pragma once
+
+#include <string>
+
+namespace MoproboGui {
+
+struct HeadlessConfig {
+    int width{1280};
+    int height{720};
+    int frames{600};
+    int warmup{60};  // 不计入统计的帧数，让各缓冲的容量稳定下来
+    int channels{4};
+    double rate{1000};  // 每个通道每秒的点数
+    double fps{60};     // 模拟的帧率，决定每帧进入的点数
+    std::string font;   // 字体文件，为空或无法打开时使用ImGui默认字体
+    std::string png;    // 为空时不光栅化
+};
+
+/**
+ * @brief 解析命令行
+ * @return 是否指定了--headless，此时未识别的参数输出到stderr并忽略
+ */
+bool parseHeadless(int argc, char** argv, HeadlessConfig* config);
+
+// 运行无界面模式，结果输出到stdout，返回进程退出码
+int runHeadless(const HeadlessConfig& config);
+
+};  // namespace MoproboGui
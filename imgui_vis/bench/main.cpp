@@ -0,0 +1,25 @@
+#include <stdio.h>
+
+#include <string>
+
+#include "headless.h"
+#include "micro_bench.h"
+
+// 基准测试程序，与主程序分开构建，见alloc_counter.h
+int main(int args, char **argv) {
+    MoproboGui::HeadlessConfig headless;
+    if (MoproboGui::parseHeadless(args, argv, &headless)) {
+        headless.font = std::string(MY_MACRO) + "/fonts/simhei.ttf";
+        return MoproboGui::runHeadless(headless);
+    }
+    MoproboGui::MicroBenchConfig micro;
+    if (MoproboGui::parseMicroBench(args, argv, &micro)) {
+        return MoproboGui::runMicroBench(micro);
+    }
+    fprintf(stderr,
+            "用法: %s --headless [--frames=N] [--channels=N] [--rate=Hz]\n"
+            "        [--fps=N] [--size=WxH] [--png=文件]\n"
+            "      %s --micro[=名字] [--points=N]\n",
+            argv[0], argv[0]);
+    return 1;
+}
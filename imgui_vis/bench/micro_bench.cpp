@@ -0,0 +1,384 @@
+#include "micro_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Implot/imgui_oscilloscope.h"
+#include "alloc_counter.h"
+#include "cmd_option.h"
+#include "imgui.h"
+#include "implot.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Ns = std::chrono::duration<double, std::nano>;
+
+// GUI线程取数据的间隔
+constexpr std::chrono::milliseconds kDrainPeriod(1);
+
+// 预先生成的数据，计时不含生成的开销
+std::vector<float> samples(size_t n) {
+    std::vector<float> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = static_cast<float>(std::sin(i * 1e-3));
+    }
+    return values;
+}
+
+// 在单独的线程中每kDrainPeriod调用一次drain，结束前再取一次
+template <typename Drain>
+class Consumer {
+public:
+    explicit Consumer(Drain drain)
+        : m_drain(drain), m_thread([this] { run(); }) {}
+    ~Consumer() { stop(); }
+
+    void stop() {
+        if (!m_thread.joinable()) return;
+        m_running = false;
+        m_thread.join();
+    }
+
+private:
+    void run() {
+        while (m_running) {
+            m_drain();
+            std::this_thread::sleep_for(kDrainPeriod);
+        }
+        m_drain();
+    }
+
+    Drain m_drain;
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+};
+
+template <typename Drain>
+std::unique_ptr<Consumer<Drain>> startConsumer(Drain drain) {
+    return std::unique_ptr<Consumer<Drain>>(new Consumer<Drain>(drain));
+}
+
+// 每个速率写入的时长，以及分批写入的间隔
+constexpr double kSpscSeconds = 0.5;
+constexpr std::chrono::microseconds kSlice(1000);
+
+/**
+ * @brief 以rate点/s的平均速率写入kSpscSeconds秒，返回平均每点的耗时(ns)
+ * 每kSlice按速率写入一批点，只对写入计时，其余时间忙等到下一段开始。
+ * 结果含计时本身的开销，需减去同样速率下空写入的结果
+ */
+template <typename Push>
+double pacedPush(double rate, Push push) {
+    const double perSlice = rate * kSlice.count() * 1e-6;
+    const int slices = static_cast<int>(kSpscSeconds * 1e6 / kSlice.count());
+    double busy = 0;
+    size_t sent = 0;
+    auto next = Clock::now();
+    for (int s = 0; s < slices; ++s) {
+        const size_t target =
+            static_cast<size_t>(std::llround((s + 1) * perSlice));
+        const auto begin = Clock::now();
+        for (; sent < target; ++sent) push(sent);
+        busy += Ns(Clock::now() - begin).count();
+        next += kSlice;
+        while (Clock::now() < next) {
+        }
+    }
+    return sent > 0 ? busy / sent : 0;
+}
+
+void benchSpsc(size_t maxRate) {
+    printf("spsc: 每个速率写入 %.1f s, GUI线程每 %lld ms 取一次, "
+           "采样线程每点耗时(ns)\n",
+           kSpscSeconds, static_cast<long long>(kDrainPeriod.count()));
+    printf("  %12s %10s %10s %16s\n", "samples/s", "SpscRing", "dropped",
+           "mutex + vector");
+    for (double rate = 1000; rate <= static_cast<double>(maxRate);
+         rate *= 10) {
+        const size_t total = static_cast<size_t>(rate * kSpscSeconds);
+        const std::vector<float> values = samples(total);
+        const double overhead = pacedPush(rate, [](size_t) {});
+
+        OscilloscopeBuffer buffer("spsc");
+        auto consumer = startConsumer([&buffer] { buffer.drain(); });
+        const double ring = pacedPush(rate, [&](size_t i) {
+            buffer.addPointAt(values[i], static_cast<int64_t>(i) * 1000);
+        }) - overhead;
+        consumer->stop();
+
+        // 改动前的做法：采样线程加锁写入，GUI线程交换后搬入存储
+        std::mutex mutex;
+        std::vector<ScopeSample> pending;
+        std::vector<ScopeSample> taken;
+        ScopeStore store;
+        auto locked = startConsumer([&] {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.swap(taken);
+            }
+            store.append(taken.data(), taken.size());
+            taken.clear();
+        });
+        const double mutexNs = pacedPush(rate, [&](size_t i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back({static_cast<int64_t>(i) * 1000, values[i]});
+        }) - overhead;
+        locked->stop();
+
+        printf("  %12.0f %10.1f %10zu %16.1f\n", rate, ring, buffer.dropped(),
+               mutexNs);
+    }
+}
+
+void benchStore(size_t points) {
+    printf("store: %zu 点\n", points);
+    const std::vector<float> values = samples(points);
+    std::vector<int64_t> times(points);
+    for (size_t i = 0; i < points; ++i) {
+        times[i] = static_cast<int64_t>(i) * 1000;
+    }
+
+    // 写入：采样线程批量addPoints()，GUI线程drain()搬入分块存储和LOD
+    OscilloscopeBuffer buffer("store");
+    constexpr size_t kBlock = 4096;
+    const auto begin = Clock::now();
+    for (size_t i = 0; i < points; i += kBlock) {
+        buffer.addPoints(&values[i], &times[i], std::min(kBlock, points - i));
+        buffer.drain();
+    }
+    const double ns = Ns(Clock::now() - begin).count();
+    printf("  %-24s %8.1f ns/点\n", "addPoints + drain", ns / points);
+}
+
+// 创建ImGui和ImPlot上下文，不接后端，画面大小1280x720
+void createContexts() {
+    ImGui::SetAllocatorFunctions(countedAlloc, countedFree);
+    ImGui::CreateContext();
+    ImPlot::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280, 720);
+    io.DeltaTime = 1.0f / 60;
+    // 与opengl3后端相同，单个绘制列表可以超过65536个顶点
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    unsigned char* font = nullptr;
+    int width = 0;
+    int height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&font, &width, &height);
+}
+
+void destroyContexts() {
+    ImPlot::DestroyContext();
+    ImGui::DestroyContext();
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    const size_t k = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+void benchFrame(size_t points) {
+    constexpr int kChannels = 30;
+    constexpr int kWarmup = 10;
+    constexpr int kFrames = 200;
+    createContexts();
+    ImGuiIO& io = ImGui::GetIO();
+
+    const std::string fold = "帧耗时基准";
+    auto& factory = OscilloscopeFactory::getInstance();
+    auto scope = factory.createScopes(fold, fold);
+    const std::vector<float> values = samples(points);
+    std::vector<int64_t> times(points);
+    for (size_t i = 0; i < points; ++i) {
+        times[i] = static_cast<int64_t>(i) * 1000000;  // 1 kHz
+    }
+    for (int c = 0; c < kChannels; ++c) {
+        auto plot = scope->createPlot("通道" + std::to_string(c));
+        // 每批不超过队列容量，写入后立即取走
+        for (size_t i = 0; i < points; i += 4096) {
+            plot->addPoints(&values[i], &times[i],
+                            std::min<size_t>(4096, points - i));
+            plot->drain();
+        }
+    }
+
+    std::vector<double> frameMs;
+    uint64_t allocations = 0;
+    for (int frame = 0; frame < kWarmup + kFrames; ++frame) {
+        const uint64_t before = allocationCount();
+        const auto begin = Clock::now();
+        ImGui::NewFrame();
+        if (frame == 0) {
+            // 示波器窗口铺满画面并展开，否则只会画出标题栏
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("软件示波器");
+            ImGui::GetStateStorage()->SetInt(ImGui::GetID(fold.c_str()), 1);
+            ImGui::End();
+        }
+        factory.showMoproboWindow();
+        ImGui::Render();
+        const auto end = Clock::now();
+        if (frame < kWarmup) continue;
+        frameMs.push_back(
+            std::chrono::duration<double, std::milli>(end - begin).count());
+        allocations += allocationCount() - before;
+    }
+    factory.removeScopes(fold);
+    scope.reset();
+    destroyContexts();
+
+    printf("frame: %d 通道 x %zu 点, showMoproboWindow每帧\n", kChannels,
+           points);
+    printf("  p50 %.3f ms  p95 %.3f ms  内存分配 %.1f 次/帧\n",
+           percentile(frameMs, 0.50), percentile(frameMs, 0.95),
+           static_cast<double>(allocations) / kFrames);
+}
+
+// 每帧NewFrame到Render的平均耗时(ms)，plot在铺满画面的绘图区内绘制曲线
+template <typename Plot>
+double plotFrameMs(double xmin, double xmax, Plot plot) {
+    constexpr int kWarmup = 3;
+    constexpr int kFrames = 20;
+    ImGuiIO& io = ImGui::GetIO();
+    double ms = 0;
+    for (int frame = 0; frame < kWarmup + kFrames; ++frame) {
+        const auto begin = Clock::now();
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("plotline", nullptr, ImGuiWindowFlags_NoDecoration);
+        if (ImPlot::BeginPlot("##plotline", ImVec2(-1, -1),
+                              ImPlotFlags_CanvasOnly)) {
+            ImPlot::SetupAxesLimits(xmin, xmax, -1.5, 1.5, ImPlotCond_Always);
+            plot();
+            ImPlot::EndPlot();
+        }
+        ImGui::End();
+        ImGui::Render();
+        if (frame >= kWarmup) {
+            ms += std::chrono::duration<double, std::milli>(Clock::now() -
+                                                            begin)
+                      .count();
+        }
+    }
+    return ms / kFrames;
+}
+
+template <typename T>
+void benchPlotLineType(const char* type, size_t points) {
+    const int n = static_cast<int>(points);
+    std::vector<T> xs(points);
+    std::vector<T> ys(points);
+    // 同样的数据交织存放，stride不等于sizeof(T)，只能走逐点的RendererLineStrip
+    std::vector<T> xys(2 * points);
+    for (size_t i = 0; i < points; ++i) {
+        xs[i] = xys[2 * i] = static_cast<T>(static_cast<double>(i) / points);
+        ys[i] = xys[2 * i + 1] =
+            static_cast<T>(std::sin(2 * M_PI * 50 * xs[i]) +
+                           0.1 * std::sin(i * 1.7));
+    }
+    const int stride = static_cast<int>(2 * sizeof(T));
+    const struct {
+        const char* name;
+        double xmin;
+        double xmax;
+    } kViews[] = {{"全部", 0, 1}, {"20%", 0.4, 0.6}};
+    for (const auto& view : kViews) {
+        const double batch = plotFrameMs(view.xmin, view.xmax, [&] {
+            ImPlot::PlotLine("xy", xs.data(), ys.data(), n);
+        });
+        const double scalar = plotFrameMs(view.xmin, view.xmax, [&] {
+            ImPlot::PlotLine("xy", &xys[0], &xys[1], n, 0, 0, stride);
+        });
+        printf("  %-8s %-6s %10.2f %10.2f  %s\n", type, "xy", batch, scalar,
+               view.name);
+    }
+    for (const auto& view : kViews) {
+        const double batch = plotFrameMs(view.xmin, view.xmax, [&] {
+            ImPlot::PlotLine("values", ys.data(), n, 1.0 / n);
+        });
+        const double scalar = plotFrameMs(view.xmin, view.xmax, [&] {
+            ImPlot::PlotLine("values", &xys[1], n, 1.0 / n, 0, 0, 0, stride);
+        });
+        printf("  %-8s %-6s %10.2f %10.2f  %s\n", type, "values", batch,
+               scalar, view.name);
+    }
+}
+
+void benchPlotLine(size_t points) {
+    createContexts();
+
+    printf("plotline: %zu 点, 1280x720, NewFrame到Render的每帧耗时(ms)\n",
+           points);
+    printf("  %-8s %-6s %10s %10s  %s\n", "type", "data", "batch", "scalar",
+           "view");
+    benchPlotLineType<float>("float", points);
+    benchPlotLineType<double>("double", points);
+    destroyContexts();
+}
+
+struct MicroBench {
+    const char* name;
+    size_t points;  // 默认点数，spsc为最高的写入速率(点/s)
+    void (*run)(size_t points);
+};
+
+const MicroBench kBenches[] = {
+    {"spsc", 10000000, benchSpsc},
+    {"store", 1000000, benchStore},
+    {"frame", 20000, benchFrame},
+    {"plotline", 1000000, benchPlotLine},
+};
+
+}  // namespace
+
+bool parseMicroBench(int argc, char** argv, MicroBenchConfig* config) {
+    bool micro = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        if (strcmp(arg, "--micro") == 0) {
+            micro = true;
+        } else if ((value = option(arg, "--micro")) != nullptr) {
+            micro = true;
+            config->name = value;
+        } else if ((value = option(arg, "--points")) != nullptr) {
+            config->points = static_cast<size_t>(std::max(0L, atol(value)));
+        }
+    }
+    return micro;
+}
+
+int runMicroBench(const MicroBenchConfig& config) {
+    bool found = false;
+    for (const MicroBench& bench : kBenches) {
+        if (!config.name.empty() && config.name != bench.name) continue;
+        found = true;
+        bench.run(config.points > 0 ? config.points : bench.points);
+    }
+    if (!found) {
+        fprintf(stderr, "未知的基准: %s\n", config.name.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,41 @@
+/**
+ * @file micro_bench.h
+ * @brief
+ * 数据通路的微基准，每项与改动前的做法对比，结果输出到stdout：
+ *
+ *  - spsc：采样线程以1k点/s起每次乘10的各个速率，经OscilloscopeBuffer的
+ *    无锁队列写入，GUI线程每毫秒drain()一次；对比加锁写入std::vector、
+ *    GUI线程交换取走的做法。统计各速率下采样线程每个点的耗时和丢弃的点数，
+ *    --points为最高速率。
+ *  - store：批量写入并drain()进分块存储和LOD的每点耗时。
+ *  - frame：30个通道各有--points个点时，showMoproboWindow()每帧的耗时和
+ *    内存分配次数，绘制时读取曲线数据不拷贝，分配次数与点数无关。
+ *  - plotline：ImPlot::PlotLine绘制连续存放的数据(RendererLineStripBatch)
+ *    与同样的数据交织存放(逐点的RendererLineStrip)时，每帧的耗时，
+ *    分别显示全部数据和其中20%。
+ *
+ * 用法：imgui_bench --micro[=名字] [--points=N]
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace MoproboGui {
+
+struct MicroBenchConfig {
+    std::string name;  // 为空时运行全部
+    size_t points{0};  // 为0时每项使用各自的默认点数
+};
+
+/**
+ * @brief 解析命令行
+ * @return 是否指定了--micro
+ */
+bool parseMicroBench(int argc, char** argv, MicroBenchConfig* config);
+
+// 运行指定的基准，名字无效时返回1
+int runMicroBench(const MicroBenchConfig& config);
+
+};  // namespace MoproboGui
@@ -6,6 +6,7 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture identifier as void*/ImTextureID. Read the FAQ about ImTextureID!
 //  [x] Renderer: Desktop GL only: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [x] Renderer: Desktop GL only: Streaming vertex/index buffers, one upload per frame (orphaned or persistently mapped).
 
 // You can use unmodified imgui_impl_* files in your project. See examples/ folder for examples of using this.
 // Prefer including the entire imgui/ repository into your project (either as a copy or as a submodule), and only build the backends you need.
@@ -182,6 +183,31 @@
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_EXTENSIONS
 #endif
 
+// Desktop GL with our own loader: streaming uploads (see ImGui_ImplOpenGL3_Upload_).
+// Entry points missing from the stripped loader are fetched in ImGui_ImplOpenGL3_Init().
+#if !defined(IMGUI_IMPL_OPENGL_ES2) && !defined(IMGUI_IMPL_OPENGL_ES3) && !defined(IMGUI_IMPL_OPENGL_LOADER_CUSTOM)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+#define IMGUI_IMPL_OPENGL_STREAM_FRAMES     3   // Frames in flight sharing the persistently mapped buffers
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT                    0x0002
+#define GL_MAP_INVALIDATE_BUFFER_BIT        0x0008
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT               0x0040
+#define GL_MAP_COHERENT_BIT                 0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE       0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT          0x00000001
+#endif
+typedef void*     (APIENTRYP ImGui_PFNGLMAPBUFFERRANGEPROC)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (APIENTRYP ImGui_PFNGLUNMAPBUFFERPROC)(GLenum target);
+typedef void      (APIENTRYP ImGui_PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef GLsync    (APIENTRYP ImGui_PFNGLFENCESYNCPROC)(GLenum condition, GLbitfield flags);
+typedef GLenum    (APIENTRYP ImGui_PFNGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void      (APIENTRYP ImGui_PFNGLDELETESYNCPROC)(GLsync sync);
+#endif
+
 // [Debugging]
 //#define IMGUI_IMPL_OPENGL_DEBUG
 #ifdef IMGUI_IMPL_OPENGL_DEBUG
@@ -208,6 +234,22 @@ struct ImGui_ImplOpenGL3_Data
     GLsizeiptr      IndexBufferSize;
     bool            HasClipOrigin;
     bool            UseBufferSubData;
+    int             UploadMode;              // ImGui_ImplOpenGL3_Upload_XXX
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    bool            HasBufferStorage;        // GL 4.4 or GL_ARB_buffer_storage
+    GLsizeiptr      StreamVtxCapacity;       // Persistent: vertices/indices in each frame's region of the buffers
+    GLsizeiptr      StreamIdxCapacity;
+    int             StreamFrame;             // Persistent: region written by the current frame
+    ImDrawVert*     StreamVtxMapped;
+    ImDrawIdx*      StreamIdxMapped;
+    GLsync          StreamFences[IMGUI_IMPL_OPENGL_STREAM_FRAMES];
+    ImGui_PFNGLMAPBUFFERRANGEPROC   MapBufferRange;
+    ImGui_PFNGLUNMAPBUFFERPROC      UnmapBuffer;
+    ImGui_PFNGLBUFFERSTORAGEPROC    BufferStorage;
+    ImGui_PFNGLFENCESYNCPROC        FenceSync;
+    ImGui_PFNGLCLIENTWAITSYNCPROC   ClientWaitSync;
+    ImGui_PFNGLDELETESYNCPROC       DeleteSync;
+#endif
 
     ImGui_ImplOpenGL3_Data() { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -219,6 +261,37 @@ static ImGui_ImplOpenGL3_Data* ImGui_ImplOpenGL3_GetBackendData()
     return ImGui::GetCurrentContext() ? (ImGui_ImplOpenGL3_Data*)ImGui::GetIO().BackendRendererUserData : nullptr;
 }
 
+static bool ImGui_ImplOpenGL3_IsUploadModeSupported(ImGui_ImplOpenGL3_Data* bd, int mode)
+{
+    switch (mode)
+    {
+    case ImGui_ImplOpenGL3_Upload_BufferData:
+        return true;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    case ImGui_ImplOpenGL3_Upload_Orphan:
+        return bd->GlVersion >= 300 && bd->MapBufferRange && bd->UnmapBuffer;
+    case ImGui_ImplOpenGL3_Upload_Persistent:
+        return bd->GlVersion >= 320 && bd->HasBufferStorage && bd->MapBufferRange && bd->BufferStorage && bd->FenceSync && bd->ClientWaitSync && bd->DeleteSync;
+#endif
+    default:
+        return false;
+    }
+}
+
+static void ImGui_ImplOpenGL3_DestroyBuffers(ImGui_ImplOpenGL3_Data* bd)
+{
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    for (int i = 0; i < IMGUI_IMPL_OPENGL_STREAM_FRAMES; i++)
+        if (bd->StreamFences[i]) { bd->DeleteSync(bd->StreamFences[i]); bd->StreamFences[i] = nullptr; }
+    bd->StreamVtxCapacity = bd->StreamIdxCapacity = 0;
+    bd->StreamVtxMapped = nullptr;  // Deleting a buffer unmaps it
+    bd->StreamIdxMapped = nullptr;
+    bd->StreamFrame = 0;
+#endif
+    if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
+    if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
+}
+
 // OpenGL vertex attribute state (for ES 1.0 and ES 2.0 only)
 #ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
 struct ImGui_ImplOpenGL3_VtxAttribState
@@ -244,6 +317,32 @@ struct ImGui_ImplOpenGL3_VtxAttribState
 #endif
 
 // Functions
+bool    ImGui_ImplOpenGL3_SetUploadMode(int mode)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplOpenGL3_Init()?");
+    if (!ImGui_ImplOpenGL3_IsUploadModeSupported(bd, mode))
+        return false;
+    if (mode == bd->UploadMode)
+        return true;
+    bd->UploadMode = mode;
+    // Buffers with immutable storage can't be respecified: start over with fresh buffers
+    if (bd->VboHandle)
+    {
+        ImGui_ImplOpenGL3_DestroyBuffers(bd);
+        glGenBuffers(1, &bd->VboHandle);
+        glGenBuffers(1, &bd->ElementsHandle);
+    }
+    return true;
+}
+
+int     ImGui_ImplOpenGL3_GetUploadMode()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplOpenGL3_Init()?");
+    return bd->UploadMode;
+}
+
 bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
 {
     ImGuiIO& io = ImGui::GetIO();
@@ -332,9 +431,27 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
         const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
         if (extension != nullptr && strcmp(extension, "GL_ARB_clip_control") == 0)
             bd->HasClipOrigin = true;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+        if (extension != nullptr && strcmp(extension, "GL_ARB_buffer_storage") == 0)
+            bd->HasBufferStorage = true;
+#endif
     }
 #endif
 
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    // glXGetProcAddress() may return non-null for anything, support is decided from version/extensions
+    if (bd->GlVersion >= 440)
+        bd->HasBufferStorage = true;
+    bd->MapBufferRange = (ImGui_PFNGLMAPBUFFERRANGEPROC)imgl3wGetProcAddress("glMapBufferRange");
+    bd->UnmapBuffer = (ImGui_PFNGLUNMAPBUFFERPROC)imgl3wGetProcAddress("glUnmapBuffer");
+    bd->BufferStorage = (ImGui_PFNGLBUFFERSTORAGEPROC)imgl3wGetProcAddress("glBufferStorage");
+    bd->FenceSync = (ImGui_PFNGLFENCESYNCPROC)imgl3wGetProcAddress("glFenceSync");
+    bd->ClientWaitSync = (ImGui_PFNGLCLIENTWAITSYNCPROC)imgl3wGetProcAddress("glClientWaitSync");
+    bd->DeleteSync = (ImGui_PFNGLDELETESYNCPROC)imgl3wGetProcAddress("glDeleteSync");
+    if (!ImGui_ImplOpenGL3_SetUploadMode(ImGui_ImplOpenGL3_Upload_Persistent))
+        ImGui_ImplOpenGL3_SetUploadMode(ImGui_ImplOpenGL3_Upload_Orphan);
+#endif
+
     return true;
 }
 
@@ -359,6 +476,113 @@ void    ImGui_ImplOpenGL3_NewFrame()
         ImGui_ImplOpenGL3_CreateDeviceObjects();
 }
 
+// Bind vertex/index buffers and setup attributes for ImDrawVert, starting 'vtx_offset' vertices into the vertex buffer
+// (used to address a draw list inside the streamed buffer when glDrawElementsBaseVertex() is not available)
+static void ImGui_ImplOpenGL3_SetupVertexBuffers(ImGui_ImplOpenGL3_Data* bd, GLsizeiptr vtx_offset)
+{
+    const GLsizeiptr base = vtx_offset * (GLsizeiptr)sizeof(ImDrawVert);
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle));
+    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxPos));
+    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxUV));
+    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxColor));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(base + IM_OFFSETOF(ImDrawVert, pos))));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(base + IM_OFFSETOF(ImDrawVert, uv))));
+    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)(base + IM_OFFSETOF(ImDrawVert, col))));
+}
+
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+// Copy all draw lists into the vertex/index buffers (bound) with a single upload.
+// Outputs the position of this frame's first vertex/index in the buffers. Returns false if the frame couldn't be uploaded.
+static bool ImGui_ImplOpenGL3_StreamUpload(ImDrawData* draw_data, GLsizeiptr* vtx_base, GLsizeiptr* idx_base)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    const GLsizeiptr vtx_count = draw_data->TotalVtxCount;
+    const GLsizeiptr idx_count = draw_data->TotalIdxCount;
+    ImDrawVert* vtx_dst;
+    ImDrawIdx* idx_dst;
+    if (bd->UploadMode == ImGui_ImplOpenGL3_Upload_Persistent)
+    {
+        if (vtx_count > bd->StreamVtxCapacity || idx_count > bd->StreamIdxCapacity)
+        {
+            // Immutable storage: grow with some headroom by recreating the buffers
+            const GLsizeiptr min_capacity = 1 << 16;
+            const GLsizeiptr vtx_capacity = (vtx_count + vtx_count / 2 > min_capacity) ? vtx_count + vtx_count / 2 : min_capacity;
+            const GLsizeiptr idx_capacity = (idx_count + idx_count / 2 > min_capacity) ? idx_count + idx_count / 2 : min_capacity;
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const GLsizeiptr vtx_size = vtx_capacity * IMGUI_IMPL_OPENGL_STREAM_FRAMES * (GLsizeiptr)sizeof(ImDrawVert);
+            const GLsizeiptr idx_size = idx_capacity * IMGUI_IMPL_OPENGL_STREAM_FRAMES * (GLsizeiptr)sizeof(ImDrawIdx);
+            ImGui_ImplOpenGL3_DestroyBuffers(bd);
+            glGenBuffers(1, &bd->VboHandle);
+            glGenBuffers(1, &bd->ElementsHandle);
+            GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle));
+            GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle));
+            GL_CALL(bd->BufferStorage(GL_ARRAY_BUFFER, vtx_size, nullptr, flags));
+            GL_CALL(bd->BufferStorage(GL_ELEMENT_ARRAY_BUFFER, idx_size, nullptr, flags));
+            bd->StreamVtxMapped = (ImDrawVert*)bd->MapBufferRange(GL_ARRAY_BUFFER, 0, vtx_size, flags);
+            bd->StreamIdxMapped = (ImDrawIdx*)bd->MapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, idx_size, flags);
+            if (bd->StreamVtxMapped == nullptr || bd->StreamIdxMapped == nullptr)
+            {
+                // Fall back to orphaning from the next frame on
+                ImGui_ImplOpenGL3_SetUploadMode(ImGui_ImplOpenGL3_Upload_Orphan);
+                return false;
+            }
+            bd->StreamVtxCapacity = vtx_capacity;
+            bd->StreamIdxCapacity = idx_capacity;
+        }
+
+        // Wait (at most 1 second) until the GPU has finished reading the region written IMGUI_IMPL_OPENGL_STREAM_FRAMES frames ago
+        bd->StreamFrame = (bd->StreamFrame + 1) % IMGUI_IMPL_OPENGL_STREAM_FRAMES;
+        GLsync& fence = bd->StreamFences[bd->StreamFrame];
+        if (fence)
+        {
+            bd->ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            bd->DeleteSync(fence);
+            fence = nullptr;
+        }
+        *vtx_base = bd->StreamFrame * bd->StreamVtxCapacity;
+        *idx_base = bd->StreamFrame * bd->StreamIdxCapacity;
+        vtx_dst = bd->StreamVtxMapped + *vtx_base;
+        idx_dst = bd->StreamIdxMapped + *idx_base;
+    }
+    else
+    {
+        // Orphan the storage the GPU may still be reading, then map the new one without synchronization
+        const GLsizeiptr vtx_size = vtx_count * (GLsizeiptr)sizeof(ImDrawVert);
+        const GLsizeiptr idx_size = idx_count * (GLsizeiptr)sizeof(ImDrawIdx);
+        *vtx_base = *idx_base = 0;
+        GL_CALL(glBufferData(GL_ARRAY_BUFFER, vtx_size, nullptr, GL_STREAM_DRAW));
+        GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_size, nullptr, GL_STREAM_DRAW));
+        vtx_dst = (ImDrawVert*)bd->MapBufferRange(GL_ARRAY_BUFFER, 0, vtx_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        idx_dst = (ImDrawIdx*)bd->MapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, idx_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (vtx_dst == nullptr || idx_dst == nullptr)
+        {
+            if (vtx_dst) bd->UnmapBuffer(GL_ARRAY_BUFFER);
+            if (idx_dst) bd->UnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+            return false;
+        }
+    }
+
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        memcpy(vtx_dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        memcpy(idx_dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        vtx_dst += cmd_list->VtxBuffer.Size;
+        idx_dst += cmd_list->IdxBuffer.Size;
+    }
+
+    if (bd->UploadMode == ImGui_ImplOpenGL3_Upload_Orphan)
+    {
+        // GL_FALSE means the contents were corrupted while mapped (e.g. display mode change): skip the frame
+        const bool vtx_ok = bd->UnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        const bool idx_ok = bd->UnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_TRUE;
+        return vtx_ok && idx_ok;
+    }
+    return true;
+}
+#endif
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
@@ -421,15 +645,7 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     glBindVertexArray(vertex_array_object);
 #endif
 
-    // Bind vertex/index buffers and setup attributes for ImDrawVert
-    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle));
-    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxPos));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxUV));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxColor));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos)));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv)));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col)));
+    ImGui_ImplOpenGL3_SetupVertexBuffers(bd, 0);
 }
 
 // OpenGL3 Render function.
@@ -497,8 +713,24 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
+    // Streaming upload: all draw lists in one go, each draw list then starts at (vtx_base, idx_base) in the buffers
+    int cmd_lists_count = draw_data->CmdListsCount;
+    bool stream = false;
+    GLsizeiptr vtx_base = 0;
+    GLsizeiptr idx_base = 0;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    if (bd->UploadMode != ImGui_ImplOpenGL3_Upload_BufferData && draw_data->TotalVtxCount > 0 && draw_data->TotalIdxCount > 0)
+    {
+        stream = true;
+        if (!ImGui_ImplOpenGL3_StreamUpload(draw_data, &vtx_base, &idx_base))
+            cmd_lists_count = 0;
+        ImGui_ImplOpenGL3_SetupVertexBuffers(bd, 0); // Buffers may have been recreated
+    }
+#endif
+    GLsizeiptr bound_vtx_offset = 0;
+
     // Render command lists
-    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    for (int n = 0; n < cmd_lists_count; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
 
@@ -512,7 +744,11 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         // - See https://github.com/ocornut/imgui/issues/4468 and please report any corruption issues.
         const GLsizeiptr vtx_buffer_size = (GLsizeiptr)cmd_list->VtxBuffer.Size * (int)sizeof(ImDrawVert);
         const GLsizeiptr idx_buffer_size = (GLsizeiptr)cmd_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->UseBufferSubData)
+        if (stream)
+        {
+            // Already uploaded
+        }
+        else if (bd->UseBufferSubData)
         {
             if (bd->VertexBufferSize < vtx_buffer_size)
             {
@@ -541,7 +777,10 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                {
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+                    bound_vtx_offset = 0;
+                }
                 else
                     pcmd->UserCallback(cmd_list, pcmd);
             }
@@ -558,16 +797,36 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 
                 // Bind texture, Draw
                 GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID()));
+                const GLsizeiptr vtx_offset = vtx_base + (GLsizeiptr)pcmd->VtxOffset;
+                const GLsizeiptr idx_offset = (idx_base + (GLsizeiptr)pcmd->IdxOffset) * (GLsizeiptr)sizeof(ImDrawIdx);
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
                 if (bd->GlVersion >= 320)
-                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
+                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)idx_offset, (GLint)vtx_offset));
                 else
 #endif
-                GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
+                {
+                    if (vtx_offset != bound_vtx_offset)
+                    {
+                        ImGui_ImplOpenGL3_SetupVertexBuffers(bd, vtx_offset);
+                        bound_vtx_offset = vtx_offset;
+                    }
+                    GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)idx_offset));
+                }
             }
         }
+        if (stream)
+        {
+            vtx_base += cmd_list->VtxBuffer.Size;
+            idx_base += cmd_list->IdxBuffer.Size;
+        }
     }
 
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAMING
+    // Persistent: the region of this frame can be written again once the GPU is past this point
+    if (stream && cmd_lists_count > 0 && bd->UploadMode == ImGui_ImplOpenGL3_Upload_Persistent)
+        bd->StreamFences[bd->StreamFrame] = bd->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+
     // Destroy the temporary VAO
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
     GL_CALL(glDeleteVertexArrays(1, &vertex_array_object));
@@ -883,8 +1142,7 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
-    if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
-    if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
+    ImGui_ImplOpenGL3_DestroyBuffers(bd);
     if (bd->ShaderHandle)   { glDeleteProgram(bd->ShaderHandle); bd->ShaderHandle = 0; }
     ImGui_ImplOpenGL3_DestroyFontsTexture();
 }
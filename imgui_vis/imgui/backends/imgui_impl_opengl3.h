@@ -6,6 +6,7 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture identifier as void*/ImTextureID. Read the FAQ about ImTextureID!
 //  [x] Renderer: Desktop GL only: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [x] Renderer: Desktop GL only: Streaming vertex/index buffers, one upload per frame (orphaned or persistently mapped).
 
 // You can use unmodified imgui_impl_* files in your project. See examples/ folder for examples of using this.
 // Prefer including the entire imgui/ repository into your project (either as a copy or as a submodule), and only build the backends you need.
@@ -32,6 +33,18 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// Vertex/index upload strategy. Init() selects the best one supported by the context (Desktop GL only, ES always uses BufferData).
+enum ImGui_ImplOpenGL3_Upload_
+{
+    ImGui_ImplOpenGL3_Upload_BufferData = 0,    // glBufferData() from client memory for each draw list
+    ImGui_ImplOpenGL3_Upload_Orphan     = 1,    // GL 3.0+: orphan + glMapBufferRange(), all draw lists copied with a single upload per frame
+    ImGui_ImplOpenGL3_Upload_Persistent = 2,    // GL 4.4+ or ARB_buffer_storage: persistently mapped ring of frames guarded by fences, single upload per frame
+};
+
+// (Optional) Switch upload strategy, e.g. for benchmarking. Returns false if not supported by the current context. GL context must be current.
+IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_SetUploadMode(int mode);
+IMGUI_IMPL_API int      ImGui_ImplOpenGL3_GetUploadMode();
+
 // Specific OpenGL ES versions
 //#define IMGUI_IMPL_OPENGL_ES2     // Auto-detected on Emscripten
 //#define IMGUI_IMPL_OPENGL_ES3     // Auto-detected on iOS/Android
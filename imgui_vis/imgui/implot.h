@@ -234,6 +234,7 @@ enum ImPlotLineFlags_ {
     ImPlotLineFlags_SkipNaN     = 1 << 12, // NaNs values will be skipped instead of rendered as missing data
     ImPlotLineFlags_NoClip      = 1 << 13, // markers (if displayed) on the edge of a plot will not be clipped
     ImPlotLineFlags_Shaded      = 1 << 14, // a filled region between the line and horizontal origin will be rendered; use PlotShaded for more advanced cases
+    ImPlotLineFlags_SortedX     = 1 << 15, // x values are sorted in ascending order; only the visible range (plus one point on each side) is processed, found by binary search
 };
 
 // Flags for PlotScatter
@@ -304,7 +305,8 @@ enum ImPlotHistogramFlags_ {
     ImPlotHistogramFlags_Cumulative = 1 << 11, // each bin will contain its count plus the counts of all previous bins (not supported by PlotHistogram2D)
     ImPlotHistogramFlags_Density    = 1 << 12, // counts will be normalized, i.e. the PDF will be visualized, or the CDF will be visualized if Cumulative is also set
     ImPlotHistogramFlags_NoOutliers = 1 << 13, // exclude values outside the specifed histogram range from the count toward normalizing and cumulative counts
-    ImPlotHistogramFlags_ColMajor   = 1 << 14  // data will be read in column major order (not supported by PlotHistogram)
+    ImPlotHistogramFlags_ColMajor   = 1 << 14, // data will be read in column major order (not supported by PlotHistogram)
+    ImPlotHistogramFlags_Cached     = 1 << 15  // bin counts are reused while the data pointer(s), count, bins, range and flags are unchanged; call BustHistogramCache after modifying data in place
 };
 
 // Flags for PlotDigital (placeholder)
@@ -904,6 +906,9 @@ IMPLOT_TMP double PlotHistogram(const char* label_id, const T* values, int count
 // #xs an #ys will be used as the ranges. Otherwise, outlier values outside of range are not binned. The largest bin count or density is returned.
 IMPLOT_TMP double PlotHistogram2D(const char* label_id, const T* xs, const T* ys, int count, int x_bins=ImPlotBin_Sturges, int y_bins=ImPlotBin_Sturges, ImPlotRect range=ImPlotRect(), ImPlotHistogramFlags flags=0);
 
+// Discards the bin counts cached by histograms plotted with ImPlotHistogramFlags_Cached, e.g. after their data was modified in place.
+IMPLOT_API void BustHistogramCache();
+
 // Plots digital data. Digital plots do not respond to y drag or zoom, and are always referenced to the bottom of the plot.
 IMPLOT_TMP void PlotDigital(const char* label_id, const T* xs, const T* ys, int count, ImPlotDigitalFlags flags=0, int offset=0, int stride=sizeof(T));
 IMPLOT_API void PlotDigitalG(const char* label_id, ImPlotGetter getter, void* data, int count, ImPlotDigitalFlags flags=0);
@@ -1201,6 +1201,29 @@ struct ImPlotNextItemData {
     }
 };
 
+// Bin counts of a PlotHistogram/PlotHistogram2D item plotted with ImPlotHistogramFlags_Cached
+struct ImPlotHistogramCache {
+    ImGuiID              ID;
+    int                  LastFrame;
+    bool                 Valid;
+    // Inputs, as passed by the caller
+    const void*          Xs;
+    const void*          Ys;
+    int                  Count;
+    int                  TypeSize;
+    int                  XBins, YBins;
+    ImPlotRect           Range;
+    ImPlotHistogramFlags Flags;
+    // Results
+    int                  XBinsOut, YBinsOut;
+    ImPlotRect           RangeOut;
+    double               Width;
+    double               MaxCount;
+    ImVector<double>     Centers;
+    ImVector<double>     Counts;
+    ImPlotHistogramCache() { ID = 0; LastFrame = 0; Valid = false; Xs = Ys = NULL; Count = TypeSize = XBins = YBins = XBinsOut = YBinsOut = 0; Flags = 0; Width = MaxCount = 0; }
+};
+
 // Holds state information that must persist between calls to BeginPlot()/EndPlot()
 struct ImPlotContext {
     // Plot States
@@ -1236,6 +1259,9 @@ struct ImPlotContext {
     ImVector<double>   TempDouble1, TempDouble2;
     ImVector<int>      TempInt1;
 
+    // Histogram bin counts (see ImPlotHistogramFlags_Cached)
+    ImPool<ImPlotHistogramCache> HistogramCaches;
+
     // Misc
     int                DigitalPlotItemCnt;
     int                DigitalPlotOffset;
@@ -25,6 +25,10 @@
 #include "implot.h"
 #include "implot_internal.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 //-----------------------------------------------------------------------------
 // [SECTION] Macros and Defines
 //-----------------------------------------------------------------------------
@@ -59,6 +63,11 @@ static IMPLOT_INLINE float  ImInvSqrt(float x) { return _mm_cvtss_f32(_mm_rsqrt_
 static IMPLOT_INLINE float  ImInvSqrt(float x) { return 1.0f / sqrtf(x); }
 #endif
 
+// SIMD paths for batched line strips (see RendererLineStripBatch); other targets use the scalar fallback
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMPLOT_BATCH_SSE2
+#endif
+
 #define IMPLOT_NORMALIZE2F_OVER_ZERO(VX,VY) do { float d2 = VX*VX + VY*VY; if (d2 > 0.0f) { float inv_len = ImInvSqrt(d2); VX *= inv_len; VY *= inv_len; } } while (0)
 
 // Support for pre-1.82 versions. Users on 1.82+ can use 0 (default) flags to mean "all corners" but in order to support older versions we are more explicit.
@@ -129,26 +138,22 @@ IMPLOT_INLINE void GetLineRenderProps(const ImDrawList& draw_list, float& half_w
     }
 }
 
-IMPLOT_INLINE void PrimLine(ImDrawList& draw_list, const ImVec2& P1, const ImVec2& P2, float half_weight, ImU32 col, const ImVec2& tex_uv0, const ImVec2 tex_uv1) {
-    float dx = P2.x - P1.x;
-    float dy = P2.y - P1.y;
-    IMPLOT_NORMALIZE2F_OVER_ZERO(dx, dy);
-    dx *= half_weight;
-    dy *= half_weight;
-    draw_list._VtxWritePtr[0].pos.x = P1.x + dy;
-    draw_list._VtxWritePtr[0].pos.y = P1.y - dx;
+// Writes the quad of a line from (x1,y1) to (x2,y2), (dx,dy) being its direction scaled to half the weight
+IMPLOT_INLINE void PrimLineQuad(ImDrawList& draw_list, float x1, float y1, float x2, float y2, float dx, float dy, ImU32 col, const ImVec2& tex_uv0, const ImVec2& tex_uv1) {
+    draw_list._VtxWritePtr[0].pos.x = x1 + dy;
+    draw_list._VtxWritePtr[0].pos.y = y1 - dx;
     draw_list._VtxWritePtr[0].uv    = tex_uv0;
     draw_list._VtxWritePtr[0].col   = col;
-    draw_list._VtxWritePtr[1].pos.x = P2.x + dy;
-    draw_list._VtxWritePtr[1].pos.y = P2.y - dx;
+    draw_list._VtxWritePtr[1].pos.x = x2 + dy;
+    draw_list._VtxWritePtr[1].pos.y = y2 - dx;
     draw_list._VtxWritePtr[1].uv    = tex_uv0;
     draw_list._VtxWritePtr[1].col   = col;
-    draw_list._VtxWritePtr[2].pos.x = P2.x - dy;
-    draw_list._VtxWritePtr[2].pos.y = P2.y + dx;
+    draw_list._VtxWritePtr[2].pos.x = x2 - dy;
+    draw_list._VtxWritePtr[2].pos.y = y2 + dx;
     draw_list._VtxWritePtr[2].uv    = tex_uv1;
     draw_list._VtxWritePtr[2].col   = col;
-    draw_list._VtxWritePtr[3].pos.x = P1.x - dy;
-    draw_list._VtxWritePtr[3].pos.y = P1.y + dx;
+    draw_list._VtxWritePtr[3].pos.x = x1 - dy;
+    draw_list._VtxWritePtr[3].pos.y = y1 + dx;
     draw_list._VtxWritePtr[3].uv    = tex_uv1;
     draw_list._VtxWritePtr[3].col   = col;
     draw_list._VtxWritePtr += 4;
@@ -162,6 +167,15 @@ IMPLOT_INLINE void PrimLine(ImDrawList& draw_list, const ImVec2& P1, const ImVec
     draw_list._VtxCurrentIdx += 4;
 }
 
+IMPLOT_INLINE void PrimLine(ImDrawList& draw_list, const ImVec2& P1, const ImVec2& P2, float half_weight, ImU32 col, const ImVec2& tex_uv0, const ImVec2 tex_uv1) {
+    float dx = P2.x - P1.x;
+    float dy = P2.y - P1.y;
+    IMPLOT_NORMALIZE2F_OVER_ZERO(dx, dy);
+    dx *= half_weight;
+    dy *= half_weight;
+    PrimLineQuad(draw_list, P1.x, P1.y, P2.x, P2.y, dx, dy, col, tex_uv0, tex_uv1);
+}
+
 IMPLOT_INLINE void PrimRectFill(ImDrawList& draw_list, const ImVec2& Pmin, const ImVec2& Pmax, ImU32 col, const ImVec2& uv) {
     draw_list._VtxWritePtr[0].pos   = Pmin;
     draw_list._VtxWritePtr[0].uv    = uv;
@@ -617,6 +631,36 @@ struct GetterLoop {
     const int Count;
 };
 
+template <typename _Getter>
+struct GetterSlice {
+    GetterSlice(const _Getter& getter, int first, int count) : Getter(getter), First(first), Count(count) { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return Getter(First + idx);
+    }
+    const _Getter& Getter;
+    const int First;
+    const int Count;
+};
+
+// Finds the slice of a getter with ascending x values that is visible in range, plus one point on each side
+// so that lines still reach the plot edges. Runs in O(log(count)) instead of culling every primitive.
+template <typename _Getter>
+void GetVisibleSliceX(const _Getter& getter, const ImPlotRange& range, int* first, int* count) {
+    int lo = 0, hi = getter.Count;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (getter(mid).x < range.Min) lo = mid + 1; else hi = mid;
+    }
+    const int begin = lo;
+    hi = getter.Count;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (getter(mid).x <= range.Max) lo = mid + 1; else hi = mid;
+    }
+    *first = ImMax(begin - 1, 0);
+    *count = ImMin(lo + 1, getter.Count) - *first;
+}
+
 template <typename T>
 struct GetterError {
     GetterError(const T* xs, const T* ys, const T* neg, const T* pos, int count, int offset, int stride) :
@@ -923,6 +967,176 @@ struct RendererLineStripSkip : RendererBase {
     mutable ImVec2 UV1;
 };
 
+/// Source of a batched line strip: contiguous x (or x linear in the index) and y arrays.
+template <typename T>
+struct BatchLineSource {
+    const T* Xs;     // NULL when x = XM * index + XB
+    double   XM, XB;
+    const T* Ys;
+    int      First;  // getter index of Xs[0] and Ys[0]
+    int      Count;
+};
+
+#if defined(__AVX__)
+template <typename T> IMPLOT_INLINE __m256d BatchLoad4(const T* p) { return _mm256_set_pd((double)p[3], (double)p[2], (double)p[1], (double)p[0]); }
+IMPLOT_INLINE __m256d BatchLoad4(const float* p)  { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+IMPLOT_INLINE __m256d BatchLoad4(const double* p) { return _mm256_loadu_pd(p); }
+#endif
+#ifdef IMPLOT_BATCH_SSE2
+template <typename T> IMPLOT_INLINE __m128d BatchLoad2(const T* p) { return _mm_set_pd((double)p[1], (double)p[0]); }
+IMPLOT_INLINE __m128d BatchLoad2(const float* p)  { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p))); }
+IMPLOT_INLINE __m128d BatchLoad2(const double* p) { return _mm_loadu_pd(p); }
+#endif
+
+// out[i] = tf(data[i]) for a linear transformer, 8 points per iteration. Same double precision math as Transformer1.
+template <typename T>
+void TransformBatch(const Transformer1& tf, const T* data, int count, float* out) {
+    int i = 0;
+#if defined(__AVX__)
+    const __m256d pix = _mm256_set1_pd(tf.PixMin), plt = _mm256_set1_pd(tf.PltMin), m = _mm256_set1_pd(tf.M);
+    for (; i + 8 <= count; i += 8) {
+        const __m256d a = _mm256_add_pd(pix, _mm256_mul_pd(m, _mm256_sub_pd(BatchLoad4(data + i), plt)));
+        const __m256d b = _mm256_add_pd(pix, _mm256_mul_pd(m, _mm256_sub_pd(BatchLoad4(data + i + 4), plt)));
+        _mm_storeu_ps(out + i, _mm256_cvtpd_ps(a));
+        _mm_storeu_ps(out + i + 4, _mm256_cvtpd_ps(b));
+    }
+#elif defined(IMPLOT_BATCH_SSE2)
+    const __m128d pix = _mm_set1_pd(tf.PixMin), plt = _mm_set1_pd(tf.PltMin), m = _mm_set1_pd(tf.M);
+    for (; i + 8 <= count; i += 8) {
+        __m128 r[4];
+        for (int k = 0; k < 4; ++k) {
+            const __m128d v = _mm_add_pd(pix, _mm_mul_pd(m, _mm_sub_pd(BatchLoad2(data + i + 2 * k), plt)));
+            r[k] = _mm_cvtpd_ps(v);
+        }
+        _mm_storeu_ps(out + i, _mm_movelh_ps(r[0], r[1]));
+        _mm_storeu_ps(out + i + 4, _mm_movelh_ps(r[2], r[3]));
+    }
+#endif
+    for (; i < count; ++i)
+        out[i] = tf((double)data[i]);
+}
+
+// out[i] = tf(m * (first + i) + b), the same as IndexerLin followed by Transformer1
+inline void TransformBatchLin(const Transformer1& tf, double m, double b, int first, int count, float* out) {
+    int i = 0;
+#ifdef IMPLOT_BATCH_SSE2
+    const __m128d pix = _mm_set1_pd(tf.PixMin), plt = _mm_set1_pd(tf.PltMin), scale = _mm_set1_pd(tf.M);
+    const __m128d vm = _mm_set1_pd(m), vb = _mm_set1_pd(b), step = _mm_set1_pd(4.0);
+    __m128d idx0 = _mm_set_pd(first + 1.0, first + 0.0);
+    __m128d idx1 = _mm_set_pd(first + 3.0, first + 2.0);
+    for (; i + 4 <= count; i += 4) {
+        const __m128d x0 = _mm_add_pd(_mm_mul_pd(vm, idx0), vb);
+        const __m128d x1 = _mm_add_pd(_mm_mul_pd(vm, idx1), vb);
+        const __m128 r0 = _mm_cvtpd_ps(_mm_add_pd(pix, _mm_mul_pd(scale, _mm_sub_pd(x0, plt))));
+        const __m128 r1 = _mm_cvtpd_ps(_mm_add_pd(pix, _mm_mul_pd(scale, _mm_sub_pd(x1, plt))));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(r0, r1));
+        idx0 = _mm_add_pd(idx0, step);
+        idx1 = _mm_add_pd(idx1, step);
+    }
+#endif
+    for (; i < count; ++i)
+        out[i] = tf(m * (first + i) + b);
+}
+
+/// RendererLineStrip for contiguous data on linear axes. Points are transformed to pixels a block at a time
+/// and segments are culled and expanded four at a time with SSE2; the output is identical to RendererLineStrip.
+/// Used through RenderPrimitiveRange() instead of per-primitive Render() calls.
+template <typename T>
+struct RendererLineStripBatch : RendererBase {
+    enum { Block = 512 }; // points transformed per block
+    RendererLineStripBatch(const BatchLineSource<T>& src, ImU32 col, float weight) :
+        RendererBase(src.Count - 1, 6, 4),
+        Src(src),
+        Col(col),
+        HalfWeight(ImMax(1.0f,weight)*0.5f),
+        BlockFirst(0),
+        BlockPrims(0)
+    { }
+    void Init(ImDrawList& draw_list) const {
+        GetLineRenderProps(draw_list, HalfWeight, UV0, UV1);
+    }
+    // Transforms the points of up to Block segments starting at prim
+    void Load(int prim) const {
+        const int points = ImMin((int)Block + 1, Src.Count - prim);
+        if (Src.Xs != NULL)
+            TransformBatch(this->Transformer.Tx, Src.Xs + prim, points, Px);
+        else
+            TransformBatchLin(this->Transformer.Tx, Src.XM, Src.XB, Src.First + prim, points, Px);
+        TransformBatch(this->Transformer.Ty, Src.Ys + prim, points, Py);
+        BlockFirst = prim;
+        BlockPrims = points - 1;
+    }
+    // Renders prims [prim, prim_end) and returns how many were culled
+    unsigned int RenderRange(ImDrawList& draw_list, const ImRect& cull_rect, int prim, int prim_end) const {
+        unsigned int culled = 0;
+        while (prim < prim_end) {
+            if (prim < BlockFirst || prim >= BlockFirst + BlockPrims)
+                Load(prim);
+            const int end = ImMin(prim_end, BlockFirst + BlockPrims);
+            culled += RenderBlock(draw_list, cull_rect, prim - BlockFirst, end - BlockFirst);
+            prim = end;
+        }
+        return culled;
+    }
+    unsigned int RenderBlock(ImDrawList& draw_list, const ImRect& cull_rect, int i, int end) const {
+        unsigned int culled = 0;
+#ifdef IMPLOT_BATCH_SSE2
+        const __m128 min_x = _mm_set1_ps(cull_rect.Min.x), max_x = _mm_set1_ps(cull_rect.Max.x);
+        const __m128 min_y = _mm_set1_ps(cull_rect.Min.y), max_y = _mm_set1_ps(cull_rect.Max.y);
+        const __m128 half_weight = _mm_set1_ps(HalfWeight);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= end; i += 4) {
+            const __m128 x1 = _mm_loadu_ps(Px + i), x2 = _mm_loadu_ps(Px + i + 1);
+            const __m128 y1 = _mm_loadu_ps(Py + i), y2 = _mm_loadu_ps(Py + i + 1);
+            // same test as cull_rect.Overlaps(ImRect(ImMin(P1, P2), ImMax(P1, P2))), including NaN handling
+            const __m128 in_y = _mm_and_ps(_mm_cmplt_ps(_mm_min_ps(y1, y2), max_y), _mm_cmpgt_ps(_mm_max_ps(y1, y2), min_y));
+            const __m128 in_x = _mm_and_ps(_mm_cmplt_ps(_mm_min_ps(x1, x2), max_x), _mm_cmpgt_ps(_mm_max_ps(x1, x2), min_x));
+            const int visible = _mm_movemask_ps(_mm_and_ps(in_x, in_y));
+            if (visible == 0) {
+                culled += 4;
+                continue;
+            }
+            // same as IMPLOT_NORMALIZE2F_OVER_ZERO followed by scaling with the half weight
+            __m128 dx = _mm_sub_ps(x2, x1);
+            __m128 dy = _mm_sub_ps(y2, y1);
+            const __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+            const __m128 nonzero = _mm_cmpgt_ps(d2, zero);
+            const __m128 inv_len = _mm_rsqrt_ps(d2);
+            dx = _mm_or_ps(_mm_and_ps(nonzero, _mm_mul_ps(dx, inv_len)), _mm_andnot_ps(nonzero, dx));
+            dy = _mm_or_ps(_mm_and_ps(nonzero, _mm_mul_ps(dy, inv_len)), _mm_andnot_ps(nonzero, dy));
+            float dxs[4], dys[4];
+            _mm_storeu_ps(dxs, _mm_mul_ps(dx, half_weight));
+            _mm_storeu_ps(dys, _mm_mul_ps(dy, half_weight));
+            for (int k = 0; k < 4; ++k) {
+                if (visible & (1 << k))
+                    PrimLineQuad(draw_list, Px[i+k], Py[i+k], Px[i+k+1], Py[i+k+1], dxs[k], dys[k], Col, UV0, UV1);
+                else
+                    culled++;
+            }
+        }
+#endif
+        for (; i < end; ++i) {
+            const ImVec2 P1(Px[i], Py[i]);
+            const ImVec2 P2(Px[i+1], Py[i+1]);
+            if (!cull_rect.Overlaps(ImRect(ImMin(P1, P2), ImMax(P1, P2)))) {
+                culled++;
+                continue;
+            }
+            PrimLine(draw_list,P1,P2,HalfWeight,Col,UV0,UV1);
+        }
+        return culled;
+    }
+    const BatchLineSource<T> Src;
+    const ImU32 Col;
+    mutable float HalfWeight;
+    mutable ImVec2 UV0;
+    mutable ImVec2 UV1;
+    mutable int BlockFirst;
+    mutable int BlockPrims;
+    mutable float Px[Block + 1];
+    mutable float Py[Block + 1];
+};
+
 template <class _Getter>
 struct RendererLineSegments1 : RendererBase {
     RendererLineSegments1(const _Getter& getter, ImU32 col, float weight) :
@@ -1355,6 +1569,22 @@ struct RendererRectC : RendererBase {
 // [SECTION] RenderPrimitives
 //-----------------------------------------------------------------------------
 
+/// Renders prims [idx, idx_end) and returns how many were culled.
+template <class _Renderer>
+IMPLOT_INLINE unsigned int RenderPrimitiveRange(const _Renderer& renderer, ImDrawList& draw_list, const ImRect& cull_rect, unsigned int idx, unsigned int idx_end) {
+    unsigned int culled = 0;
+    for (; idx != idx_end; ++idx) {
+        if (!renderer.Render(draw_list, cull_rect, idx))
+            culled++;
+    }
+    return culled;
+}
+
+template <typename T>
+IMPLOT_INLINE unsigned int RenderPrimitiveRange(const RendererLineStripBatch<T>& renderer, ImDrawList& draw_list, const ImRect& cull_rect, unsigned int idx, unsigned int idx_end) {
+    return renderer.RenderRange(draw_list, cull_rect, (int)idx, (int)idx_end);
+}
+
 /// Renders primitive shapes in bulk as efficiently as possible.
 template <class _Renderer>
 void RenderPrimitivesEx(const _Renderer& renderer, ImDrawList& draw_list, const ImRect& cull_rect) {
@@ -1386,10 +1616,8 @@ void RenderPrimitivesEx(const _Renderer& renderer, ImDrawList& draw_list, const
             draw_list.PrimReserve(cnt * renderer.IdxConsumed, cnt * renderer.VtxConsumed);
         }
         prims -= cnt;
-        for (unsigned int ie = idx + cnt; idx != ie; ++idx) {
-            if (!renderer.Render(draw_list, cull_rect, idx))
-                prims_culled++;
-        }
+        prims_culled += RenderPrimitiveRange(renderer, draw_list, cull_rect, idx, idx + cnt);
+        idx += cnt;
     }
     if (prims_culled > 0)
         draw_list.PrimUnreserve(prims_culled * renderer.IdxConsumed, prims_culled * renderer.VtxConsumed);
@@ -1409,6 +1637,72 @@ void RenderPrimitives2(const _Getter1& getter1, const _Getter2& getter2, Args...
     RenderPrimitivesEx(_Renderer<_Getter1,_Getter2>(getter1,getter2,args...), draw_list, cull_rect);
 }
 
+template <typename T>
+IMPLOT_INLINE bool IsContiguous(const IndexerIdx<T>& indexer) {
+    return indexer.Offset == 0 && indexer.Stride == (int)sizeof(T);
+}
+
+/// Describes getter points [first, first + count) for RendererLineStripBatch if their layout allows it.
+template <typename _IndexerX, typename T>
+bool GetBatchLineSource(const GetterXY<_IndexerX,IndexerIdx<T>>&, int, int, BatchLineSource<T>*) {
+    return false;
+}
+
+template <typename T>
+bool GetBatchLineSource(const GetterXY<IndexerIdx<T>,IndexerIdx<T>>& getter, int first, int count, BatchLineSource<T>* src) {
+    if (!IsContiguous(getter.IndxerX) || !IsContiguous(getter.IndxerY))
+        return false;
+    src->Xs = getter.IndxerX.Data + first;
+    src->XM = src->XB = 0;
+    src->Ys = getter.IndxerY.Data + first;
+    src->First = first;
+    src->Count = count;
+    return true;
+}
+
+template <typename T>
+bool GetBatchLineSource(const GetterXY<IndexerLin,IndexerIdx<T>>& getter, int first, int count, BatchLineSource<T>* src) {
+    if (!IsContiguous(getter.IndxerY))
+        return false;
+    src->Xs = NULL;
+    src->XM = getter.IndxerX.M;
+    src->XB = getter.IndxerX.B;
+    src->Ys = getter.IndxerY.Data + first;
+    src->First = first;
+    src->Count = count;
+    return true;
+}
+
+template <typename _IndexerX, typename T>
+bool RenderLineStripBatch(const GetterXY<_IndexerX,IndexerIdx<T>>& getter, int first, int count, ImU32 col, float weight) {
+    BatchLineSource<T> src;
+    if (!GetBatchLineSource(getter, first, count, &src))
+        return false;
+    const ImPlotPlot& plot = *GetCurrentPlot();
+    if (plot.Axes[plot.CurrentX].TransformForward != NULL || plot.Axes[plot.CurrentY].TransformForward != NULL)
+        return false;
+    RenderPrimitivesEx(RendererLineStripBatch<T>(src, col, weight), *GetPlotDrawList(), plot.PlotRect);
+    return true;
+}
+
+/// Renders a line strip, through RendererLineStripBatch when the getter and axes allow it.
+template <class _Getter>
+void RenderLineStrip(const _Getter& getter, ImU32 col, float weight) {
+    RenderPrimitives1<RendererLineStrip>(getter,col,weight);
+}
+
+template <typename _IndexerX, typename T>
+void RenderLineStrip(const GetterXY<_IndexerX,IndexerIdx<T>>& getter, ImU32 col, float weight) {
+    if (!RenderLineStripBatch(getter, 0, getter.Count, col, weight))
+        RenderPrimitives1<RendererLineStrip>(getter,col,weight);
+}
+
+template <typename _IndexerX, typename T>
+void RenderLineStrip(const GetterSlice<GetterXY<_IndexerX,IndexerIdx<T>>>& getter, ImU32 col, float weight) {
+    if (!RenderLineStripBatch(getter.Getter, getter.First, getter.Count, col, weight))
+        RenderPrimitives1<RendererLineStrip>(getter,col,weight);
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] Markers
 //-----------------------------------------------------------------------------
@@ -1566,43 +1860,63 @@ void RenderMarkers(const _Getter& getter, ImPlotMarker marker, float size, bool
 //-----------------------------------------------------------------------------
 
 template <typename _Getter>
-void PlotLineEx(const char* label_id, const _Getter& getter, ImPlotLineFlags flags) {
-    if (BeginItemEx(label_id, Fitter1<_Getter>(getter), flags, ImPlotCol_Line)) {
-        const ImPlotNextItemData& s = GetItemData();
-        if (getter.Count > 1) {
-            if (ImHasFlag(flags, ImPlotLineFlags_Shaded) && s.RenderFill) {
-                const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]);
-                GetterOverrideY<_Getter> getter2(getter, 0);
-                RenderPrimitives2<RendererShaded>(getter,getter2,col_fill);
+void RenderLineEx(const _Getter& getter, ImPlotLineFlags flags) {
+    const ImPlotNextItemData& s = GetItemData();
+    if (getter.Count > 1) {
+        if (ImHasFlag(flags, ImPlotLineFlags_Shaded) && s.RenderFill) {
+            const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]);
+            GetterOverrideY<_Getter> getter2(getter, 0);
+            RenderPrimitives2<RendererShaded>(getter,getter2,col_fill);
+        }
+        if (s.RenderLine) {
+            const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
+            if (ImHasFlag(flags,ImPlotLineFlags_Segments)) {
+                RenderPrimitives1<RendererLineSegments1>(getter,col_line,s.LineWeight);
             }
-            if (s.RenderLine) {
-                const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
-                if (ImHasFlag(flags,ImPlotLineFlags_Segments)) {
-                    RenderPrimitives1<RendererLineSegments1>(getter,col_line,s.LineWeight);
-                }
-                else if (ImHasFlag(flags, ImPlotLineFlags_Loop)) {
-                    if (ImHasFlag(flags, ImPlotLineFlags_SkipNaN))
-                        RenderPrimitives1<RendererLineStripSkip>(GetterLoop<_Getter>(getter),col_line,s.LineWeight);
-                    else
-                        RenderPrimitives1<RendererLineStrip>(GetterLoop<_Getter>(getter),col_line,s.LineWeight);
-                }
-                else {
-                    if (ImHasFlag(flags, ImPlotLineFlags_SkipNaN))
-                        RenderPrimitives1<RendererLineStripSkip>(getter,col_line,s.LineWeight);
-                    else
-                        RenderPrimitives1<RendererLineStrip>(getter,col_line,s.LineWeight);
-                }
+            else if (ImHasFlag(flags, ImPlotLineFlags_Loop)) {
+                if (ImHasFlag(flags, ImPlotLineFlags_SkipNaN))
+                    RenderPrimitives1<RendererLineStripSkip>(GetterLoop<_Getter>(getter),col_line,s.LineWeight);
+                else
+                    RenderPrimitives1<RendererLineStrip>(GetterLoop<_Getter>(getter),col_line,s.LineWeight);
+            }
+            else {
+                if (ImHasFlag(flags, ImPlotLineFlags_SkipNaN))
+                    RenderPrimitives1<RendererLineStripSkip>(getter,col_line,s.LineWeight);
+                else
+                    RenderLineStrip(getter,col_line,s.LineWeight);
             }
         }
-        // render markers
-        if (s.Marker != ImPlotMarker_None) {
-            if (ImHasFlag(flags, ImPlotLineFlags_NoClip)) {
-                PopPlotClipRect();
-                PushPlotClipRect(s.MarkerSize);
+    }
+    // render markers
+    if (s.Marker != ImPlotMarker_None) {
+        if (ImHasFlag(flags, ImPlotLineFlags_NoClip)) {
+            PopPlotClipRect();
+            PushPlotClipRect(s.MarkerSize);
+        }
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerOutline]);
+        const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerFill]);
+        RenderMarkers<_Getter>(getter, s.Marker, s.MarkerSize, s.RenderMarkerFill, col_fill, s.RenderMarkerLine, col_line, s.MarkerWeight);
+    }
+}
+
+template <typename _Getter>
+void PlotLineEx(const char* label_id, const _Getter& getter, ImPlotLineFlags flags) {
+    if (BeginItemEx(label_id, Fitter1<_Getter>(getter), flags, ImPlotCol_Line)) {
+        // fitting above still sees every point; rendering only needs the visible slice
+        if (ImHasFlag(flags, ImPlotLineFlags_SortedX) && !ImHasFlag(flags, ImPlotLineFlags_Loop)) {
+            ImPlotPlot& plot = *GetCurrentPlot();
+            int first, count;
+            GetVisibleSliceX(getter, plot.Axes[plot.CurrentX].Range, &first, &count);
+            if (ImHasFlag(flags, ImPlotLineFlags_Segments)) {
+                // keep segments paired: start on an even index and end on a complete pair
+                count += first & 1;
+                first &= ~1;
+                count = ImMin(count + (count & 1), getter.Count - first);
             }
-            const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerOutline]);
-            const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerFill]);
-            RenderMarkers<_Getter>(getter, s.Marker, s.MarkerSize, s.RenderMarkerFill, col_fill, s.RenderMarkerLine, col_line, s.MarkerWeight);
+            RenderLineEx(GetterSlice<_Getter>(getter, first, count), flags);
+        }
+        else {
+            RenderLineEx(getter, flags);
         }
         EndItem();
     }
@@ -2280,8 +2594,8 @@ struct GetterHeatmapColMaj {
     { }
     template <typename I> IMPLOT_INLINE RectC operator()(I idx) const {
         double val = (double)Values[idx];
-        const int r = idx % Cols;
-        const int c = idx / Cols;
+        const int r = idx % Rows;
+        const int c = idx / Rows;
         const ImPlotPoint p(XRef + HalfSize.x + c*Width, YRef + YDir * (HalfSize.y + r*Height));
         RectC rect;
         rect.Pos = p;
@@ -2381,6 +2695,272 @@ void PlotHeatmap(const char* label_id, const T* values, int rows, int cols, doub
 CALL_INSTANTIATE_FOR_NUMERIC_TYPES()
 #undef INSTANTIATE_MACRO
 
+//-----------------------------------------------------------------------------
+// [SECTION] Histogram Binning
+//-----------------------------------------------------------------------------
+
+// Maximum number of threads, including the calling thread, used to bin large histograms. Define as 1 to bin on the calling thread only.
+#ifndef IMPLOT_HISTOGRAM_THREADS
+#define IMPLOT_HISTOGRAM_THREADS 8
+#endif
+// Minimum number of values given to each thread; below that waking a worker costs more than it saves.
+#ifndef IMPLOT_HISTOGRAM_MIN_PER_THREAD
+#define IMPLOT_HISTOGRAM_MIN_PER_THREAD 32768
+#endif
+// Cached bin counts of items that were not plotted for this many frames are released.
+#define IMPLOT_HISTOGRAM_CACHE_FRAMES 120
+
+/// Worker threads for ParallelFor(). Started on first use and joined at exit. Jobs are serialized, so ImPlot contexts
+/// on different threads can share the pool.
+struct ImPlotWorkerPool {
+    typedef void (*JobFunc)(void* data, int participant, int begin, int end);
+
+    ImPlotWorkerPool() : Func(NULL), Data(NULL), Count(0), Chunk(0), Participants(0), Pending(0), Generation(0), Stop(false) {
+        WorkerCount = ImClamp((int)std::thread::hardware_concurrency(), 1, IMPLOT_HISTOGRAM_THREADS) - 1;
+        for (int i = 0; i < WorkerCount; ++i)
+            Workers[i] = std::thread(&ImPlotWorkerPool::WorkerMain, this, i + 1);
+    }
+    ~ImPlotWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Stop = true;
+        }
+        WakeCv.notify_all();
+        for (int i = 0; i < WorkerCount; ++i)
+            Workers[i].join();
+    }
+    int Size() const { return WorkerCount + 1; }
+
+    // Splits [0,count) into #participants contiguous pieces and calls func(data, p, begin, end) for piece p on its own
+    // thread. The calling thread takes piece 0. Returns when all pieces are done.
+    void Run(JobFunc func, void* data, int count, int participants) {
+        std::lock_guard<std::mutex> job(JobMutex);
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Func         = func;
+            Data         = data;
+            Count        = count;
+            Chunk        = (count + participants - 1) / participants;
+            Participants = participants;
+            Pending      = participants - 1;
+            ++Generation;
+        }
+        WakeCv.notify_all();
+        Work(0);
+        std::unique_lock<std::mutex> lock(Mutex);
+        DoneCv.wait(lock, [this] { return Pending == 0; });
+    }
+
+    void Work(int participant) {
+        const int begin = ImMin(participant * Chunk, Count);
+        Func(Data, participant, begin, ImMin(begin + Chunk, Count));
+    }
+
+    void WorkerMain(int participant) {
+        unsigned int seen = 0;
+        std::unique_lock<std::mutex> lock(Mutex);
+        for (;;) {
+            WakeCv.wait(lock, [&] { return Stop || Generation != seen; });
+            if (Stop)
+                return;
+            seen = Generation;
+            if (participant >= Participants)
+                continue;
+            lock.unlock();
+            Work(participant);
+            lock.lock();
+            if (--Pending == 0)
+                DoneCv.notify_one();
+        }
+    }
+
+    std::thread             Workers[IMPLOT_HISTOGRAM_THREADS];
+    int                     WorkerCount;
+    std::mutex              JobMutex;
+    std::mutex              Mutex;
+    std::condition_variable WakeCv;
+    std::condition_variable DoneCv;
+    // Current job, guarded by Mutex
+    JobFunc                 Func;
+    void*                   Data;
+    int                     Count;
+    int                     Chunk;
+    int                     Participants;
+    int                     Pending;
+    unsigned int            Generation;
+    bool                    Stop;
+};
+
+static ImPlotWorkerPool& GetWorkerPool() {
+    static ImPlotWorkerPool pool;
+    return pool;
+}
+
+// Number of threads to split #count values over, when each thread accumulates #bins partial counts.
+static int HistogramParticipants(int count, int bins) {
+    if (IMPLOT_HISTOGRAM_THREADS <= 1 || count < 2 * IMPLOT_HISTOGRAM_MIN_PER_THREAD)
+        return 1;
+    // each thread should see at least a few values per bin, otherwise zeroing and reducing the partials dominates
+    const double per_thread = ImMax((double)IMPLOT_HISTOGRAM_MIN_PER_THREAD, 4.0 * bins);
+    return ImClamp((int)(count / per_thread), 1, GetWorkerPool().Size());
+}
+
+template <typename F>
+static void ParallelForThunk(void* data, int participant, int begin, int end) {
+    (*(F*)data)(participant, begin, end);
+}
+
+// Calls job(participant, begin, end) for #participants contiguous pieces of [0,count), in parallel.
+template <typename F>
+static void ParallelFor(int count, int participants, F& job) {
+    if (participants <= 1)
+        job(0, 0, count);
+    else
+        GetWorkerPool().Run(&ParallelForThunk<F>, &job, count, participants);
+}
+
+// Same result as ImMinMaxArray (including when the array contains NaNs), computed in parallel for large arrays.
+template <typename T>
+static void MinMaxArray(const T* values, int count, T* min_out, T* max_out) {
+    const int participants = HistogramParticipants(count, 1);
+    if (participants <= 1) {
+        ImMinMaxArray(values, count, min_out, max_out);
+        return;
+    }
+    T mins[IMPLOT_HISTOGRAM_THREADS], maxs[IMPLOT_HISTOGRAM_THREADS];
+    bool found[IMPLOT_HISTOGRAM_THREADS];
+    auto job = [&](int p, int begin, int end) {
+        // ImMinMaxArray seeds with values[0] and never replaces a NaN seed; other pieces skip their leading NaNs
+        if (p > 0) {
+            while (begin < end && values[begin] != values[begin])
+                ++begin;
+        }
+        found[p] = begin < end;
+        if (found[p])
+            ImMinMaxArray(values + begin, end - begin, &mins[p], &maxs[p]);
+    };
+    ParallelFor(count, participants, job);
+    T Min = mins[0]; T Max = maxs[0];
+    for (int p = 1; p < participants; ++p) {
+        if (!found[p]) continue;
+        if (mins[p] < Min) { Min = mins[p]; }
+        if (maxs[p] > Max) { Max = maxs[p]; }
+    }
+    *min_out = Min; *max_out = Max;
+}
+
+// Bins #values into bin_counts[bins] (same rule as the serial loop it replaces). Returns the number of values
+// inside #range and the number below it in #below.
+template <typename T>
+static int BinValues(const T* values, int count, const ImPlotRange& range, double width, int bins, double* bin_counts, int* below) {
+    const int participants = HistogramParticipants(count, bins);
+    const int stride = bins + 1; // last slot counts the values below the range
+    ImVector<int>& partial = GImPlot->TempInt1;
+    partial.resize(participants * stride);
+    memset(partial.Data, 0, partial.size_in_bytes());
+    auto job = [&](int p, int begin, int end) {
+        int* counts = &partial[p * stride];
+        for (int i = begin; i < end; ++i) {
+            const double val = (double)values[i];
+            if (range.Contains(val))
+                counts[ImClamp((int)((val - range.Min) / width), 0, bins - 1)]++;
+            else if (val < range.Min)
+                counts[bins]++;
+        }
+    };
+    ParallelFor(count, participants, job);
+    int counted = 0;
+    *below = 0;
+    for (int b = 0; b < stride; ++b) {
+        int sum = 0;
+        for (int p = 0; p < participants; ++p)
+            sum += partial[p * stride + b];
+        if (b < bins) {
+            bin_counts[b] = sum;
+            counted += sum;
+        }
+        else {
+            *below = sum;
+        }
+    }
+    return counted;
+}
+
+// 2D version of BinValues, bins are stored row by row (y major). Returns the number of points inside #range.
+template <typename T>
+static int BinValues2D(const T* xs, const T* ys, int count, const ImPlotRect& range, double width, double height, int x_bins, int y_bins, double* bin_counts) {
+    const int bins = x_bins * y_bins;
+    const int participants = HistogramParticipants(count, bins);
+    ImVector<int>& partial = GImPlot->TempInt1;
+    partial.resize(participants * bins);
+    memset(partial.Data, 0, partial.size_in_bytes());
+    auto job = [&](int p, int begin, int end) {
+        int* counts = &partial[p * bins];
+        for (int i = begin; i < end; ++i) {
+            if (range.Contains((double)xs[i], (double)ys[i])) {
+                const int xb = ImClamp( (int)((double)(xs[i] - range.X.Min) / width)  , 0, x_bins - 1);
+                const int yb = ImClamp( (int)((double)(ys[i] - range.Y.Min) / height) , 0, y_bins - 1);
+                counts[yb * x_bins + xb]++;
+            }
+        }
+    };
+    ParallelFor(count, participants, job);
+    int counted = 0;
+    for (int b = 0; b < bins; ++b) {
+        int sum = partial[b];
+        for (int p = 1; p < participants; ++p)
+            sum += partial[p * bins + b];
+        bin_counts[b] = sum;
+        counted += sum;
+    }
+    return counted;
+}
+
+static bool SameRect(const ImPlotRect& a, const ImPlotRect& b) {
+    return a.X.Min == b.X.Min && a.X.Max == b.X.Max && a.Y.Min == b.Y.Min && a.Y.Max == b.Y.Max;
+}
+
+// Returns the cache entry of the current item. Valid is false when it was created or any input differs from last time.
+static ImPlotHistogramCache* GetHistogramCache(const char* label_id, const void* xs, const void* ys, int count, int type_size, int x_bins, int y_bins, const ImPlotRect& range, ImPlotHistogramFlags flags) {
+    ImPlotContext& gp = *GImPlot;
+    const int frame = ImGui::GetFrameCount();
+    for (int i = 0; i < gp.HistogramCaches.GetMapSize(); ++i) {
+        ImPlotHistogramCache* old = gp.HistogramCaches.TryGetMapData(i);
+        if (old != NULL && frame - old->LastFrame > IMPLOT_HISTOGRAM_CACHE_FRAMES)
+            gp.HistogramCaches.Remove(old->ID, old);
+    }
+    const ImGuiID id = ImHashStr(label_id, 0, gp.CurrentPlot->ID);
+    ImPlotHistogramCache* cache = gp.HistogramCaches.GetOrAddByKey(id);
+    flags &= ~ImPlotHistogramFlags_Horizontal; // rendering only
+    const bool same = cache->Xs == xs && cache->Ys == ys && cache->Count == count && cache->TypeSize == type_size &&
+                      cache->XBins == x_bins && cache->YBins == y_bins && SameRect(cache->Range, range) && cache->Flags == flags;
+    cache->ID        = id;
+    cache->LastFrame = frame;
+    if (!same) {
+        cache->Valid    = false;
+        cache->Xs       = xs;
+        cache->Ys       = ys;
+        cache->Count    = count;
+        cache->TypeSize = type_size;
+        cache->XBins    = x_bins;
+        cache->YBins    = y_bins;
+        cache->Range    = range;
+        cache->Flags    = flags;
+    }
+    return cache;
+}
+
+void BustHistogramCache() {
+    GImPlot->HistogramCaches.Clear();
+}
+
+static void PlotHistogramBars(const char* label_id, const ImVector<double>& bin_centers, const ImVector<double>& bin_counts, double bar_size, ImPlotHistogramFlags flags) {
+    if (ImHasFlag(flags, ImPlotHistogramFlags_Horizontal))
+        PlotBars(label_id, &bin_counts.Data[0], &bin_centers.Data[0], bin_counts.Size, bar_size, ImPlotBarsFlags_Horizontal);
+    else
+        PlotBars(label_id, &bin_centers.Data[0], &bin_counts.Data[0], bin_counts.Size, bar_size);
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] PlotHistogram
 //-----------------------------------------------------------------------------
@@ -2395,9 +2975,18 @@ double PlotHistogram(const char* label_id, const T* values, int count, int bins,
     if (count <= 0 || bins == 0)
         return 0;
 
+    ImPlotHistogramCache* cache = NULL;
+    if (ImHasFlag(flags, ImPlotHistogramFlags_Cached)) {
+        cache = GetHistogramCache(label_id, values, NULL, count, sizeof(T), bins, 0, ImPlotRect(range.Min, range.Max, 0, 0), flags);
+        if (cache->Valid) {
+            PlotHistogramBars(label_id, cache->Centers, cache->Counts, bar_scale*cache->Width, flags);
+            return cache->MaxCount;
+        }
+    }
+
     if (range.Min == 0 && range.Max == 0) {
         T Min, Max;
-        ImMinMaxArray(values, count, &Min, &Max);
+        MinMaxArray(values, count, &Min, &Max);
         range.Min = (double)Min;
         range.Max = (double)Max;
     }
@@ -2412,27 +3001,14 @@ double PlotHistogram(const char* label_id, const T* values, int count, int bins,
     ImVector<double>& bin_counts  = GImPlot->TempDouble2;
     bin_centers.resize(bins);
     bin_counts.resize(bins);
-    int below = 0;
 
-    for (int b = 0; b < bins; ++b) {
+    for (int b = 0; b < bins; ++b)
         bin_centers[b] = range.Min + b * width + width * 0.5;
-        bin_counts[b] = 0;
-    }
-    int counted = 0;
+    int below = 0;
+    const int counted = BinValues(values, count, range, width, bins, &bin_counts.Data[0], &below);
     double max_count = 0;
-    for (int i = 0; i < count; ++i) {
-        double val = (double)values[i];
-        if (range.Contains(val)) {
-            const int b = ImClamp((int)((val - range.Min) / width), 0, bins - 1);
-            bin_counts[b] += 1.0;
-            if (bin_counts[b] > max_count)
-                max_count = bin_counts[b];
-            counted++;
-        }
-        else if (val < range.Min) {
-            below++;
-        }
-    }
+    for (int b = 0; b < bins; ++b)
+        max_count = ImMax(max_count, bin_counts[b]);
     if (cumulative && density) {
         if (outliers)
             bin_counts[0] += below;
@@ -2456,10 +3032,14 @@ double PlotHistogram(const char* label_id, const T* values, int count, int bins,
             bin_counts[b] *= scale;
         max_count *= scale;
     }
-    if (ImHasFlag(flags, ImPlotHistogramFlags_Horizontal))
-        PlotBars(label_id, &bin_counts.Data[0], &bin_centers.Data[0], bins, bar_scale*width, ImPlotBarsFlags_Horizontal);
-    else
-        PlotBars(label_id, &bin_centers.Data[0], &bin_counts.Data[0], bins, bar_scale*width);
+    if (cache != NULL) {
+        cache->Centers  = bin_centers;
+        cache->Counts   = bin_counts;
+        cache->Width    = width;
+        cache->MaxCount = max_count;
+        cache->Valid    = true;
+    }
+    PlotHistogramBars(label_id, bin_centers, bin_counts, bar_scale*width, flags);
     return max_count;
 }
 #define INSTANTIATE_MACRO(T) template IMPLOT_API double PlotHistogram<T>(const char* label_id, const T* values, int count, int bins, double bar_scale, ImPlotRange range, ImPlotHistogramFlags flags);
@@ -2481,15 +3061,28 @@ double PlotHistogram2D(const char* label_id, const T* xs, const T* ys, int count
     if (count <= 0 || x_bins == 0 || y_bins == 0)
         return 0;
 
+    ImPlotHistogramCache* cache = NULL;
+    if (ImHasFlag(flags, ImPlotHistogramFlags_Cached)) {
+        cache = GetHistogramCache(label_id, xs, ys, count, sizeof(T), x_bins, y_bins, range, flags);
+        if (cache->Valid) {
+            if (BeginItemEx(label_id, FitterRect(cache->RangeOut))) {
+                ImDrawList& draw_list = *GetPlotDrawList();
+                RenderHeatmap(draw_list, &cache->Counts.Data[0], cache->YBinsOut, cache->XBinsOut, 0, cache->MaxCount, NULL, cache->RangeOut.Min(), cache->RangeOut.Max(), false, col_maj);
+                EndItem();
+            }
+            return cache->MaxCount;
+        }
+    }
+
     if (range.X.Min == 0 && range.X.Max == 0) {
         T Min, Max;
-        ImMinMaxArray(xs, count, &Min, &Max);
+        MinMaxArray(xs, count, &Min, &Max);
         range.X.Min = (double)Min;
         range.X.Max = (double)Max;
     }
     if (range.Y.Min == 0 && range.Y.Max == 0) {
         T Min, Max;
-        ImMinMaxArray(ys, count, &Min, &Max);
+        MinMaxArray(ys, count, &Min, &Max);
         range.Y.Min = (double)Min;
         range.Y.Max = (double)Max;
     }
@@ -2509,28 +3102,24 @@ double PlotHistogram2D(const char* label_id, const T* xs, const T* ys, int count
     ImVector<double>& bin_counts = GImPlot->TempDouble1;
     bin_counts.resize(bins);
 
-    for (int b = 0; b < bins; ++b)
-        bin_counts[b] = 0;
-
-    int counted = 0;
+    const int counted = BinValues2D(xs, ys, count, range, width, height, x_bins, y_bins, &bin_counts.Data[0]);
     double max_count = 0;
-    for (int i = 0; i < count; ++i) {
-        if (range.Contains((double)xs[i], (double)ys[i])) {
-            const int xb = ImClamp( (int)((double)(xs[i] - range.X.Min) / width)  , 0, x_bins - 1);
-            const int yb = ImClamp( (int)((double)(ys[i] - range.Y.Min) / height) , 0, y_bins - 1);
-            const int b  = yb * x_bins + xb;
-            bin_counts[b] += 1.0;
-            if (bin_counts[b] > max_count)
-                max_count = bin_counts[b];
-            counted++;
-        }
-    }
+    for (int b = 0; b < bins; ++b)
+        max_count = ImMax(max_count, bin_counts[b]);
     if (density) {
         double scale = 1.0 / ((outliers ? count : counted) * width * height);
         for (int b = 0; b < bins; ++b)
             bin_counts[b] *= scale;
         max_count *= scale;
     }
+    if (cache != NULL) {
+        cache->Counts   = bin_counts;
+        cache->XBinsOut = x_bins;
+        cache->YBinsOut = y_bins;
+        cache->RangeOut = range;
+        cache->MaxCount = max_count;
+        cache->Valid    = true;
+    }
 
     if (BeginItemEx(label_id, FitterRect(range))) {
         ImDrawList& draw_list = *GetPlotDrawList();
@@ -1,11 +1,145 @@
+/**
+ * @file imgui_histogram.h
+ * @brief
+ * 直方图窗口。实时数据通过createHistogram()创建的通道写入：
+ *
+ *  StreamHistogramConfig config;
+ *  config.min = 0;
+ *  config.max = 0.002;
+ *  config.window = 10000;  // 另外统计最近10000个点
+ *  auto loop = MoproboGui::HistogramFactory::getInstance().createHistogram(
+ *      "控制周期(s)", config);
+ *  loop->addValue(dt);  // 采样线程
+ *
+ * 每个点到达时只更新一次桶计数，绘制时把桶合并成柱，
+ * 每帧的代价与累计的点数无关。
+ *
+ * 周期抖动、延迟等需要分位数的数据用createDistribution()创建的通道，
+ * 以QuantileSketch统计，显示分位数表、对数分桶的直方图和累积分布。
+ * 多个线程各自记录时，每个线程用自己的QuantileSketch，定期merge()进通道：
+ *
+ *  thread_local QuantileSketch local;
+ *  local.add(latency);
+ *  if (local.count() >= 1000) {
+ *      distribution->merge(local);
+ *      local.clear();
+ *  }
+ */
+
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "data_comm.h"
+#include "quantile_sketch.h"
+#include "spsc_ring.h"
+#include "stream_histogram.h"
 
 namespace MoproboGui {
 
+/**
+ * @brief 单个实时直方图通道。
+ *
+ * 线程模型与OscilloscopeBuffer相同：addValue()/addValues()只允许一个
+ * 采样线程调用，数据先写入无锁队列；GUI线程每帧调用drain()
+ * 把队列中的数据计入StreamHistogram。clear()可在任意线程调用，
+ * 实际清空动作延迟到下一次drain()执行。
+ */
+class HistogramChannel {
+public:
+    explicit HistogramChannel(
+        const std::string& name,
+        const StreamHistogramConfig& config = StreamHistogramConfig(),
+        size_t queueSize = 1 << 16)
+        : m_name(name), m_queue(queueSize), m_histogram(config) {}
+    ~HistogramChannel() = default;
+
+    const std::string& name() const { return m_name; }
+
+    // 采样线程调用，队列满时丢弃并返回false
+    bool addValue(float value);
+    // 采样线程调用，返回实际写入的个数
+    size_t addValues(const float* values, size_t n);
+
+    // GUI线程调用，返回本次取出的个数
+    size_t drain();
+
+    // 因队列满而丢弃的个数
+    size_t dropped() const;
+
+    bool clear();
+
+    // 仅在GUI线程使用
+    const StreamHistogram& histogram() const { return m_histogram; }
+
+private:
+    std::string m_name;
+
+    SpscRing<float> m_queue;
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<bool> m_clearPending{false};
+
+    StreamHistogram m_histogram;
+};
+
+/**
+ * @brief 用分位数草图统计的分布通道。
+ *
+ * addValue()/addValues()与HistogramChannel相同，只允许一个采样线程调用；
+ * merge()可在任意线程调用，草图先合并到待处理的草图中(持锁时间与桶数有关)，
+ * GUI线程在drain()中再合并进来。
+ */
+class DistributionChannel {
+public:
+    explicit DistributionChannel(
+        const std::string& name,
+        const QuantileSketchConfig& config = QuantileSketchConfig(),
+        size_t queueSize = 1 << 16)
+        : m_name(name),
+          m_queue(queueSize),
+          m_pending(config),
+          m_sketch(config) {}
+    ~DistributionChannel() = default;
+
+    const std::string& name() const { return m_name; }
+
+    // 采样线程调用，队列满时丢弃并返回false
+    bool addValue(float value);
+    size_t addValues(const float* values, size_t n);
+
+    // 任意线程调用，sketch的配置须与通道相同，否则返回false
+    bool merge(const QuantileSketch& sketch);
+
+    // GUI线程调用，返回本次取出的个数(不含merge()合并的点)
+    size_t drain();
+
+    size_t dropped() const;
+
+    bool clear();
+
+    // 仅在GUI线程使用
+    const QuantileSketch& sketch() const { return m_sketch; }
+
+private:
+    std::string m_name;
+
+    SpscRing<float> m_queue;
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<bool> m_clearPending{false};
+
+    std::mutex m_mutex;
+    QuantileSketch m_pending;  // 由m_mutex保护
+    std::atomic<bool> m_hasPending{false};
+
+    QuantileSketch m_sketch;
+};
+
 class HistogramFactory {
-    HistogramFactory() = default;
+    HistogramFactory();
 
 public:
     static HistogramFactory& getInstance() {
@@ -14,91 +148,57 @@ public:
     }
 
     ~HistogramFactory() = default;
-    void showHistogram() {
-        static ImPlotHistogramFlags hist_flags = ImPlotHistogramFlags_Density;
-        static int bins = 50;
-        static double mu = 5;
-        static double sigma = 2;
-        ImGui::SetNextItemWidth(200);
-        if (ImGui::RadioButton("Sqrt", bins == ImPlotBin_Sqrt)) {
-            bins = ImPlotBin_Sqrt;
-        }
-        ImGui::SameLine();
-        if (ImGui::RadioButton("Sturges", bins == ImPlotBin_Sturges)) {
-            bins = ImPlotBin_Sturges;
-        }
-        ImGui::SameLine();
-        if (ImGui::RadioButton("Rice", bins == ImPlotBin_Rice)) {
-            bins = ImPlotBin_Rice;
-        }
-        ImGui::SameLine();
-        if (ImGui::RadioButton("Scott", bins == ImPlotBin_Scott)) {
-            bins = ImPlotBin_Scott;
-        }
-        ImGui::SameLine();
-        if (ImGui::RadioButton("N Bins", bins >= 0)) {
-            bins = 50;
-        }
-        if (bins >= 0) {
-            ImGui::SameLine();
-            ImGui::SetNextItemWidth(200);
-            ImGui::SliderInt("##Bins", &bins, 1, 100);
-        }
-        ImGui::CheckboxFlags("Horizontal", (unsigned int*)&hist_flags,
-                             ImPlotHistogramFlags_Horizontal);
-        ImGui::SameLine();
-        ImGui::CheckboxFlags("Density", (unsigned int*)&hist_flags,
-                             ImPlotHistogramFlags_Density);
-        ImGui::SameLine();
-        ImGui::CheckboxFlags("Cumulative", (unsigned int*)&hist_flags,
-                             ImPlotHistogramFlags_Cumulative);
-
-        static bool range = false;
-        ImGui::Checkbox("Range", &range);
-        static float rmin = -3;
-        static float rmax = 13;
-        if (range) {
-            ImGui::SameLine();
-            ImGui::SetNextItemWidth(200);
-            ImGui::DragFloat2("##Range", &rmin, 0.1f, -3, 13);
-            ImGui::SameLine();
-            ImGui::CheckboxFlags("Exclude Outliers", (unsigned int*)&hist_flags,
-                                 ImPlotHistogramFlags_NoOutliers);
-        }
-        static NormalDistribution<10000> dist(mu, sigma);
-        static double x[100];
-        static double y[100];
-        if (hist_flags & ImPlotHistogramFlags_Density) {
-            for (int i = 0; i < 100; ++i) {
-                x[i] = -3 + 16 * (double)i / 99.0;
-                y[i] = exp(-(x[i] - mu) * (x[i] - mu) / (2 * sigma * sigma)) /
-                       (sigma * sqrt(2 * 3.141592653589793238));
-            }
-            if (hist_flags & ImPlotHistogramFlags_Cumulative) {
-                for (int i = 1; i < 100; ++i) y[i] += y[i - 1];
-                for (int i = 0; i < 100; ++i) y[i] /= y[99];
-            }
-        }
-
-        if (ImPlot::BeginPlot("##Histograms")) {
-            ImPlot::SetupAxes(NULL, NULL, ImPlotAxisFlags_AutoFit,
-                              ImPlotAxisFlags_AutoFit);
-            ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
-            ImPlot::PlotHistogram(
-                "Empirical", dist.Data, 10000, bins, 1.0,
-                range ? ImPlotRange(rmin, rmax) : ImPlotRange(), hist_flags);
-            if ((hist_flags & ImPlotHistogramFlags_Density) &&
-                !(hist_flags & ImPlotHistogramFlags_NoOutliers)) {
-                if (hist_flags & ImPlotHistogramFlags_Horizontal)
-                    ImPlot::PlotLine("Theoretical", y, x, 100);
-                else
-                    ImPlot::PlotLine("Theoretical", x, y, 100);
-            }
-            ImPlot::EndPlot();
-        }
-    }
+
+    /**
+     * @brief 创建实时直方图通道，同名时返回已有的通道
+     * @note 仅在GUI线程或开始绘制之前调用
+     */
+    std::shared_ptr<HistogramChannel> createHistogram(
+        const std::string& name,
+        const StreamHistogramConfig& config = StreamHistogramConfig());
+
+    /**
+     * @brief 创建分布通道，同名时返回已有的通道
+     * @note 仅在GUI线程或开始绘制之前调用
+     */
+    std::shared_ptr<DistributionChannel> createDistribution(
+        const std::string& name,
+        const QuantileSketchConfig& config = QuantileSketchConfig());
+
+    void showHistogram();
 
 private:
+    // 绘制显示设置，结果存入成员
+    void showOptions();
+    /**
+     * @brief 按当前设置把hist合并成柱并绘制，与ImPlot::PlotHistogram的
+     * 分箱规则和各标志的含义相同
+     */
+    void plotHistogram(const char* label, const StreamHistogram& hist,
+                       bool windowed);
+    // 分位数表，以及每个分布通道的直方图和累积分布
+    void showDistributions();
+
+    ImPlotHistogramFlags m_flags{ImPlotHistogramFlags_Density};
+    int m_bins{50};
+    bool m_range{false};
+    float m_rangeLimits[2]{-3, 13};
+    // 通道配置了滑动窗口时只显示窗口内的点
+    bool m_windowed{false};
+
+    // 正态分布示例，数据只在构造时计入一次
+    StreamHistogram m_demo;
+    double m_demoMu{5};
+    double m_demoSigma{2};
+
+    HistogramBars m_bars;
+    std::vector<std::shared_ptr<HistogramChannel>> m_channels;
+
+    std::vector<std::shared_ptr<DistributionChannel>> m_distributions;
+    // 分布通道绘图用的临时数据
+    std::vector<double> m_binEdges;
+    std::vector<double> m_binHeights;
+    std::vector<double> m_cdf;
 };
 
-};  // namespace MoproboGui
\ No newline at end of file
+};  // namespace MoproboGui
@@ -19,11 +19,15 @@
  *              num -= 100;
  *          }
  *          plot1->addPoint(num, 0.02);
- *          plot2->addPoint(100 - num, 0.02);
+ *          plot2->addPointAt(100 - num, zemb::Time::fromMono());
  *          std::this_thread::sleep_for(std::chrono::milliseconds(20));
  *      }
  *  });
  *
+ * addPoint()按给定的时间间隔累加生成时间戳，长时间运行会有累计误差；
+ * 有真实采样时刻时应使用addPointAt()传入CLOCK_MONOTONIC绝对时间。
+ * 写入数据会通过FrameScheduler唤醒按需刷新的主循环。
+ *
  * @version 1.0
  * @date 2023-03-10
  *
@@ -39,6 +43,19 @@
 #include <vector>
 
 #include "data_comm.h"
+#include "frame_scheduler.h"
+#include "scope_expr.h"
+#include "scope_lod.h"
+#include "scope_persistence.h"
+#include "scope_playback.h"
+#include "scope_record.h"
+#include "scope_spectrum.h"
+#include "scope_stats.h"
+#include "scope_store.h"
+#include "scope_trigger.h"
+#include "scope_xy.h"
+#include "spsc_ring.h"
+#include "zemb/inc/DateTime.h"
 
 #ifndef MOPROBO_API
 #define MOPROBO_API extern
@@ -48,6 +65,8 @@ namespace MoproboGui {
 
 class OscilloscopeWindow;
 class OscilloscopeBuffer;
+class OscilloscopeGroup;
+class OscilloscopeDerived;
 
 class OscilloscopeFactory {
     OscilloscopeFactory() {}
@@ -65,10 +84,25 @@ public:
         const std::string& fold, const std::string& plot,
         ImPlotAxisFlags flag = ImPlotAxisFlags_None, float history = 10.f,
         float max = 60.f);
+    // 删除窗口，正在录制时先停止录制它的曲线
+    void removeScopes(const std::string& fold);
+
+    /**
+     * @brief 把所有窗口的曲线录制到文件，之后新建的曲线也会加入录制
+     * @note 仅在GUI线程调用
+     */
+    bool startRecording(const std::string& path,
+                        const RecordConfig& config = RecordConfig());
+    void stopRecording();
+    bool recording() const;
 
 private:
+    void showRecorder();
+
     std::unordered_map<std::string, std::shared_ptr<OscilloscopeWindow>>
         m_scopes;
+    std::unique_ptr<ScopeRecorder> m_recorder;
+    std::string m_recordPath{"scope.mprec"};
 };
 
 class OscilloscopeWindow {
@@ -87,43 +121,309 @@ public:
     void setScopeConfig(const std::string& fold, const std::string& plot,
                         ImPlotAxisFlags flag, float history, float max);
 
-    std::shared_ptr<OscilloscopeBuffer> createPlot(const std::string& plot);
+    std::shared_ptr<OscilloscopeBuffer> createPlot(
+        const std::string& plot,
+        const ScopeCapacity& capacity = ScopeCapacity());
+
+    // 创建共用时间轴的一组曲线，channels为各曲线名
+    std::shared_ptr<OscilloscopeGroup> createGroup(
+        const std::string& group, const std::vector<std::string>& channels,
+        const ScopeCapacity& capacity = ScopeCapacity());
+
+    /**
+     * @brief 创建运算通道，expression中的通道名为本窗口已有的曲线，
+     * 所有输入必须共用一个时间轴(同一条曲线，或同一组内的通道)
+     * @param error 失败时返回空，并在error中给出原因
+     */
+    std::shared_ptr<OscilloscopeDerived> createDerived(
+        const std::string& name, const std::string& expression,
+        std::string* error = nullptr,
+        const ScopeCapacity& capacity = ScopeCapacity());
+    // 删除运算通道，以它为输入的运算通道一并删除
+    void removeDerived(const std::string& name);
+
+    /**
+     * @brief 打开XY显示，以曲线x为横轴、曲线y为纵轴，两者可以不同采样率
+     * @return 找不到曲线时返回false
+     */
+    bool setXY(const std::string& x, const std::string& y);
+    void closeXY();
 
     void showOscilloscopeWindow();
 
+    // 开始或停止录制本窗口的所有曲线，recorder为空时停止，
+    // 切换时先在原来的recorder中注销各曲线
+    void setRecorder(ScopeRecorder* recorder);
+    // 窗口移出工厂时调用，停止录制并在帧耗时分析中注销各曲线
+    void detach();
+
+    /**
+     * @brief 回放录制文件，回放期间窗口显示文件中的数据而不是实时曲线；
+     * 文件中有本窗口录制的曲线时只显示这些曲线，否则显示全部
+     */
+    bool openPlayback(const std::string& path);
+    void closePlayback();
+
+    // 触发设置，仅在GUI线程使用
+    ScopeTrigger& trigger() { return m_trigger; }
+    void setTriggerSource(const std::string& plot);
+
 private:
+    // 所有曲线中最新数据的时间，没有数据时返回false
+    bool latestTime(int64_t* latest) const;
+    // 按曲线名查找信号源所在的存储和通道
+    const ScopeStore* findSource(const std::string& plot,
+                                 size_t* channel) const;
+    // 列出所有曲线供选择信号源，选择改变时返回true
+    bool sourceCombo(const char* label, std::string* plot);
+    void updateTrigger();
+    // 触发画面采满时把各曲线的数据拷贝给触发引擎
+    void captureTraces();
+    void showTriggerConfig();
+    void showSpectrumConfig();
+    void showDerivedConfig();
+    void showXYConfig();
+    void updateStats();
+    void showStats();
+    void showXY();
+    // frozen为true时显示触发画面
+    void showPlot(bool frozen);
+    void showPlaybackConfig();
+    void showPlayback();
+
     std::string m_foldName{""};
     std::string m_plotName{""};
     ImPlotAxisFlags m_flag;
     float m_history{0};
     float m_maxTime{0};
+    // 跟随最新数据滚动，关闭后可拖动X轴回看历史
+    bool m_follow{true};
+    // X轴零点对应的时间戳(ns)，跟随时为最新数据的时间，回看时保持不变，
+    // 绘图坐标始终是相对零点的秒数，长时间运行也不会损失精度
+    int64_t m_origin{0};
+
+    bool m_triggerEnabled{false};
+    std::string m_triggerSource;
+    // 触发引擎已检查到的序号，UINT64_MAX表示从信号源的最新数据开始
+    uint64_t m_triggerEnd{UINT64_MAX};
+    ScopeTrigger m_trigger;
+    // 余辉显示，未启用时为空；每个触发画面作为一次扫描叠加
+    std::unique_ptr<ScopePersistence> m_persistence;
+    float m_persistenceTime{1};  // 衰减到1/e的秒数，0为无限余辉
+    std::vector<int64_t> m_captures;
+    // 上一帧时域图的X轴范围(相对m_origin的秒数)，XY图显示同一时间段
+    double m_viewMin{0};
+    double m_viewMax{0};
+    // 上一帧触发画面的Y轴范围，余辉网格按此范围栅格化
+    double m_frozenYMin{0};
+    double m_frozenYMax{1};
+
+    // 未启用频谱分析时为空，不占用工作线程
+    std::unique_ptr<ScopeSpectrum> m_spectrum;
+    std::string m_spectrumSource;
+
+    ScopeRecorder* m_recorder{nullptr};
+
+    std::unique_ptr<ScopePlayback> m_playback;
+    std::string m_playbackPath{"scope.mprec"};
+    std::string m_playbackError;
+    // 回放时X轴左端相对录制开始的秒数
+    double m_playbackPos{0};
 
     std::unordered_map<std::string, std::shared_ptr<OscilloscopeBuffer>>
         m_buffers;
+    std::unordered_map<std::string, std::shared_ptr<OscilloscopeGroup>>
+        m_groups;
+    // 按创建顺序计算，后创建的运算通道可以使用先创建的
+    std::vector<std::shared_ptr<OscilloscopeDerived>> m_derived;
+    std::string m_derivedName;
+    std::string m_derivedExpr;
+    std::string m_derivedError;
+
+    // 未启用XY显示时为空
+    std::unique_ptr<ScopeXY> m_xy;
+    std::string m_xyX;
+    std::string m_xyY;
+
+    // 各通道的统计，启用后每帧更新；通道增删时重建
+    bool m_statsEnabled{false};
+    std::vector<std::pair<std::string, std::unique_ptr<ScopeStats>>> m_stats;
 };
 
+/**
+ * @brief 单条波形曲线的数据缓冲。
+ *
+ * 线程模型：addPoint()只允许一个采样线程调用，数据先写入无锁队列；
+ * GUI线程每帧调用drain()把队列中的数据批量搬入ScopeStore，
+ * getBuffer()/plotLine()只在GUI线程使用。clear()可在任意线程调用，
+ * 实际清空动作延迟到下一次drain()执行。
+ */
 class OscilloscopeBuffer {
 public:
-    OscilloscopeBuffer() = default;
-    explicit OscilloscopeBuffer(const std::string& id) : m_plotId(id) {}
+    explicit OscilloscopeBuffer(const std::string& id = "",
+                                const ScopeCapacity& capacity = ScopeCapacity(),
+                                size_t queueSize = 1 << 16)
+        : m_plotId(id),
+          m_queue(queueSize),
+          m_buffer(capacity),
+          m_lod(m_buffer.capacity()) {}
     ~OscilloscopeBuffer() = default;
 
     std::string id() const;
 
-    RollingBuffer getBuffer() const;
+    // 只读视图，不拷贝数据，仅在GUI线程使用
+    const ScopeStore& getBuffer() const;
+    const ScopeLod& getLod() const;
 
+    // 按当前X轴范围和绘图区宽度抽取后绘制，仅在GUI线程使用
+    void plotLine(const char* label, int64_t origin, double xmin, double xmax,
+                  int pixels) const;
+
+    // 采样线程调用，队列满时丢弃该点并返回false
+    // time为距上一个点的时间间隔(s)
     bool addPoint(float number, float time);
+    // monoNs为CLOCK_MONOTONIC时间戳(ns)
+    bool addPointAt(float number, int64_t monoNs);
+    bool addPointAt(float number, const zemb::Time& mono);
+
+    /**
+     * @brief 采样线程批量写入，整块只发布一次
+     * @param values 数据，按stride个float的间隔读取，
+     *               多通道交织的帧数据可直接传入对应通道的首地址和通道数
+     * @param monoNs CLOCK_MONOTONIC时间戳(ns)，连续存放
+     * @return size_t 实际写入的点数，队列空间不足时丢弃剩余的点
+     */
+    size_t addPoints(const float* values, const int64_t* monoNs, size_t n);
+    size_t addPoints(const float* values, size_t stride, const int64_t* monoNs,
+                     size_t n);
+
+    // GUI线程调用，返回本次取出的点数
+    size_t drain();
+
+    // GUI线程调用，此后drain()取出的数据同时交给recorder录制，
+    // 已在录制时先在原来的recorder中注销原来的stream
+    void setRecorder(ScopeRecorder* recorder, uint32_t stream);
 
-    bool reSpan(float span);
+    // 因队列满而丢弃的点数
+    size_t dropped() const;
 
     bool clear();
 
 private:
     std::string m_plotId{""};
 
-    double m_time{0};
+    // 仅由采样线程访问
+    int64_t m_time{0};
+
+    SpscRing<ScopeSample> m_queue;
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<bool> m_clearPending{false};
+
+    // 仅由GUI线程访问
+    ScopeStore m_buffer;
+    ScopeLod m_lod;
+    ScopeRecorder* m_recorder{nullptr};
+    uint32_t m_stream{0};
+};
+
+/**
+ * @brief 共用时间轴的一组波形曲线。
+ *
+ * 同一时钟采样的多个通道只保存一份时间戳，每个通道的数值按列连续存放(SoA)。
+ * 线程模型与OscilloscopeBuffer相同：addFrame()/addFrames()只允许一个
+ * 采样线程调用，GUI线程每帧调用drain()。
+ */
+class OscilloscopeGroup {
+public:
+    explicit OscilloscopeGroup(const std::vector<std::string>& channels,
+                               const ScopeCapacity& capacity = ScopeCapacity(),
+                               size_t queueSize = 1 << 16);
+    ~OscilloscopeGroup() = default;
+
+    size_t channels() const;
+
+    const std::string& channelName(size_t channel) const;
+    const std::vector<std::string>& channelNames() const;
+
+    // 采样线程调用，values包含每个通道各一个值
+    bool addFrame(int64_t monoNs, const float* values);
+
+    // 采样线程调用，frames按[n][channels()]交织存放，返回实际写入的帧数
+    size_t addFrames(const int64_t* monoNs, const float* frames, size_t n);
+
+    // GUI线程调用，返回本次取出的帧数
+    size_t drain();
+
+    void setRecorder(ScopeRecorder* recorder, uint32_t stream);
+
+    size_t dropped() const;
+
+    bool clear();
+
+    const ScopeStore& getBuffer() const;
+    const ScopeLod& getLod(size_t channel) const;
+
+    void plotLines(int64_t origin, double xmin, double xmax, int pixels) const;
+
+private:
+    std::vector<std::string> m_names;
+
+    SpscRing<int64_t> m_times;
+    std::vector<std::unique_ptr<SpscRing<float>>> m_values;
+    std::atomic<size_t> m_dropped{0};
+    std::atomic<bool> m_clearPending{false};
+
+    ScopeStore m_buffer;
+    std::vector<ScopeLod> m_lods;
+    ScopeRecorder* m_recorder{nullptr};
+    uint32_t m_stream{0};
+};
+
+/**
+ * @brief 由表达式计算得到的运算通道。
+ *
+ * GUI线程每帧在各曲线drain()之后调用update()，只对信号源新增的点求值，
+ * 结果与普通曲线一样存入ScopeStore并维护LOD，可作为触发和频谱的信号源。
+ */
+class OscilloscopeDerived {
+public:
+    /**
+     * @param expr 已编译的表达式
+     * @param source 输入所在的存储，channels依次对应expr.variables()
+     */
+    OscilloscopeDerived(const std::string& name, const ScopeExpr& expr,
+                        const ScopeStore* source,
+                        const std::vector<size_t>& channels,
+                        const ScopeCapacity& capacity = ScopeCapacity());
+    ~OscilloscopeDerived() = default;
+
+    const std::string& name() const { return m_name; }
+    const std::string& expression() const { return m_expr.text(); }
+    const ScopeStore* source() const { return m_source; }
+
+    // GUI线程调用，返回本次计算的点数
+    size_t update();
+
+    const ScopeStore& getBuffer() const { return m_buffer; }
+    const ScopeLod& getLod() const { return m_lod; }
+
+    void plotLine(int64_t origin, double xmin, double xmax, int pixels) const;
+
+private:
+    std::string m_name;
+    ScopeExpr m_expr;
+    const ScopeStore* m_source;
+    std::vector<size_t> m_channels;
+    // 已计算到的信号源序号
+    uint64_t m_end{0};
+
+    std::vector<int64_t> m_times;
+    std::vector<float> m_inputs;
+    std::vector<const float*> m_columns;
+    std::vector<float> m_values;
 
-    RollingBuffer m_buffer;
+    ScopeStore m_buffer;
+    ScopeLod m_lod;
 };
 
 // void createPlotLine(const std::string& line_id, float* x, float* y) {}
@@ -0,0 +1,17 @@
+/**
+ * @file cmd_option.h
+ * @brief
+ * 命令行参数解析的公用函数，参数形式为"--name=值"。
+ */
+
+#pragma once
+
+namespace MoproboGui {
+
+// arg为"--name=值"时返回值的位置，否则返回nullptr
+const char* option(const char* arg, const char* name);
+
+// 解析"WxH"形式的尺寸，格式不对或不为正时返回false，不修改输出
+bool parseSize(const char* value, int* width, int* height);
+
+};  // namespace MoproboGui
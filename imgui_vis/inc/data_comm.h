@@ -60,19 +60,4 @@ struct ScrollingBuffer {
     }
 };
 
-// utility structure for realtime plot
-struct RollingBuffer {
-    float Span;
-    ImVector<ImVec2> Data;
-    RollingBuffer() {
-        Span = 10.0f;
-        Data.reserve(20000);
-    }
-    void AddPoint(float x, float y) {
-        float xmod = fmodf(x, Span);
-        if (!Data.empty() && xmod < Data.back().x) Data.shrink(0);
-        Data.push_back(ImVec2(xmod, y));
-    }
-};
-
 };  // namespace MoproboGui
\ No newline at end of file
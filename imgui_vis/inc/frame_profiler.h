@@ -0,0 +1,113 @@
+/**
+ * @file frame_profiler.h
+ * @brief
+ * 帧耗时分析：记录主循环每帧各阶段的耗时、绘制列表的顶点和索引数，
+ * 以及各通道每秒进入的点数，以曲线和p50/p95/p99分位线显示。
+ *
+ * 主循环在每帧开始时调用beginFrame()，每个阶段结束时调用mark()，
+ * 从上一次mark()到本次的时间计入该阶段，帧结束时调用endFrame()。
+ * 每帧的记录写入无锁环形队列，显示时取出到定长的历史中，
+ * 记录端只有几次steady_clock读取，不受显示和分位数计算的影响。
+ * 分位数用nth_element按历史窗口计算，只在展开时计算，每帧每个阶段算一次。
+ * showFrameProfiler()画在当前窗口中，主循环把它和帧调度放在
+ * "性能分析"窗口里，这部分耗时单独计入kStageProfiler。
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "spsc_ring.h"
+
+struct ImDrawData;
+
+namespace MoproboGui {
+
+enum ProfileStage {
+    kStageEvents,     // 等待和处理窗口事件
+    kStageNewFrame,   // 后端NewFrame和ImGui::NewFrame
+    kStageProfiler,   // 性能分析窗口(帧调度和本分析)
+    kStageScope,      // showMoproboWindow
+    kStageHistogram,  // showHistogram
+    kStageRender,     // ImGui::Render
+    kStageDrawData,   // ImGui_ImplOpenGL3_RenderDrawData
+    kStageSwap,       // 交换缓冲，开启垂直同步时在此等待
+    kStageCount
+};
+
+// 一帧的记录，时间单位ms
+struct FrameRecord {
+    float stage[kStageCount];
+    float work;  // 不含事件等待和交换缓冲，即本帧实际消耗的CPU时间
+    int vertices;
+    int indices;
+};
+
+class FrameProfiler {
+    FrameProfiler();
+
+public:
+    // 显示的帧数
+    static constexpr size_t kHistory = 600;
+
+    static FrameProfiler& getInstance() {
+        static FrameProfiler instance;
+        return instance;
+    }
+    ~FrameProfiler() = default;
+
+    // 以下仅在GUI线程调用
+    void beginFrame();
+    void mark(ProfileStage stage);
+    // drawData为空时顶点和索引数记为0
+    void endFrame(const ImDrawData* drawData);
+
+    /**
+     * @brief 累计信号源本帧进入的点数，用于计算每秒点数
+     * @param source 区分信号源，只作为键使用
+     * @param scope,name 首次出现时组成显示的名字
+     */
+    void ingest(const void* source, const std::string& scope,
+                const std::string& name, size_t count);
+    // 注销信号源，source被释放前调用，否则地址被复用时会沿用旧的名字
+    void removeSource(const void* source);
+
+    void showFrameProfiler();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Ingest {
+        std::string label;
+        uint64_t count{0};
+        float rate{0};
+    };
+
+    void collect();
+    void updateRates(Clock::time_point now);
+    // 历史中第index个序列的p50/p95/p99，index为kStageCount时是work
+    void percentiles(size_t index, float out[3]);
+    void plotSeries(const char* label, const float* first) const;
+
+    SpscRing<FrameRecord> m_records;
+    Clock::time_point m_last{};
+    FrameRecord m_current{};
+
+    std::vector<Ingest> m_ingest;
+    std::unordered_map<const void*, size_t> m_ingestIndex;
+    Clock::time_point m_rateStart{};
+
+    // 显示用的历史，满后环绕覆盖
+    std::vector<FrameRecord> m_history;
+    size_t m_next{0};
+    size_t m_size{0};
+    bool m_paused{false};
+    std::vector<float> m_sorted;
+};
+
+};  // namespace MoproboGui
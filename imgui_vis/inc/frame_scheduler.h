@@ -0,0 +1,105 @@
+/**
+ * @file frame_scheduler.h
+ * @brief
+ * 主循环按需刷新：没有输入事件也没有新数据时不绘制，空闲时不占用CPU。
+ *
+ * 主循环每帧开始前调用waitFrame()，在其中等待窗口事件；
+ * 采样线程写入数据后调用notify()，经唤醒函数(如glfwPostEmptyEvent)结束等待，
+ * 同一帧内多次notify()只唤醒一次。帧率不超过maxFps；
+ * 空闲时每1/idleFps秒仍绘制一帧，用于录制超时刷新等周期性工作。
+ * 本类不依赖GLFW，等待和唤醒函数由主程序提供。
+ *
+ * 同时统计每秒的帧数、唤醒次数以及进程和GUI线程的CPU占用，用于对比空闲与
+ * 数据流入时的开销。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace MoproboGui {
+
+struct FrameConfig {
+    bool onDemand{true};  // false时每次都绘制，与原来的轮询方式相同
+    float maxFps{60};
+    float idleFps{2};  // 0表示空闲时一直等待
+    // 输入事件后继续绘制的帧数，让悬停、展开等状态在下一帧显示出来
+    int settleFrames{2};
+};
+
+// 最近一秒的统计
+struct FrameStats {
+    float fps{0};
+    float dataWakeups{0};  // 每秒因新数据唤醒的次数
+    float processCpu{0};   // 进程CPU占用，1.0为一个核满载
+    float guiCpu{0};       // GUI线程CPU占用
+};
+
+class FrameScheduler {
+    FrameScheduler() = default;
+
+public:
+    using WaitFunc = void (*)(double timeout);
+    using PollFunc = void (*)();
+    using WakeFunc = void (*)();
+
+    static FrameScheduler& getInstance() {
+        static FrameScheduler instance;
+        return instance;
+    }
+    ~FrameScheduler() = default;
+
+    // 仅在GUI线程修改
+    FrameConfig& config() { return m_config; }
+
+    // 唤醒主循环的函数，须可在任意线程调用；
+    // 置空前应先停止写数据的线程，否则它们可能仍在调用原来的函数
+    void setWakeup(WakeFunc wakeup) {
+        m_wakeup.store(wakeup, std::memory_order_release);
+    }
+
+    // 任意线程调用，表示有新数据需要显示
+    void notify() {
+        if (m_pending.load(std::memory_order_relaxed)) return;
+        if (!m_pending.exchange(true, std::memory_order_acq_rel)) {
+            const WakeFunc wakeup = m_wakeup.load(std::memory_order_acquire);
+            if (wakeup) wakeup();
+        }
+    }
+
+    /**
+     * @brief GUI线程在每帧开始前调用，阻塞到需要绘制下一帧为止
+     * @param wait 等待窗口事件，参数为最长等待秒数，如glfwWaitEventsTimeout
+     * @param poll 处理已到达的事件，不等待，如glfwPollEvents
+     */
+    void waitFrame(WaitFunc wait, PollFunc poll);
+
+    const FrameStats& stats() const { return m_stats; }
+
+    // 显示设置和统计，仅在GUI线程使用
+    void showFrameScheduler();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void account(bool dataWakeup);
+
+    FrameConfig m_config;
+    std::atomic<WakeFunc> m_wakeup{nullptr};
+    std::atomic<bool> m_pending{false};
+
+    // 以下仅由GUI线程访问
+    Clock::time_point m_lastFrame{};
+    int m_settle{0};
+
+    Clock::time_point m_statsStart{};
+    int64_t m_processCpu{0};
+    int64_t m_guiCpu{0};
+    int m_frames{0};
+    int m_dataWakeups{0};
+    FrameStats m_stats;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,121 @@
+/**
+ * @file quantile_sketch.h
+ * @brief
+ * 分位数草图(DDSketch)：按对数划分的桶计数，第i个桶为(γ^(i-1), γ^i]，
+ * γ = (1 + α) / (1 - α)，返回的分位数相对误差不超过α。
+ *
+ *  - 加入一个点只算一次对数并给桶加一，O(1)；
+ *  - 桶数有上限，超过时把绝对值最小的桶并入相邻的桶，
+ *    内存与点数无关，高分位数(p99、p99.9)的精度不受影响；
+ *  - 同样配置的草图可以直接按桶相加合并，各线程各自记录后合并到一起，
+ *    结果与所有点记录在同一个草图中相同；
+ *  - 数据变化后的首次查询重建一次各桶的累计计数，之后每个分位数
+ *    只在累计计数上二分查找，每帧查询多个分位数时不必反复遍历桶。
+ *
+ * 正负值分别计数，绝对值小于minValue的计为0。非有限值被忽略。
+ * 仅在一个线程使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MoproboGui {
+
+struct QuantileSketchConfig {
+    double accuracy{0.01};  // 相对误差α
+    size_t maxBins{2048};   // 正、负值各自的桶数上限
+    double minValue{1e-9};  // 绝对值小于此值的计为0
+};
+
+class QuantileSketch {
+public:
+    explicit QuantileSketch(
+        const QuantileSketchConfig& config = QuantileSketchConfig());
+    ~QuantileSketch() = default;
+
+    void add(double value);
+    void add(const float* values, size_t n);
+
+    /**
+     * @brief 合并另一个草图
+     * @return 两者的accuracy或minValue不同时不能合并，返回false
+     */
+    bool merge(const QuantileSketch& other);
+    void clear();
+
+    const QuantileSketchConfig& config() const { return m_config; }
+    uint64_t count() const { return m_count; }
+    // 以下在count()为0时返回0
+    double min() const;
+    double max() const;
+    double mean() const;
+
+    // q在[0, 1]内，O(log 桶数)，数据变化后的首次调用另需O(桶数)
+    double quantile(double q) const;
+
+    /**
+     * @brief 按数值从小到大遍历非空的桶
+     * @param func func(double lower, double upper, uint64_t count)，
+     *             数值为0的桶范围为[-minValue, minValue]
+     */
+    template <typename Func>
+    void forEachBin(Func&& func) const;
+
+private:
+    // 连续存放的桶计数，counts[k]为第offset + k个桶
+    struct Store {
+        int offset{0};
+        std::vector<uint64_t> counts;
+
+        // 超过maxBins时把最低的桶并入最低的保留桶
+        void add(int index, uint64_t n, size_t maxBins);
+        void merge(const Store& other, size_t maxBins);
+    };
+
+    int index(double magnitude) const;
+    // 按数值从小到大重建m_cumulative
+    void accumulate() const;
+    // 桶的上边界γ^i
+    double upper(int index) const;
+    // 桶内的代表值，与桶内任意值的相对误差不超过α
+    double value(int index) const;
+
+    QuantileSketchConfig m_config;
+    double m_gamma;
+    double m_multiplier;  // 1 / ln(γ)
+
+    Store m_positive;
+    Store m_negative;  // 按绝对值的桶号存放
+    uint64_t m_zero{0};
+    uint64_t m_count{0};
+    double m_sum{0};
+    double m_min{0};
+    double m_max{0};
+
+    // 依次为负值的桶(绝对值从大到小)、0、正值的桶的累计计数，
+    // add()/merge()/clear()后置为过期，在quantile()中按需重建
+    mutable std::vector<uint64_t> m_cumulative;
+    mutable bool m_cumulativeValid{false};
+};
+
+template <typename Func>
+void QuantileSketch::forEachBin(Func&& func) const {
+    const std::vector<uint64_t>& neg = m_negative.counts;
+    for (size_t k = neg.size(); k-- > 0;) {
+        if (neg[k] == 0) continue;
+        const int i = m_negative.offset + static_cast<int>(k);
+        func(-upper(i), -upper(i - 1), neg[k]);
+    }
+    if (m_zero > 0) func(-m_config.minValue, m_config.minValue, m_zero);
+    const std::vector<uint64_t>& pos = m_positive.counts;
+    for (size_t k = 0; k < pos.size(); ++k) {
+        if (pos[k] == 0) continue;
+        const int i = m_positive.offset + static_cast<int>(k);
+        func(upper(i - 1), upper(i), pos[k]);
+    }
+}
+
+};  // namespace MoproboGui
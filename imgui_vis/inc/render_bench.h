@@ -0,0 +1,43 @@
+/**
+ * @file render_bench.h
+ * @brief
+ * 渲染后端的顶点吞吐量基准：用同一组稠密的ImPlot曲线生成ImDrawData，
+ * 分别交给imgui_impl_opengl2(客户端数组，每次绘制都从内存重新提交顶点)
+ * 和imgui_impl_opengl3的三种上传方式(每个绘制列表glBufferData、
+ * 孤立缓冲加映射、持久映射)绘制，比较每帧耗时和每秒顶点数。
+ *
+ * 计时包括RenderDrawData和glFinish，即GPU真正取完顶点为止。
+ * 用法：imgui_vis --bench-render [--frames=N] [--lines=N] [--points=N]
+ *                 [--size=WxH]
+ */
+
+#pragma once
+
+namespace MoproboGui {
+
+struct RenderBenchConfig {
+    int width{1280};
+    int height{720};
+    int frames{300};
+    int warmup{30};
+    int lines{8};
+    int points{10000};  // 每条曲线的点数
+
+    // opengl2后端不支持ImGuiBackendFlags_RendererHasVtxOffset，每个绘制列表
+    // 最多65536个顶点，每条曲线单独一个绘制列表，每段线4个顶点
+    static constexpr int kMaxPoints = 15000;
+};
+
+/**
+ * @brief 解析命令行
+ * @return 是否指定了--bench-render
+ */
+bool parseRenderBench(int argc, char** argv, RenderBenchConfig* config);
+
+/**
+ * @brief 依次用各个后端绘制并输出结果到stdout，返回进程退出码
+ * 调用前须已有当前的GL上下文和ImGui、ImPlot上下文，且未初始化渲染后端
+ */
+int runRenderBench(const RenderBenchConfig& config);
+
+};  // namespace MoproboGui
@@ -0,0 +1,118 @@
+/**
+ * @file scope_expr.h
+ * @brief
+ * 运算通道的表达式：编译一次为栈式字节码，之后按块对整列数据求值。
+ *
+ * 语法：+ - * /、括号、数字、通道名，以及函数
+ *  abs(x)  sqrt(x)  min(a, b)  max(a, b)
+ *  avg(x, n)   最近n个点的滑动平均
+ *  diff(x)     对时间的导数(每秒)
+ *  integ(x)    对时间的积分(梯形法)
+ *  lpf(x, fc)  截止频率为fc(Hz)的一阶低通
+ * 通道名由字母、数字、'_'、'.'和非ASCII字符组成，不能以数字开头，
+ * 含其他字符时用反引号括起，如 `电机 1` - b。
+ * 后四个函数带状态，跨块连续计算，每个新点只计算一次；n和fc必须是常数。
+ * 每条指令处理一整块数据，无状态的运算按SSE2/NEON每次计算4个点。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MoproboGui {
+
+class ScopeExpr {
+public:
+    // 每条指令一次处理的点数，更长的输入分块计算
+    static constexpr size_t kBlock = 512;
+
+    ScopeExpr() = default;
+    ~ScopeExpr() = default;
+
+    // 编译失败时返回false，原因见error()
+    bool compile(const std::string& text);
+    const std::string& text() const { return m_text; }
+    const std::string& error() const { return m_error; }
+
+    // 表达式引用的通道名，evaluate()的inputs按此顺序传入
+    const std::vector<std::string>& variables() const { return m_variables; }
+
+    // 清除带状态函数的历史，输入数据不连续时调用
+    void reset();
+
+    /**
+     * @brief 计算count个点
+     * @param times 各点的时间戳(ns)
+     * @param inputs 每个变量一列，各count个点
+     * @param out 结果，count个点
+     */
+    void evaluate(const int64_t* times, const float* const* inputs,
+                  size_t count, float* out);
+
+private:
+    enum class Op : uint8_t {
+        Input,
+        Const,
+        Neg,
+        Abs,
+        Sqrt,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Min,
+        Max,
+        Avg,
+        Diff,
+        Integ,
+        Lpf,
+    };
+    struct Code {
+        Op op;
+        uint32_t arg;  // Input为变量下标，带状态的函数为状态下标
+        float value;   // Const的值，avg的n，lpf的fc
+    };
+    struct State {
+        bool started{false};
+        int64_t lastTime{0};
+        double last{0};
+        double sum{0};
+        std::vector<float> window;  // avg的最近n个点
+        size_t pos{0};
+        size_t filled{0};
+        int64_t step{-1};  // lpf上一次计算系数时的采样间隔(ns)
+        double gain{0};
+    };
+
+    // 递归下降解析，出错时设置m_error并返回false
+    bool parseSum();
+    bool parseProduct();
+    bool parseUnary();
+    bool parsePrimary();
+    bool parseCall(const std::string& name);
+    bool parseName(std::string* name);
+    bool parseNumber(float* value);
+    bool expect(char c);
+    void skipSpace();
+    bool fail(const std::string& message);
+    void emit(Op op, uint32_t arg = 0, float value = 0);
+
+    void run(const int64_t* times, const float* const* inputs, size_t count);
+
+    std::string m_text;
+    std::string m_error;
+    size_t m_cursor{0};
+
+    std::vector<std::string> m_variables;
+    std::vector<Code> m_code;
+    std::vector<State> m_states;
+    int m_depth{0};
+    int m_maxDepth{0};
+    // 每个栈位置一块kBlock个点
+    std::vector<float> m_stack;
+};
+
+};  // namespace MoproboGui
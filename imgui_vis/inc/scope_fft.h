@@ -0,0 +1,51 @@
+/**
+ * @file scope_fft.h
+ * @brief
+ * 实数输入的基2 FFT，供频谱分析使用。
+ *
+ * N点实数序列打包成N/2点复数序列做复数FFT，再拆分出前N/2+1个频点。
+ * 位反转表和各级旋转因子在构造时预先算好，变换过程中不再调用三角函数；
+ * 数据按实部、虚部分开存放，蝶形运算在SSE2/NEON下一次处理4个点。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MoproboGui {
+
+class RealFft {
+public:
+    // size为2的幂，且不小于4
+    explicit RealFft(size_t size);
+    ~RealFft() = default;
+
+    size_t size() const { return m_size; }
+
+    /**
+     * @brief 正变换
+     * @param in size()个实数
+     * @param re,im 输出size()/2+1个频点的实部和虚部，未归一化
+     */
+    void forward(const float* in, float* re, float* im);
+
+private:
+    // 对m_re/m_im中已按位反转排列的m_half点数据做原位复数FFT
+    void transform();
+
+    const size_t m_size;
+    const size_t m_half;
+    std::vector<uint32_t> m_bitrev;
+    // 每级蝶形的旋转因子，跨度为h的一级存放在[h, 2h)
+    std::vector<float> m_twRe;
+    std::vector<float> m_twIm;
+    // 拆分实数频谱用的旋转因子 exp(-2πik/N)
+    std::vector<float> m_splitRe;
+    std::vector<float> m_splitIm;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+};
+
+};  // namespace MoproboGui
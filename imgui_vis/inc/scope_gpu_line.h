@@ -0,0 +1,96 @@
+/**
+ * @file scope_gpu_line.h
+ * @brief
+ * 在GPU上展开波形折线：原始采样只在到达时追加上传一次到GL缓冲，
+ * 绘制时通过ImDrawList::AddCallback插入一次实例化绘制，
+ * 每个线段一个实例，由顶点着色器从缓冲纹理取两个端点，
+ * 扩展成带抗锯齿边的四边形。
+ * 每帧CPU只做两次二分查找和一次回调，与可见点数无关；
+ * ImPlot的RendererLineStrip则要为每个线段在CPU上生成4个顶点和6个索引。
+ *
+ * GPU缓冲是长度固定的环形数组，按ScopeStore的序号定位，
+ * 时间戳存为相对首个点的秒数，拆成高低两个float，在着色器中相减以保留精度。
+ *
+ * 需要imgui_impl_opengl3后端和GL 3.1(缓冲纹理、实例化绘制)。
+ * 不满足时(如无界面模式)、可见区间超出GPU缓冲、坐标轴非线性或需要自动适配范围时
+ * plotLine()返回false，由调用者退回CPU上的抽取绘制。
+ * 仅在GUI线程使用，GL对象在有当前上下文时创建和释放。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scope_store.h"
+
+struct ImDrawList;
+struct ImDrawCmd;
+
+namespace MoproboGui {
+
+class ScopeGpuLine {
+public:
+    // GPU缓冲最多保存的点数，每点12字节
+    static constexpr size_t kMaxSamples = 1 << 20;
+
+    explicit ScopeGpuLine(size_t capacity);
+    ~ScopeGpuLine();
+
+    ScopeGpuLine(const ScopeGpuLine&) = delete;
+    ScopeGpuLine& operator=(const ScopeGpuLine&) = delete;
+
+    // 当前渲染后端和GL上下文是否支持，结果在首次调用时确定
+    static bool supported();
+    // 全局开关，默认打开
+    static bool enabled();
+    static void setEnabled(bool enabled);
+    static bool usable() { return enabled() && supported(); }
+
+    /**
+     * @brief 在当前ImPlot绘图中绘制store的channel通道，先上传新增的点
+     * @param origin,xmin,xmax 与ScopeLod::plotLine()相同
+     * @return 无法在GPU上绘制时返回false，此时没有提交任何绘制
+     */
+    bool plotLine(const char* label, const ScopeStore& store, size_t channel,
+                  int64_t origin, double xmin, double xmax);
+
+private:
+    // 追加上传store中新增的点，检测到存储被清空时从头上传
+    void sync(const ScopeStore& store, size_t channel);
+    void upload(const ScopeStore& store, size_t channel, uint64_t seq,
+                size_t count);
+
+    static void render(const ImDrawList* list, const ImDrawCmd* cmd);
+
+    // 一次绘制的参数，在回调中使用，每帧只绘制一次
+    struct Draw {
+        int first;  // 首个线段起点在环形数组中的位置
+        int count;  // 线段数
+        float origin[2];
+        float xMap[2];  // 像素X = xMap[0] + xMap[1] * 秒数
+        float yMap[3];  // 像素Y = yMap[0] + yMap[1] * (数值 - yMap[2])
+        float color[4];
+        float halfWidth;
+        float display[4];  // 显示区域的位置和大小
+        float scale[2];    // 帧缓冲缩放
+    };
+
+    const size_t m_ring;
+    unsigned int m_buffers[2]{0, 0};   // 时间(RG32F)、数值(R32F)
+    unsigned int m_textures[2]{0, 0};  // 对应的缓冲纹理
+    // GPU缓冲中有效的序号范围[m_begin, m_end)
+    uint64_t m_begin{0};
+    uint64_t m_end{0};
+    int64_t m_base{0};      // 时间戳的零点(ns)
+    int64_t m_lastTime{0};  // 序号m_end-1的时间戳，用于发现存储被清空重写
+
+    std::vector<int64_t> m_times;
+    std::vector<float> m_values;
+    std::vector<float> m_texels;
+
+    Draw m_draw{};
+};
+
+};  // namespace MoproboGui
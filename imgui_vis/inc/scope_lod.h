@@ -0,0 +1,180 @@
+/**
+ * @file scope_lod.h
+ * @brief
+ * 波形数据的多分辨率min/max金字塔，用于按屏幕像素宽度抽取曲线。
+ *
+ * 第k层的每个桶覆盖fanout^k个原始点，记录桶内最小值、最大值及二者先后顺序，
+ * 绘制时每个桶输出两个点，因此尖峰不会因抽取而丢失。
+ * 桶按ScopeStore的序号定位，每层是一个环形数组，随存储一起淘汰旧数据。
+ * 新点只写入第1层，桶写满后才合并进上一层，均摊追加代价为O(1)；
+ * 各层未写满的桶在读取时再合并。分层的结构由LodPyramid实现，桶的内容可替换。
+ * 可用时优先交给ScopeGpuLine在GPU上绘制原始数据，否则在CPU上抽取。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "data_comm.h"
+#include "scope_gpu_line.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+struct LodBucket {
+    float lo;
+    float hi;
+    bool loFirst;  // 最小值是否先于最大值出现
+
+    void merge(const LodBucket& later);
+};
+
+/**
+ * @brief 按序号分桶的多层金字塔，ScopeLod和ScopeXY共用。
+ *
+ * Bucket为一个桶的摘要，须提供merge(const Bucket& later)把后出现的桶合并进来。
+ * 第0层为原始数据，不在金字塔中存放。
+ */
+template <typename Bucket>
+class LodPyramid {
+public:
+    // capacity为对应ScopeStore的容量(点数)
+    LodPyramid(size_t capacity, int fanout);
+
+    // 追加序号为seq的点，seq必须连续递增，为0时重新开始
+    void append(uint64_t seq, const Bucket& point);
+
+    int levels() const { return static_cast<int>(m_levels.size()) + 1; }
+    uint64_t bucketSize(int level) const;
+    // 第level层(>= 1)第index个桶，index必须仍在存储的有效范围内
+    Bucket bucket(int level, uint64_t index) const;
+
+private:
+    struct Level {
+        size_t ringSize;
+        size_t slot{0};  // 当前未写满的桶
+        int fill{0};     // 当前桶已合并的下层元素个数
+        // 环形数组按需增长到ringSize后循环覆盖
+        std::vector<Bucket> ring;
+    };
+
+    const int m_fanout;
+    uint64_t m_count{0};
+    std::vector<Level> m_levels;
+};
+
+class ScopeLod {
+public:
+    // capacity为对应ScopeStore的容量(点数)
+    explicit ScopeLod(size_t capacity, int fanout = 4);
+    ~ScopeLod() = default;
+    ScopeLod(ScopeLod&&) = default;
+
+    // 追加序号为seq的点，seq必须连续递增，为0时重新开始
+    void append(uint64_t seq, float y);
+
+    int levels() const { return m_pyramid.levels(); }
+
+    // 第level层每个桶覆盖的原始点数，第0层为原始数据
+    uint64_t bucketSize(int level) const { return m_pyramid.bucketSize(level); }
+
+    /**
+     * @brief 选择能让[first, last)区间输出不超过maxPoints个点的最细层级
+     * @return int 0表示直接使用原始数据
+     */
+    int pickLevel(uint64_t first, uint64_t last, size_t maxPoints) const;
+
+    // 第level层第index个桶，index必须仍在存储的有效范围内
+    LodBucket bucket(int level, uint64_t index) const {
+        return m_pyramid.bucket(level, index);
+    }
+
+    /**
+     * @brief 使用ImPlot绘制曲线，ScopeGpuLine可用时在GPU上绘制原始数据，
+     * 否则按可见区间和像素宽度自动选择层级
+     * @param label 曲线名
+     * @param store 与本金字塔同步追加的原始数据
+     * @param channel 本金字塔对应store中的通道
+     * @param origin X轴零点对应的时间戳(ns)，X轴单位为秒
+     * @param xmin,xmax 当前X轴范围(相对origin的秒数)
+     * @param pixels 绘图区像素宽度
+     */
+    void plotLine(const char* label, const ScopeStore& store, size_t channel,
+                  int64_t origin, double xmin, double xmax, int pixels) const;
+
+private:
+    LodPyramid<LodBucket> m_pyramid;
+    // GPU上的原始数据副本，属于绘制缓存，首次在GPU上绘制时创建
+    mutable std::unique_ptr<ScopeGpuLine> m_gpu;
+};
+
+template <typename Bucket>
+LodPyramid<Bucket>::LodPyramid(size_t capacity, int fanout)
+    : m_fanout(fanout < 2 ? 2 : fanout) {
+    size_t size = m_fanout;
+    do {
+        Level level;
+        level.ringSize = capacity / size + 2;
+        m_levels.push_back(std::move(level));
+        size *= m_fanout;
+    } while (size <= capacity);
+}
+
+template <typename Bucket>
+void LodPyramid<Bucket>::append(uint64_t seq, const Bucket& point) {
+    if (seq == 0) {
+        for (auto& level : m_levels) level.slot = level.fill = 0;
+    }
+    m_count = seq + 1;
+    Bucket carry = point;
+    for (auto& level : m_levels) {
+        if (level.fill == 0) {
+            if (level.slot == level.ring.size()) {
+                level.ring.push_back(carry);
+            } else {
+                level.ring[level.slot] = carry;
+            }
+        } else {
+            level.ring[level.slot].merge(carry);
+        }
+        if (++level.fill < m_fanout) break;
+        // 桶已写满，合并进上一层
+        carry = level.ring[level.slot];
+        level.fill = 0;
+        if (++level.slot == level.ringSize) level.slot = 0;
+    }
+}
+
+template <typename Bucket>
+uint64_t LodPyramid<Bucket>::bucketSize(int level) const {
+    uint64_t size = 1;
+    for (int i = 0; i < level; ++i) size *= m_fanout;
+    return size;
+}
+
+template <typename Bucket>
+Bucket LodPyramid<Bucket>::bucket(int level, uint64_t index) const {
+    const Level& self = m_levels[level - 1];
+    if (index != m_count / bucketSize(level)) {
+        return self.ring[index % self.ringSize];
+    }
+    // 最新的桶：依次合并本层及各下层尚未写满的部分
+    Bucket ret{};
+    bool empty = true;
+    for (int i = level - 1; i >= 0; --i) {
+        const Level& part = m_levels[i];
+        if (part.fill == 0) continue;
+        if (empty) {
+            ret = part.ring[part.slot];
+            empty = false;
+        } else {
+            ret.merge(part.ring[part.slot]);
+        }
+    }
+    return ret;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,63 @@
+/**
+ * @file scope_persistence.h
+ * @brief
+ * 示波器的余辉(persistence)显示：把每次扫描的波形叠加到固定大小的亮度网格，
+ * 网格随时间衰减，以热力图画在实时波形下面，用于观察抖动和偶发毛刺。
+ *
+ * 网格按列存放，每次扫描逐列求出波形覆盖的行区间，对连续的一段行加1，
+ * 用SSE2/NEON一次处理4个像素；同一次扫描中每个像素最多加1。
+ * 衰减是对整个网格乘以系数，代价只与网格大小有关，与保留的扫描次数无关。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+class ScopePersistence {
+public:
+    ScopePersistence(int width = 256, int height = 96);
+    ~ScopePersistence() = default;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /**
+     * @brief 设置网格覆盖的范围，与当前范围不同时清空网格
+     * @param xmin,xmax 相对扫描零点的秒数
+     */
+    void setRange(double xmin, double xmax, double ymin, double ymax);
+
+    void clear();
+
+    // 叠加一次扫描：store中时间在origin+[xmin, xmax]内的点，origin为零点(ns)
+    void addSweep(const ScopeStore& store, size_t channel, int64_t origin);
+
+    // 所有像素乘以factor
+    void decay(float factor);
+
+    // 使用ImPlot绘制热力图，仅在GUI线程使用
+    void plot(const char* label) const;
+
+private:
+    // 第col列的[row0, row1]行各加1
+    void addSpan(int col, int row0, int row1);
+
+    const int m_width;
+    const int m_height;
+    double m_xmin{0};
+    double m_xmax{1};
+    double m_ymin{0};
+    double m_ymax{1};
+    // 按列存放，每列m_height个，第0行对应ymax
+    std::vector<float> m_grid;
+    // 网格中的最大亮度，衰减时同比例缩小
+    float m_peak{0};
+};
+
+};  // namespace MoproboGui
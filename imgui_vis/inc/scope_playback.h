@@ -0,0 +1,109 @@
+/**
+ * @file scope_playback.h
+ * @brief
+ * 通过mmap回放ScopeRecorder录制的文件。
+ *
+ * 打开时只读取文件尾部的索引，每路数据的块按时间排序，
+ * 按时间定位为对块的二分查找，与录制时长无关，为O(log n)。
+ * 绘制时只访问可见范围内的数据块：可见块数多于像素时直接使用索引中的
+ * 每块[min, max]摘要，完全不读数据块；否则逐块读取，数值列直接指向映射内存，
+ * 按像素宽度抽取为min/max点对。文件未正常关闭(没有索引)时顺序扫描重建索引。
+ * 仅在GUI线程使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "scope_record.h"
+
+namespace MoproboGui {
+
+class ScopePlayback {
+public:
+    struct Stream {
+        std::string window;
+        std::string plot;
+        std::vector<std::string> channels;
+        // 本路数据的Data块在索引中的下标，按时间排序
+        std::vector<uint32_t> blocks;
+    };
+
+    ScopePlayback() = default;
+    ~ScopePlayback();
+
+    ScopePlayback(const ScopePlayback&) = delete;
+    ScopePlayback& operator=(const ScopePlayback&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    const std::string& error() const { return m_error; }
+    const std::string& path() const { return m_path; }
+
+    const std::vector<Stream>& streams() const { return m_streams; }
+
+    // 录制开始时刻(CLOCK_MONOTONIC/CLOCK_REALTIME, ns)，X轴零点
+    int64_t startTime() const { return m_header.startMono; }
+    int64_t startRealTime() const { return m_header.startReal; }
+    // 录制时长(s)
+    double duration() const;
+
+    /**
+     * @brief 使用ImPlot绘制一个通道
+     * @param xmin,xmax 当前X轴范围(相对录制开始的秒数)
+     * @param pixels 绘图区像素宽度
+     */
+    void plotLine(const char* label, size_t stream, size_t channel,
+                  double xmin, double xmax, int pixels);
+
+private:
+    struct Cache {
+        double xmin{0};
+        double xmax{0};
+        int pixels{0};
+        std::vector<double> xs;
+        std::vector<double> ys;
+    };
+
+    bool loadIndex();
+    void rebuildIndex();
+    bool parseStream(const RecordIndexEntry& entry);
+
+    const RecordBlockHeader* blockHeader(const RecordIndexEntry& entry) const;
+    // Data块的时间列，压缩存放时解码到m_times
+    const int64_t* blockTimes(const RecordIndexEntry& entry);
+    const float* blockValues(const RecordIndexEntry& entry, size_t channel,
+                             size_t channels) const;
+
+    // [first, last)块内的数据按bucket个点一组抽取
+    void decimate(const Stream& stream, size_t channel, size_t first,
+                  size_t last, int64_t t0, int64_t t1, int pixels,
+                  Cache* cache);
+
+    std::string m_path;
+    std::string m_error;
+    int m_fd{-1};
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+
+    RecordFileHeader m_header{};
+    // 指向映射内存中的索引和摘要，重建时指向下面的vector
+    const RecordIndexEntry* m_entries{nullptr};
+    size_t m_count{0};
+    const float* m_summary{nullptr};
+    size_t m_summaryCount{0};
+    std::vector<RecordIndexEntry> m_rebuiltEntries;
+    std::vector<float> m_rebuiltSummary;
+    int64_t m_endTime{0};
+
+    std::vector<Stream> m_streams;
+    // 每路每个通道上一次的抽取结果，视图不变时直接复用
+    std::vector<std::vector<Cache>> m_cache;
+    std::vector<int64_t> m_times;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,198 @@
+/**
+ * @file scope_record.h
+ * @brief
+ * 示波器数据录制：把各曲线从队列取出的数据写入分块的二进制文件。
+ *
+ * 文件格式(小端)：
+ *  RecordFileHeader
+ *  若干数据块，每块为RecordBlockHeader加负载，按8字节对齐：
+ *   - Stream块：登记一路数据(窗口名、曲线名、各通道名)
+ *   - Data块：一路数据的连续count个点，先是时间列，再是各通道的float数值列；
+ *     时间列可用首点差分+varint压缩，数值列不压缩，回放时可直接映射使用
+ *  Index块：每个块的时间范围和文件偏移，之后是摘要区，
+ *   按顺序存放每个Data块各通道的[min, max]，回放缩小显示时不必读取数据块
+ *  RecordTrailer：Index块的偏移，文件未正常关闭时没有，回放可顺序扫描块头重建
+ *
+ * 线程模型：GUI线程在drain()时调用capture()，只把新数据拷贝进待写块；
+ * 块写满或超时后交给写线程编码并写盘。写线程跟不上时丢弃整块并计数，
+ * 不会阻塞GUI线程和采样线程。
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+constexpr char kRecordMagic[8] = {'M', 'P', 'S', 'C', 'O', 'P', 'E', '1'};
+constexpr uint32_t kRecordVersion = 1;
+constexpr uint32_t kRecordBlockMagic = 0x4b4c4250;  // "PBLK"
+
+enum RecordBlockType : uint16_t {
+    kRecordStream = 1,
+    kRecordData = 2,
+    kRecordIndex = 3,
+};
+
+enum RecordBlockFlag : uint16_t {
+    kRecordTimeVarint = 1 << 0,  // 时间列为首点差分+varint
+};
+
+struct RecordFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t startMono;  // 开始录制时的CLOCK_MONOTONIC(ns)
+    int64_t startReal;  // 同一时刻的CLOCK_REALTIME(ns)
+};
+
+struct RecordBlockHeader {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t flags;
+    uint32_t stream;
+    uint32_t count;      // Data块的点数，Index块的条目数
+    int64_t firstTime;   // ns
+    int64_t lastTime;    // ns
+    uint64_t payload;    // 负载字节数，不含对齐填充
+};
+
+struct RecordIndexEntry {
+    uint32_t stream;
+    uint32_t count;  // Stream块为0
+    int64_t firstTime;
+    int64_t lastTime;
+    uint64_t offset;   // 块头在文件中的偏移
+    uint64_t summary;  // 各通道[min, max]在摘要区的下标(以float计)
+};
+
+struct RecordTrailer {
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+static_assert(sizeof(RecordFileHeader) == 32, "record header layout");
+static_assert(sizeof(RecordBlockHeader) == 40, "record block layout");
+static_assert(sizeof(RecordIndexEntry) == 40, "record index layout");
+static_assert(sizeof(RecordTrailer) == 16, "record trailer layout");
+
+// 块负载按8字节对齐
+inline uint64_t recordAlign(uint64_t bytes) { return (bytes + 7) & ~7ull; }
+
+struct RecordConfig {
+    bool compressTimes{true};
+    size_t queueBytes{256 << 20};  // 写线程积压上限，超过后丢弃
+    double flushSeconds{0.5};      // 未写满的块最长等待时间
+};
+
+class ScopeRecorder {
+public:
+    // Data块最多的点数
+    static constexpr size_t kBlockSamples = 4096;
+
+    explicit ScopeRecorder(const RecordConfig& config = RecordConfig());
+    ~ScopeRecorder();
+
+    ScopeRecorder(const ScopeRecorder&) = delete;
+    ScopeRecorder& operator=(const ScopeRecorder&) = delete;
+
+    // 以下接口均在GUI线程调用
+    bool start(const std::string& path);
+    // 写出剩余数据和索引后关闭文件
+    void stop();
+    bool recording() const { return m_thread.joinable(); }
+
+    // 登记一路数据，返回capture()使用的编号
+    uint32_t addStream(const std::string& window, const std::string& plot,
+                       const std::vector<std::string>& channels);
+
+    // 停止记录一路数据，未满的块立即交给写线程，之后该编号的capture()被忽略
+    void removeStream(uint32_t stream);
+
+    // 记录store中从序号from开始新增的数据
+    void capture(uint32_t stream, const ScopeStore& store, uint64_t from);
+
+    // 每帧调用，把等待超时的未满块交给写线程
+    void poll();
+
+    uint64_t bytesWritten() const {
+        return m_written.load(std::memory_order_relaxed);
+    }
+    uint64_t dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+    // 写文件出错后为true，此后的数据全部丢弃，bytesWritten()不再增加
+    bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+    // 写文件出错时返回错误信息
+    std::string error();
+
+private:
+    struct Block {
+        uint16_t type{kRecordData};
+        uint32_t stream{0};
+        uint32_t channels{1};
+        size_t count{0};
+        std::vector<int64_t> times;
+        std::vector<float> values;  // 按通道分列，每列kBlockSamples个
+        std::string meta;           // Stream块的负载
+    };
+    struct Stream {
+        uint32_t channels;
+        std::unique_ptr<Block> pending;
+        std::chrono::steady_clock::time_point since;
+        bool removed{false};
+    };
+
+    std::unique_ptr<Block> takeBlock(uint32_t stream, uint32_t channels);
+    void submit(std::unique_ptr<Block> block);
+
+    // 以下仅由写线程调用
+    void run();
+    void encode(const Block& block);
+    void reserve(size_t bytes);
+    // 经写缓冲追加任意长度的数据
+    void append(const void* data, size_t bytes);
+    void flushOut();
+
+    const RecordConfig m_config;
+    std::vector<Stream> m_streams;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_quit{false};
+    std::deque<std::unique_ptr<Block>> m_queue;
+    std::vector<std::unique_ptr<Block>> m_free;
+    size_t m_queuedBytes{0};
+    std::string m_error;
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<bool> m_failed{false};
+
+    // 仅由写线程访问
+    int m_fd{-1};
+    uint64_t m_offset{0};  // 已写入文件和缓冲的字节数
+    struct OutDeleter {
+        void operator()(unsigned char* p) const;
+    };
+    std::unique_ptr<unsigned char, OutDeleter> m_out;
+    size_t m_outSize{0};
+    size_t m_outCapacity{0};
+    std::vector<RecordIndexEntry> m_index;
+    std::vector<float> m_summary;
+
+    std::thread m_thread;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,136 @@
+/**
+ * @file scope_spectrum.h
+ * @brief
+ * 波形曲线的实时频谱分析，输出平均频谱、峰值保持和瀑布图。
+ *
+ * GUI线程在drain()之后调用submit()，取信号源最新的size个点交给工作线程；
+ * 加窗、FFT、平均和瀑布图都在工作线程完成，结果做好后与GUI线程交换缓冲，
+ * GUI线程绘制时不持锁，也不会等待计算。工作线程忙时本帧不提交，
+ * 之后总是取最新的数据，因此显示不会落后于输入。
+ * 采样率由这段数据的时间戳估计，要求信号源大致等间隔采样。
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "scope_fft.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+enum class SpectrumWindow {
+    Rectangular,
+    Hann,
+    Blackman,
+};
+
+struct SpectrumConfig {
+    size_t size{4096};  // FFT点数，2的幂，最大kMaxSize
+    SpectrumWindow window{SpectrumWindow::Hann};
+    int averages{1};      // 功率谱指数平均的帧数，1表示不平均
+    bool peakHold{false};
+    float overlap{0.5f};  // 相邻两帧重叠的比例
+    int waterfallRows{64};
+    float minDb{-120};    // 显示范围
+    float maxDb{0};
+};
+
+class ScopeSpectrum {
+public:
+    static constexpr size_t kMinSize = 64;
+    static constexpr size_t kMaxSize = 1 << 16;
+    // 瀑布图每行最多的列数，频点多于此数时按最大值合并
+    static constexpr size_t kWaterfallCols = 256;
+
+    ScopeSpectrum();
+    ~ScopeSpectrum();
+
+    ScopeSpectrum(const ScopeSpectrum&) = delete;
+    ScopeSpectrum& operator=(const ScopeSpectrum&) = delete;
+
+    // GUI线程修改，下一次submit()时生效
+    SpectrumConfig& config() { return m_config; }
+
+    // 清除平均、峰值保持和瀑布图
+    void reset();
+
+    /**
+     * @brief GUI线程在drain()之后调用
+     * @return bool 提交了新的一帧返回true；
+     *              数据不足、新数据未达到帧移或工作线程忙时返回false
+     */
+    bool submit(const ScopeStore& store, size_t channel);
+
+    // 绘制频谱和瀑布图，仅在GUI线程使用
+    void show(const char* title);
+
+private:
+    struct Job {
+        std::vector<float> samples;
+        double rate{0};
+        SpectrumConfig config;
+        bool reset{false};
+    };
+    struct Result {
+        double rate{0};
+        size_t bins{0};
+        std::vector<float> average;  // dB
+        std::vector<float> peak;     // dB
+        // 按行存放，第0行为最新的一帧
+        std::vector<float> waterfall;
+        int rows{0};
+        int cols{0};
+        bool peakHold{false};
+    };
+
+    void run();
+    // 以下仅由工作线程调用
+    void analyze(const Job& job, Result* out);
+    void prepare(const Job& job);
+
+    SpectrumConfig m_config;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_quit{false};
+    bool m_busy{false};
+    bool m_hasJob{false};
+    bool m_fresh{false};
+    Job m_job;
+    Result m_ready;
+
+    // 仅由GUI线程访问
+    uint64_t m_lastEnd{0};
+    bool m_resetPending{false};
+    Result m_front;
+    std::vector<float> m_plotX;
+    std::vector<float> m_plotY;
+    std::vector<float> m_plotPeak;
+
+    // 仅由工作线程访问
+    std::unique_ptr<RealFft> m_fft;
+    SpectrumWindow m_windowType{SpectrumWindow::Hann};
+    std::vector<float> m_window;
+    float m_windowGain{1};
+    std::vector<float> m_input;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_power;
+    std::vector<float> m_peak;
+    int m_averaged{0};
+    std::vector<float> m_rows;  // 环形，每行kWaterfallCols列
+    int m_rowCount{0};
+    int m_rowHead{0};
+    int m_waterfallRows{0};
+
+    std::thread m_thread;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,96 @@
+/**
+ * @file scope_stats.h
+ * @brief
+ * 单个通道的统计量：最小、最大、均值、RMS、标准差、峰峰值和频率估计，
+ * 分别针对当前可见的时间段和整个会话。
+ *
+ * 新数据到达时每个点只处理一次：
+ *  - 会话统计用Welford算法累计均值和方差，数值稳定，O(1)更新；
+ *  - 每kStride个点记录一次前缀和(Σx、Σx²)，任意区间的均值、RMS只需
+ *    两个前缀和加上两端不足kStride的零散点；
+ *  - 区间最小、最大值直接查ScopeLod金字塔，按层分解区间，O(log n)；
+ *  - 以会话均值为电平、带迟滞检测上升沿，记录沿的时刻，
+ *    区间频率为区间内沿的个数除以首尾沿的时间差，二分查找。
+ * 查询代价与区间内的点数无关。仅在GUI线程使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "scope_lod.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+struct StatsResult {
+    size_t count{0};
+    float min{0};
+    float max{0};
+    double mean{0};
+    double rms{0};
+    double stddev{0};
+    double frequency{0};  // Hz，上升沿少于两个时为0
+};
+
+class ScopeStats {
+public:
+    // 前缀和的间隔(点数)
+    static constexpr size_t kStride = 64;
+
+    /**
+     * @param lod 与store同步维护的金字塔，用于区间最值
+     */
+    ScopeStats(const ScopeStore* store, const ScopeLod* lod, size_t channel);
+    ~ScopeStats() = default;
+
+    // 处理store中新增的点，每帧在数据drain()之后调用
+    void update();
+
+    StatsResult session() const;
+    // 时间在[t0, t1](ns)内的点
+    StatsResult window(int64_t t0, int64_t t1) const;
+
+private:
+    struct Prefix {
+        double sum;
+        double sumSq;
+    };
+
+    void restart();
+    // 序号为k * kStride之前所有点的前缀和
+    Prefix prefix(uint64_t k) const;
+    void rangeMinMax(uint64_t first, uint64_t last, float* lo,
+                     float* hi) const;
+
+    const ScopeStore* m_store;
+    const ScopeLod* m_lod;
+    const size_t m_channel;
+    // 已处理的序号范围，前缀和只对[m_start, m_end)有效
+    uint64_t m_start{0};
+    uint64_t m_end{0};
+
+    // 会话统计
+    size_t m_count{0};
+    double m_mean{0};
+    double m_m2{0};
+    float m_min{0};
+    float m_max{0};
+
+    // 前缀和按x - m_offset累计，避免直流分量大时方差被舍入误差淹没
+    double m_offset{0};
+    Prefix m_total{0, 0};
+    std::vector<Prefix> m_prefix;
+
+    // 上升沿检测，m_edges只保留store中仍有数据的部分
+    bool m_high{false};
+    std::deque<int64_t> m_edges;
+    uint64_t m_edgeCount{0};
+    int64_t m_firstEdge{0};
+    int64_t m_lastEdge{0};
+};
+
+};  // namespace MoproboGui
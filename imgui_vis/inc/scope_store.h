@@ -0,0 +1,143 @@
+/**
+ * @file scope_store.h
+ * @brief
+ * 单条波形曲线的历史数据存储，替代RollingBuffer。
+ *
+ * 数据按固定大小、缓存行对齐的块(Chunk)存放，块内按列存放(SoA)：
+ * 一列时间戳，加上每个通道一列数值，同一时钟采样的多个通道共用时间列。
+ * 块在首次使用时分配，
+ * 之后循环复用：容量用满或超出时长后整块淘汰最旧数据，不会重新分配内存。
+ * 每个点有一个从0开始递增的序号，淘汰只移动起始序号。
+ * 时间戳为CLOCK_MONOTONIC纳秒数(int64)，必须单调不减，按时间查询为二分查找。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace MoproboGui {
+
+struct ScopeSample {
+    int64_t time;  // CLOCK_MONOTONIC, ns
+    float value;
+};
+
+struct ScopeCapacity {
+    size_t bytes{64 << 20};  // 数据所占内存上限
+    double seconds{0};       // 保留时长，0表示只受内存上限约束
+};
+
+class ScopeStore {
+public:
+    static constexpr size_t kChunkSamples = 4096;
+
+    explicit ScopeStore(const ScopeCapacity& capacity = ScopeCapacity(),
+                        size_t channels = 1);
+    ~ScopeStore() = default;
+
+    ScopeStore(const ScopeStore&) = delete;
+    ScopeStore& operator=(const ScopeStore&) = delete;
+
+    // 写入通道0，时间戳比上一个点小时按上一个点的时间存储
+    void append(int64_t time, float value);
+    void append(const ScopeSample* samples, size_t count);
+    void append(const int64_t* times, const float* values, size_t count);
+
+    /**
+     * @brief 多通道写入：先追加时间列，再逐通道填写数值列
+     * @return uint64_t 新增行的起始序号，count不能超过capacity()
+     */
+    uint64_t appendTimes(const int64_t* times, size_t count);
+    void writeValues(size_t channel, uint64_t seq, const float* values,
+                     size_t count);
+
+    void clear();
+
+    // 有效数据的序号范围[begin, end)
+    uint64_t begin() const { return m_begin; }
+    uint64_t end() const { return m_end; }
+    size_t size() const { return static_cast<size_t>(m_end - m_begin); }
+    bool empty() const { return m_end == m_begin; }
+
+    size_t channels() const { return m_channels; }
+
+    // 最多可容纳的点数
+    size_t capacity() const { return m_chunks.size() * kChunkSamples; }
+
+    // 已分配的内存字节数
+    size_t memoryUsage() const;
+
+    int64_t time(uint64_t seq) const {
+        return timeColumn(chunk(seq))[seq % kChunkSamples];
+    }
+    float value(uint64_t seq, size_t channel = 0) const {
+        return valueColumn(chunk(seq), channel)[seq % kChunkSamples];
+    }
+
+    // 把[seq, seq+count)的时间戳或数值按块拷贝到dst，区间必须在[begin, end)内
+    void copyTimes(uint64_t seq, size_t count, int64_t* dst) const;
+    void copyValues(size_t channel, uint64_t seq, size_t count,
+                    float* dst) const;
+
+    // 第一个时间>=time的序号，不存在时返回end()
+    uint64_t lowerBound(int64_t time) const;
+    // 第一个时间>time的序号，不存在时返回end()
+    uint64_t upperBound(int64_t time) const;
+    /**
+     * @brief 时间在origin + [xmin, xmax]秒内的序号范围[*first, *last)
+     * @note 缩放到极端范围时xmin、xmax可能很大，换算成ns时截断，不会溢出
+     */
+    void findRange(int64_t origin, double xmin, double xmax, uint64_t* first,
+                   uint64_t* last) const;
+
+private:
+    // 块的内存布局：时间列，随后是各通道的数值列，每列均按缓存行对齐
+    using Chunk = unsigned char;
+    struct ChunkDeleter {
+        void operator()(Chunk* chunk) const;
+    };
+
+    static int64_t* timeColumn(Chunk* chunk) {
+        return reinterpret_cast<int64_t*>(chunk);
+    }
+    static const int64_t* timeColumn(const Chunk* chunk) {
+        return reinterpret_cast<const int64_t*>(chunk);
+    }
+    static float* valueColumn(Chunk* chunk, size_t channel) {
+        return reinterpret_cast<float*>(chunk + kTimeBytes +
+                                        channel * kValueBytes);
+    }
+    static const float* valueColumn(const Chunk* chunk, size_t channel) {
+        return reinterpret_cast<const float*>(chunk + kTimeBytes +
+                                              channel * kValueBytes);
+    }
+
+    static constexpr size_t kTimeBytes = kChunkSamples * sizeof(int64_t);
+    static constexpr size_t kValueBytes = kChunkSamples * sizeof(float);
+
+    // 准备写入第index块，必要时分配或淘汰
+    Chunk* beginChunk(uint64_t index);
+    void evictExpired();
+    template <typename Func>
+    void appendBlock(size_t count, Func&& fill);
+
+    const Chunk* chunk(uint64_t seq) const {
+        return m_chunks[(seq / kChunkSamples) % m_chunks.size()].get();
+    }
+    Chunk* chunk(uint64_t seq) {
+        return m_chunks[(seq / kChunkSamples) % m_chunks.size()].get();
+    }
+
+    const size_t m_channels;
+    const size_t m_chunkBytes;
+    const int64_t m_retainNs;
+    uint64_t m_begin{0};
+    uint64_t m_end{0};
+    std::vector<std::unique_ptr<Chunk, ChunkDeleter>> m_chunks;
+    std::vector<std::unique_ptr<Chunk, ChunkDeleter>> m_spare;
+};
+
+};  // namespace MoproboGui
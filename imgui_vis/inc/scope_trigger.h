@@ -0,0 +1,150 @@
+/**
+ * @file scope_trigger.h
+ * @brief
+ * 软件示波器的触发引擎，支持边沿、电平、脉宽、窗口四种触发条件，
+ * 以及自动(Auto)/常规(Normal)/单次(Single)三种触发方式。
+ *
+ * 触发检测在GUI线程从队列取出新数据后增量执行，每个点只检查一次，
+ * 不会重新扫描历史数据；预触发部分直接取自ScopeStore中的历史数据。
+ * 边沿触发时刻按相邻两点线性插值，显示冻结在精确的触发时刻上。
+ * 触发画面采满时，各曲线[触发-preTrigger, 触发+postTrigger]的数据
+ * 由capture()拷贝到触发引擎自己的缓冲，冻结显示期间不受历史数据淘汰影响。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "scope_lod.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+enum class TriggerType {
+    Edge,        // 穿越level
+    Level,       // 高于(Rising)或低于(Falling)level
+    PulseWidth,  // 正脉冲(Rising)或负脉冲(Falling)宽度在[minWidth, maxWidth]内
+    Window,      // 离开(Rising)或进入(Falling)[level, level2]窗口
+};
+
+enum class TriggerSlope {
+    Rising,
+    Falling,
+    Both,
+};
+
+enum class TriggerMode {
+    Auto,    // 无触发时自由滚动
+    Normal,  // 保持最近一次触发的画面
+    Single,  // 触发一次后停止，需重新arm
+};
+
+struct TriggerConfig {
+    TriggerType type{TriggerType::Edge};
+    TriggerSlope slope{TriggerSlope::Rising};
+    TriggerMode mode{TriggerMode::Auto};
+    float level{0.5f};
+    float level2{1.0f};       // 窗口触发的上限
+    float hysteresis{0};      // 边沿/脉宽判断的回差
+    double minWidth{0};       // 脉宽下限(s)
+    double maxWidth{1e-3};    // 脉宽上限(s)
+    double preTrigger{0.5};   // 触发点之前显示的时长(s)
+    double postTrigger{0.5};  // 触发点之后显示的时长(s)
+};
+
+class ScopeTrigger {
+public:
+    enum class State {
+        Stopped,    // 单次触发完成或未arm
+        Armed,      // 等待触发条件
+        Triggered,  // 已触发，等待后触发数据采满
+    };
+
+    ScopeTrigger() = default;
+    ~ScopeTrigger() = default;
+
+    TriggerConfig& config() { return m_config; }
+    const TriggerConfig& config() const { return m_config; }
+
+    // 修改配置后调用，清除检测状态并重新开始等待触发
+    void arm();
+    void stop();
+
+    // 数据源被清空时调用，丢弃已有的触发画面
+    void reset();
+
+    /**
+     * @brief 检查新追加到store的点，[first, last)为本帧新增的序号
+     * @param captures 非空时追加本次采满的每个触发画面的触发时刻(ns)
+     * @return 本次采满了新的触发画面时返回true，此时应对每条曲线调用capture()
+     */
+    bool process(const ScopeStore& store, size_t channel, uint64_t first,
+                 uint64_t last, std::vector<int64_t>* captures = nullptr);
+
+    // 开始记录新的触发画面，之后对要显示的每条曲线调用一次capture()
+    void beginCapture();
+    // 拷贝一条曲线在触发画面时间段内的数据
+    void capture(const std::string& name, const ScopeStore& store,
+                 size_t channel);
+    /**
+     * @brief 绘制capture()拷贝的曲线，X轴为相对触发时刻的秒数
+     * @param xmin,xmax 当前X轴范围
+     * @param pixels 绘图区像素宽度
+     */
+    void plotCapture(double xmin, double xmax, int pixels) const;
+
+    State state() const { return m_state; }
+
+    // 是否有已采满的触发画面
+    bool hasCapture() const { return m_hasCapture; }
+    // 是否应显示触发画面，latest为最新数据的时间，自动方式下超时后返回false
+    bool showCapture(int64_t latest) const;
+    // 最近一次采满的触发画面的触发时刻(ns)
+    int64_t captureTime() const { return m_captureTime; }
+    uint64_t triggerCount() const { return m_count; }
+
+private:
+    // 触发画面中的一条曲线
+    struct Trace {
+        Trace(const std::string& name, size_t capacity);
+
+        std::string name;
+        ScopeStore store;
+        ScopeLod lod;
+    };
+
+    // 检测到触发条件时返回true，并给出精确触发时刻
+    bool detect(int64_t time, float value, int64_t* when);
+
+    TriggerConfig m_config;
+    State m_state{State::Armed};
+
+    // 检测状态
+    bool m_havePrev{false};
+    int64_t m_prevTime{0};
+    float m_prevValue{0};
+    bool m_belowArmed{false};  // 曾低于level-hysteresis，可判上升沿
+    bool m_aboveArmed{false};  // 曾高于level+hysteresis，可判下降沿
+    bool m_inPulse{false};
+    bool m_pulsePositive{true};
+    int64_t m_pulseStart{0};
+    bool m_wasInside{false};
+
+    int64_t m_triggerTime{0};
+    bool m_hasCapture{false};
+    int64_t m_captureTime{0};
+    uint64_t m_count{0};
+
+    // 前m_traceCount条为当前触发画面的曲线，其余留待复用
+    std::vector<std::unique_ptr<Trace>> m_traces;
+    size_t m_traceCount{0};
+    // capture()按块拷贝用的临时数据
+    std::vector<int64_t> m_times;
+    std::vector<float> m_values;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,97 @@
+/**
+ * @file scope_xy.h
+ * @brief
+ * XY(李萨如)显示：把两个通道按时间对齐后，以一个作X、另一个作Y绘制。
+ *
+ * 两个通道的采样率可以不同。对齐在数据进入时以流式归并完成：
+ * 两个游标按时间顺序合并两路时间戳，每个时间戳上另一路按前后两点线性插值，
+ * 每个点只处理一次，不需要每帧查找。对齐结果存入双通道的ScopeStore。
+ *
+ * 抽取与ScopeLod共用LodPyramid：按序号分桶的多层金字塔，追加均摊O(1)。
+ * 一维曲线的桶只需记录min/max，XY轨迹的桶记录X、Y各自最小、最大的4个点，
+ * 绘制时按先后顺序连线，保留轨迹的外包络，百万点的轨迹也只画几千个点。
+ * 仅在GUI线程使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scope_lod.h"
+#include "scope_store.h"
+
+namespace MoproboGui {
+
+class ScopeXY {
+public:
+    /**
+     * @param x,y 两个通道所在的存储，可以是同一个
+     * @param xChannel,yChannel 通道在各自存储中的下标
+     */
+    ScopeXY(const ScopeStore* x, size_t xChannel, const ScopeStore* y,
+            size_t yChannel, const ScopeCapacity& capacity = ScopeCapacity(),
+            int fanout = 4);
+    ~ScopeXY() = default;
+
+    const ScopeStore* xSource() const { return m_x.store; }
+    const ScopeStore* ySource() const { return m_y.store; }
+
+    // 对齐两路新增的数据，返回新增的点数
+    size_t update();
+
+    // 对齐后的数据，通道0为X，通道1为Y
+    const ScopeStore& getBuffer() const { return m_buffer; }
+
+    /**
+     * @brief 使用ImPlot绘制时间在origin+[tmin, tmax]内的轨迹
+     * @param maxPoints 最多绘制的点数，超过时使用金字塔抽取
+     */
+    void plotLine(const char* label, int64_t origin, double tmin, double tmax,
+                  size_t maxPoints) const;
+
+private:
+    struct Cursor {
+        const ScopeStore* store;
+        size_t channel;
+        uint64_t next{0};  // 下一个待合并的序号
+        bool valid{false};  // 是否已有上一个点
+        int64_t time{0};    // 上一个点
+        float value{0};
+    };
+    struct Point {
+        float x;
+        float y;
+        uint64_t seq;
+    };
+    // 桶内X最小、X最大、Y最小、Y最大的点
+    struct Bucket {
+        Point p[4];
+        void merge(const Bucket& later);
+    };
+
+    // 信号源被清空或未合并的数据被淘汰时重新开始
+    void resync(Cursor* cursor);
+    // 在cursor的上一个点和(nextTime, next)之间插值出time时刻的值
+    static float interpolate(const Cursor& cursor, int64_t time, float next,
+                             int64_t nextTime);
+    void emit(int64_t time, float x, float y);
+    void flush();
+
+    Cursor m_x;
+    Cursor m_y;
+
+    std::vector<int64_t> m_times;
+    std::vector<float> m_xs;
+    std::vector<float> m_ys;
+
+    ScopeStore m_buffer;
+    LodPyramid<Bucket> m_lod;
+
+    // 绘制时的临时数据
+    mutable std::vector<double> m_plotX;
+    mutable std::vector<double> m_plotY;
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,71 @@
+/**
+ * @file soft_raster.h
+ * @brief
+ * ImDrawData的CPU软件光栅化，用于没有显示器和GPU的环境(如构建服务器)，
+ * 把无界面模式生成的帧保存为PNG，做回归对比。
+ *
+ * 按三角形的包围盒逐像素求重心坐标，插值顶点颜色和纹理坐标，
+ * 纹理按最近点采样，与帧缓冲做源alpha混合，按ImDrawCmd的裁剪矩形裁剪。
+ * 只认识字体纹理，其他纹理按白色处理，绘制回调跳过。目标是结果稳定、可以比较，
+ * 不追求与GPU逐像素一致，也不追求速度。
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ImDrawData;
+
+namespace MoproboGui {
+
+class SoftRasterizer {
+public:
+    SoftRasterizer(int width, int height);
+    ~SoftRasterizer() = default;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    /**
+     * @brief 设置字体纹理，数据须在使用期间有效
+     * @param id 绘制命令中字体纹理的ImTextureID
+     * @param rgba 来自ImFontAtlas::GetTexDataAsRGBA32
+     */
+    void setFontTexture(void* id, const unsigned char* rgba, int width,
+                        int height);
+
+    // 清屏，颜色各分量为0~1
+    void clear(float r, float g, float b);
+    void render(const ImDrawData* drawData);
+
+    // 帧缓冲，RGB各8位，逐行存放
+    const std::vector<uint8_t>& pixels() const { return m_pixels; }
+
+    // 失败时在error中给出原因
+    bool writePng(const std::string& path, std::string* error = nullptr) const;
+
+private:
+    struct Vertex {
+        float x;
+        float y;
+        float u;
+        float v;
+        float color[4];
+    };
+
+    void drawTriangle(const Vertex& a, const Vertex& b, const Vertex& c,
+                      bool textured, const int clip[4]);
+
+    const int m_width;
+    const int m_height;
+    std::vector<uint8_t> m_pixels;
+
+    void* m_fontId{nullptr};
+    const unsigned char* m_font{nullptr};
+    int m_fontWidth{0};
+    int m_fontHeight{0};
+};
+
+};  // namespace MoproboGui
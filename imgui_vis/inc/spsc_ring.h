@@ -0,0 +1,124 @@
+/**
+ * @file spsc_ring.h
+ * @brief
+ * 单生产者/单消费者无锁环形队列，用于采样线程向GUI线程传递波形数据。
+ *
+ * 生产者调用push()，队列满时直接丢弃并返回false，不会阻塞或自旋(wait-free)；
+ * 消费者在每帧开始时调用drain()，一次性取走上一帧以来到达的全部数据。
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MoproboGui {
+
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity = 1 << 16)
+        : m_mask(roundUp(capacity) - 1), m_slots(m_mask + 1) {}
+    ~SpscRing() = default;
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    // 生产者线程调用
+    bool push(const T& item) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tailCache > m_mask) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head - m_tailCache > m_mask) return false;
+        }
+        m_slots[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 生产者线程批量写入，只发布一次
+     * @param count 期望写入的个数，空间不足时只写入能容纳的部分
+     * @param fill fill(T* dst, size_t done, size_t n)填充dst[0, n)，
+     *             done为此前已填充的个数，环绕时最多被调用两次
+     * @return size_t 实际写入的个数
+     */
+    template <typename Func>
+    size_t push(size_t count, Func&& fill) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (capacity() - (head - m_tailCache) < count) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+        }
+        count = std::min(count, capacity() - (head - m_tailCache));
+        if (count == 0) return 0;
+        const size_t begin = head & m_mask;
+        const size_t first = std::min(count, capacity() - begin);
+        fill(&m_slots[begin], 0, first);
+        if (first < count) fill(&m_slots[0], first, count - first);
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者线程调用，func(const T* items, size_t n)最多被调用两次(环绕时)，
+    // 最多取出maxCount个
+    template <typename Func>
+    size_t drain(Func&& func, size_t maxCount = SIZE_MAX) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t count = std::min(head - tail, maxCount);
+        if (count == 0) return 0;
+        const size_t begin = tail & m_mask;
+        const size_t first = std::min(count, capacity() - begin);
+        func(&m_slots[begin], first);
+        if (first < count) func(&m_slots[0], count - first);
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // 生产者线程调用，当前可写入的个数
+    size_t writable() {
+        m_tailCache = m_tail.load(std::memory_order_acquire);
+        return capacity() -
+               (m_head.load(std::memory_order_relaxed) - m_tailCache);
+    }
+
+    // 消费者线程调用，当前可取出的个数
+    size_t readable() const {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_relaxed);
+    }
+
+    // 近似值，仅用于统计显示
+    size_t size() const {
+        return m_head.load(std::memory_order_relaxed) -
+               m_tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t ret = 2;
+        while (ret < n) ret <<= 1;
+        return ret;
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t m_mask;
+    std::vector<T> m_slots;
+
+    // 生产者与消费者各自的字段用填充隔开，避免伪共享；
+    // C++14下堆对象不保证alignas(64)，因此不依赖对齐
+    char m_pad0[kCacheLine];
+    std::atomic<size_t> m_head{0};
+    size_t m_tailCache{0};
+    char m_pad1[kCacheLine];
+    std::atomic<size_t> m_tail{0};
+    char m_pad2[kCacheLine];
+};
+
+};  // namespace MoproboGui
@@ -0,0 +1,111 @@
+/**
+ * @file stream_histogram.h
+ * @brief
+ * 增量维护的直方图：每个新点只给所在的细分桶加一，O(1)；
+ * 显示时把相邻的细分桶合并成所需的柱数，代价只与桶数有关，
+ * 与累计了多少点无关。
+ *
+ * 桶宽固定，数据超出[min, max)时范围向超出的一侧加倍，
+ * 相邻两桶合并为一桶，已有计数不丢失，也不需要原始数据。
+ * 加倍次数以maxGrow为限，个别离群点不会把桶宽放大到失去分辨率，
+ * 加倍到上限也容不下的点不改变范围，只计入下溢或上溢的计数。
+ * 配置了window时另外维护最近window个点的计数：环形数组记录每个点
+ * 所在的桶，新点挤出最旧的点时给对应的桶减一，同样是O(1)。
+ * 非有限值(NaN、Inf)被忽略。仅在一个线程使用。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MoproboGui {
+
+struct StreamHistogramConfig {
+    size_t bins{1024};  // 细分桶数，取偶数
+    double min{0};      // 初始范围[min, max)，超出时自动扩大
+    double max{1};
+    size_t window{0};  // 滑动窗口的点数，0表示不统计
+    size_t maxGrow{20};  // 范围最多加倍的次数
+};
+
+// 合并后用于显示的柱，counts为各柱的点数
+struct HistogramBars {
+    std::vector<double> centers;
+    std::vector<double> counts;
+    double width{0};
+    // 最后一根柱的宽度，覆盖的桶不足一组时小于width
+    double lastWidth{0};
+    uint64_t below{0};  // 小于柱范围的点数，含下溢的点
+    uint64_t above{0};  // 不小于柱范围上限的点数，含上溢的点
+};
+
+class StreamHistogram {
+public:
+    explicit StreamHistogram(
+        const StreamHistogramConfig& config = StreamHistogramConfig());
+    ~StreamHistogram() = default;
+
+    void add(double value);
+    void add(const float* values, size_t n);
+    void add(const double* values, size_t n);
+    // 清空计数，范围恢复为配置的初始范围
+    void clear();
+
+    size_t bins() const { return m_counts.size(); }
+    double min() const { return m_min; }
+    double max() const { return m_min + m_width * m_counts.size(); }
+    double binWidth() const { return m_width; }
+    size_t window() const { return m_ring.size(); }
+
+    // windowed为true时只统计最近window()个点，未配置窗口时与全部相同
+    uint64_t count(bool windowed) const;
+    const std::vector<uint64_t>& counts(bool windowed) const;
+    // 超出加倍上限、未计入桶的点数，已计入count()
+    uint64_t underflow(bool windowed) const;
+    uint64_t overflow(bool windowed) const;
+
+    // 按桶中心估计的均值和标准差，没有数据时返回false
+    bool moments(bool windowed, double* mean, double* stddev) const;
+
+    /**
+     * @brief 把[lo, hi)内的细分桶每若干个合并成一根柱
+     * @param lo,hi lo >= hi时取有数据的桶的范围；按细分桶的边界取整
+     * @param bars 期望的柱数，合并的桶数取整，实际柱数可能略少；
+     *             最后一根柱可能覆盖较少的桶，其中心为这些桶的中点
+     */
+    void merge(bool windowed, double lo, double hi, int bars,
+               HistogramBars* out) const;
+
+private:
+    // 环形数组中表示下溢、上溢的桶号
+    static constexpr uint32_t kUnderflow = UINT32_MAX - 1;
+    static constexpr uint32_t kOverflow = UINT32_MAX;
+
+    size_t bin(double value) const;
+    // 范围向上(up)或向下加倍，相邻两桶合并；已到加倍上限时返回false
+    bool grow(bool up);
+
+    // 配置的初始范围，clear()时恢复
+    double m_initMin;
+    double m_initWidth;
+    double m_min;
+    double m_width;
+    double m_inv;  // 1 / m_width
+    double m_maxWidth;
+    std::vector<uint64_t> m_counts;
+    uint64_t m_total{0};
+    uint64_t m_underflow{0};
+    uint64_t m_overflow{0};
+
+    // 滑动窗口，m_ring[i]为点所在的桶
+    std::vector<uint32_t> m_ring;
+    size_t m_ringPos{0};
+    size_t m_ringSize{0};
+    std::vector<uint64_t> m_windowCounts;
+    uint64_t m_windowUnderflow{0};
+    uint64_t m_windowOverflow{0};
+};
+
+};  // namespace MoproboGui
@@ -1,3 +1,430 @@
 #include "inc/Implot/imgui_histogram.h"
 
-namespace MoproboGui {};  // namespace MoproboGui
\ No newline at end of file
+#include <algorithm>
+#include <cmath>
+
+#include "frame_scheduler.h"
+
+namespace MoproboGui {
+
+namespace {
+
+constexpr int kDemoSamples = 10000;
+
+// 分位数表中的各列
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+const char* const kQuantileNames[] = {"p50", "p90", "p99", "p99.9",
+                                      "p99.99"};
+constexpr int kQuantileCount = sizeof(kQuantiles) / sizeof(kQuantiles[0]);
+
+StreamHistogramConfig demoConfig() {
+    StreamHistogramConfig config;
+    config.min = -3;
+    config.max = 13;
+    return config;
+}
+
+// 与ImPlot::CalculateBins相同的自动分箱规则，span为分箱范围
+int autoBins(ImPlotBin method, uint64_t count, double span, double stddev) {
+    switch (method) {
+        case ImPlotBin_Sqrt:
+            return static_cast<int>(std::ceil(std::sqrt(count)));
+        case ImPlotBin_Sturges:
+            return static_cast<int>(std::ceil(1.0 + std::log2(count)));
+        case ImPlotBin_Rice:
+            return static_cast<int>(std::ceil(2 * std::cbrt(count)));
+        case ImPlotBin_Scott: {
+            const double width = 3.49 * stddev / std::cbrt(count);
+            return width > 0 ? static_cast<int>(std::round(span / width)) : 1;
+        }
+        default:
+            return 1;
+    }
+}
+
+}  // namespace
+
+bool HistogramChannel::addValue(float value) {
+    if (!m_queue.push(value)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    FrameScheduler::getInstance().notify();
+    return true;
+}
+
+size_t HistogramChannel::addValues(const float* values, size_t n) {
+    const size_t ret =
+        m_queue.push(n, [=](float* dst, size_t done, size_t count) {
+            std::copy(values + done, values + done + count, dst);
+        });
+    if (ret < n) m_dropped.fetch_add(n - ret, std::memory_order_relaxed);
+    if (ret > 0) FrameScheduler::getInstance().notify();
+    return ret;
+}
+
+size_t HistogramChannel::drain() {
+    if (m_clearPending.exchange(false, std::memory_order_acquire)) {
+        m_histogram.clear();
+    }
+    return m_queue.drain([this](const float* values, size_t n) {
+        m_histogram.add(values, n);
+    });
+}
+
+size_t HistogramChannel::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+bool HistogramChannel::clear() {
+    m_clearPending.store(true, std::memory_order_release);
+    return true;
+}
+
+bool DistributionChannel::addValue(float value) {
+    if (!m_queue.push(value)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    FrameScheduler::getInstance().notify();
+    return true;
+}
+
+size_t DistributionChannel::addValues(const float* values, size_t n) {
+    const size_t ret =
+        m_queue.push(n, [=](float* dst, size_t done, size_t count) {
+            std::copy(values + done, values + done + count, dst);
+        });
+    if (ret < n) m_dropped.fetch_add(n - ret, std::memory_order_relaxed);
+    if (ret > 0) FrameScheduler::getInstance().notify();
+    return ret;
+}
+
+bool DistributionChannel::merge(const QuantileSketch& sketch) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_pending.merge(sketch)) return false;
+    }
+    m_hasPending.store(true, std::memory_order_release);
+    FrameScheduler::getInstance().notify();
+    return true;
+}
+
+size_t DistributionChannel::drain() {
+    if (m_clearPending.exchange(false, std::memory_order_acquire)) {
+        m_sketch.clear();
+    }
+    if (m_hasPending.exchange(false, std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sketch.merge(m_pending);
+        m_pending.clear();
+    }
+    return m_queue.drain([this](const float* values, size_t n) {
+        m_sketch.add(values, n);
+    });
+}
+
+size_t DistributionChannel::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+bool DistributionChannel::clear() {
+    m_clearPending.store(true, std::memory_order_release);
+    return true;
+}
+
+HistogramFactory::HistogramFactory() : m_demo(demoConfig()) {
+    std::unique_ptr<NormalDistribution<kDemoSamples>> dist(
+        new NormalDistribution<kDemoSamples>(m_demoMu, m_demoSigma));
+    m_demo.add(dist->Data, kDemoSamples);
+}
+
+std::shared_ptr<HistogramChannel> HistogramFactory::createHistogram(
+    const std::string& name, const StreamHistogramConfig& config) {
+    for (const auto& channel : m_channels) {
+        if (channel->name() == name) return channel;
+    }
+    m_channels.push_back(std::make_shared<HistogramChannel>(name, config));
+    return m_channels.back();
+}
+
+std::shared_ptr<DistributionChannel> HistogramFactory::createDistribution(
+    const std::string& name, const QuantileSketchConfig& config) {
+    for (const auto& distribution : m_distributions) {
+        if (distribution->name() == name) return distribution;
+    }
+    m_distributions.push_back(
+        std::make_shared<DistributionChannel>(name, config));
+    return m_distributions.back();
+}
+
+void HistogramFactory::showOptions() {
+    ImGui::SetNextItemWidth(200);
+    if (ImGui::RadioButton("Sqrt", m_bins == ImPlotBin_Sqrt)) {
+        m_bins = ImPlotBin_Sqrt;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Sturges", m_bins == ImPlotBin_Sturges)) {
+        m_bins = ImPlotBin_Sturges;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Rice", m_bins == ImPlotBin_Rice)) {
+        m_bins = ImPlotBin_Rice;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Scott", m_bins == ImPlotBin_Scott)) {
+        m_bins = ImPlotBin_Scott;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("N Bins", m_bins >= 0)) {
+        m_bins = 50;
+    }
+    if (m_bins >= 0) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200);
+        ImGui::SliderInt("##Bins", &m_bins, 1, 100);
+    }
+    ImGui::CheckboxFlags("Horizontal", (unsigned int*)&m_flags,
+                         ImPlotHistogramFlags_Horizontal);
+    ImGui::SameLine();
+    ImGui::CheckboxFlags("Density", (unsigned int*)&m_flags,
+                         ImPlotHistogramFlags_Density);
+    ImGui::SameLine();
+    ImGui::CheckboxFlags("Cumulative", (unsigned int*)&m_flags,
+                         ImPlotHistogramFlags_Cumulative);
+
+    ImGui::Checkbox("Range", &m_range);
+    if (m_range) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(200);
+        ImGui::DragFloat2("##Range", m_rangeLimits, 0.1f, -3, 13);
+        ImGui::SameLine();
+        ImGui::CheckboxFlags("Exclude Outliers", (unsigned int*)&m_flags,
+                             ImPlotHistogramFlags_NoOutliers);
+    }
+    const bool windows =
+        std::any_of(m_channels.begin(), m_channels.end(),
+                    [](const std::shared_ptr<HistogramChannel>& channel) {
+                        return channel->histogram().window() > 0;
+                    });
+    if (windows) {
+        ImGui::SameLine();
+        ImGui::Checkbox("只看滑动窗口", &m_windowed);
+    }
+}
+
+void HistogramFactory::plotHistogram(const char* label,
+                                     const StreamHistogram& hist,
+                                     bool windowed) {
+    const bool cumulative = m_flags & ImPlotHistogramFlags_Cumulative;
+    const bool density = m_flags & ImPlotHistogramFlags_Density;
+    const bool outliers = !(m_flags & ImPlotHistogramFlags_NoOutliers);
+    const uint64_t count = hist.count(windowed);
+    if (count == 0) return;
+
+    const double lo = m_range ? m_rangeLimits[0] : 0;
+    const double hi = m_range ? m_rangeLimits[1] : 0;
+    int bins = m_bins;
+    if (bins < 0) {
+        // 先取分箱范围，自动规则需要它和标准差
+        double mean = 0;
+        double stddev = 0;
+        hist.moments(windowed, &mean, &stddev);
+        hist.merge(windowed, lo, hi, 1, &m_bars);
+        bins = autoBins(bins, count, m_bars.width, stddev);
+    }
+    hist.merge(windowed, lo, hi, std::max(bins, 1), &m_bars);
+    if (m_bars.counts.empty()) return;
+
+    std::vector<double>& counts = m_bars.counts;
+    const uint64_t counted = count - m_bars.below - m_bars.above;
+    if (cumulative) {
+        if (outliers) counts[0] += m_bars.below;
+        for (size_t b = 1; b < counts.size(); ++b) counts[b] += counts[b - 1];
+    }
+    if (density) {
+        const double total = static_cast<double>(outliers ? count : counted);
+        const double scale =
+            cumulative ? 1 / total : 1 / (total * m_bars.width);
+        for (double& c : counts) c *= scale;
+        // 最后一根柱较窄时按实际宽度换算密度
+        if (!cumulative) counts.back() *= m_bars.width / m_bars.lastWidth;
+    }
+    // 最后一根柱按自己的宽度单独画，同名的两次绘制属于同一个图例项
+    const int n = static_cast<int>(counts.size()) - 1;
+    const ImPlotBarsFlags flags = (m_flags & ImPlotHistogramFlags_Horizontal)
+                                      ? ImPlotBarsFlags_Horizontal
+                                      : 0;
+    const auto plot = [&](const double* centers, const double* heights,
+                          int count, double width) {
+        if (flags & ImPlotBarsFlags_Horizontal) {
+            ImPlot::PlotBars(label, heights, centers, count, width, flags);
+        } else {
+            ImPlot::PlotBars(label, centers, heights, count, width, flags);
+        }
+    };
+    if (n > 0) plot(m_bars.centers.data(), counts.data(), n, m_bars.width);
+    plot(&m_bars.centers[n], &counts[n], 1, m_bars.lastWidth);
+}
+
+void HistogramFactory::showDistributions() {
+    if (m_distributions.empty()) return;
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders |
+                                  ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##Quantiles", kQuantileCount + 6, flags)) {
+        ImGui::TableSetupColumn("通道");
+        ImGui::TableSetupColumn("点数");
+        ImGui::TableSetupColumn("丢弃");
+        ImGui::TableSetupColumn("最小");
+        for (const char* name : kQuantileNames) {
+            ImGui::TableSetupColumn(name);
+        }
+        ImGui::TableSetupColumn("最大");
+        ImGui::TableSetupColumn("均值");
+        ImGui::TableHeadersRow();
+        for (const auto& distribution : m_distributions) {
+            const QuantileSketch& sketch = distribution->sketch();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(distribution->name().c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu",
+                        static_cast<unsigned long long>(sketch.count()));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", distribution->dropped());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4g", sketch.min());
+            for (double q : kQuantiles) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.4g", sketch.quantile(q));
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4g", sketch.max());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4g", sketch.mean());
+        }
+        ImGui::EndTable();
+    }
+
+    for (const auto& distribution : m_distributions) {
+        const QuantileSketch& sketch = distribution->sketch();
+        if (sketch.count() == 0) continue;
+        // 只有正值时用对数横轴，各桶在屏幕上等宽，纵轴直接用占比；
+        // 否则用线性横轴，各桶宽度不同，纵轴用概率密度
+        const bool logX = sketch.min() > sketch.config().minValue;
+        const double total = static_cast<double>(sketch.count());
+        m_binEdges.clear();
+        m_binHeights.clear();
+        m_cdf.clear();
+        uint64_t seen = 0;
+        sketch.forEachBin([&](double lower, double upper, uint64_t n) {
+            // 与上一个桶之间有空桶时补一个零高度的台阶
+            if (m_binEdges.empty() || lower > m_binEdges.back()) {
+                m_binEdges.push_back(lower);
+                m_binHeights.push_back(0);
+                m_cdf.push_back(seen / total);
+            }
+            seen += n;
+            const double fraction = n / total;
+            m_binEdges.push_back(upper);
+            m_binHeights.push_back(logX ? fraction
+                                        : fraction / (upper - lower));
+            m_cdf.push_back(seen / total);
+        });
+        const int count = static_cast<int>(m_binEdges.size());
+        double marks[kQuantileCount];
+        for (int i = 0; i < kQuantileCount; ++i) {
+            marks[i] = sketch.quantile(kQuantiles[i]);
+        }
+
+        const std::string& name = distribution->name();
+        const ImPlotAxisFlags axis = ImPlotAxisFlags_AutoFit;
+        const float width = (ImGui::GetContentRegionAvail().x -
+                             ImGui::GetStyle().ItemSpacing.x) /
+                            2;
+        ImGui::PushID(distribution.get());
+        if (ImPlot::BeginPlot((name + " 分布").c_str(), ImVec2(width, 0))) {
+            ImPlot::SetupAxes(NULL, logX ? "占比" : "概率密度", axis, axis);
+            if (logX) ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+            ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
+            ImPlot::PlotStairs(
+                name.c_str(), m_binEdges.data(), m_binHeights.data(), count,
+                ImPlotStairsFlags_PreStep | ImPlotStairsFlags_Shaded);
+            ImPlot::PlotInfLines("分位数", marks, kQuantileCount);
+            ImPlot::EndPlot();
+        }
+        ImGui::SameLine();
+        if (ImPlot::BeginPlot((name + " 累积分布").c_str(),
+                              ImVec2(width, 0))) {
+            ImPlot::SetupAxes(NULL, "累积占比", axis, axis);
+            if (logX) ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+            ImPlot::PlotLine(name.c_str(), m_binEdges.data(), m_cdf.data(),
+                             count);
+            ImPlot::PlotInfLines("分位数", marks, kQuantileCount);
+            ImPlot::EndPlot();
+        }
+        ImGui::PopID();
+    }
+}
+
+void HistogramFactory::showHistogram() {
+    for (const auto& channel : m_channels) channel->drain();
+    for (const auto& distribution : m_distributions) distribution->drain();
+
+    showOptions();
+
+    static double x[100];
+    static double y[100];
+    if (m_flags & ImPlotHistogramFlags_Density) {
+        const double mu = m_demoMu;
+        const double sigma = m_demoSigma;
+        for (int i = 0; i < 100; ++i) {
+            x[i] = -3 + 16 * (double)i / 99.0;
+            y[i] = exp(-(x[i] - mu) * (x[i] - mu) / (2 * sigma * sigma)) /
+                   (sigma * sqrt(2 * 3.141592653589793238));
+        }
+        if (m_flags & ImPlotHistogramFlags_Cumulative) {
+            for (int i = 1; i < 100; ++i) y[i] += y[i - 1];
+            for (int i = 0; i < 100; ++i) y[i] /= y[99];
+        }
+    }
+
+    if (ImPlot::BeginPlot("##Histograms")) {
+        ImPlot::SetupAxes(NULL, NULL, ImPlotAxisFlags_AutoFit,
+                          ImPlotAxisFlags_AutoFit);
+        ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
+        plotHistogram("Empirical", m_demo, false);
+        if ((m_flags & ImPlotHistogramFlags_Density) &&
+            !(m_flags & ImPlotHistogramFlags_NoOutliers)) {
+            if (m_flags & ImPlotHistogramFlags_Horizontal)
+                ImPlot::PlotLine("Theoretical", y, x, 100);
+            else
+                ImPlot::PlotLine("Theoretical", x, y, 100);
+        }
+        ImPlot::EndPlot();
+    }
+
+    for (const auto& channel : m_channels) {
+        const StreamHistogram& hist = channel->histogram();
+        const bool windowed = m_windowed && hist.window() > 0;
+        ImGui::Text("%s: %llu 点，丢弃 %zu", channel->name().c_str(),
+                    static_cast<unsigned long long>(hist.count(windowed)),
+                    channel->dropped());
+        ImGui::SameLine();
+        ImGui::PushID(channel.get());
+        if (ImGui::SmallButton("清空")) channel->clear();
+        ImGui::PopID();
+        if (ImPlot::BeginPlot(channel->name().c_str())) {
+            ImPlot::SetupAxes(NULL, NULL, ImPlotAxisFlags_AutoFit,
+                              ImPlotAxisFlags_AutoFit);
+            ImPlot::SetNextFillStyle(IMPLOT_AUTO_COL, 0.5f);
+            plotHistogram(channel->name().c_str(), hist, windowed);
+            ImPlot::EndPlot();
+        }
+    }
+
+    showDistributions();
+}
+
+};  // namespace MoproboGui
@@ -1,5 +1,12 @@
 #include "Implot/imgui_oscilloscope.h"
 
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "frame_profiler.h"
 #include "iostream"
 
 namespace MoproboGui {
@@ -9,12 +16,68 @@ void OscilloscopeFactory::showMoproboWindow() {
     ImGui::Begin("软件示波器");
     ImGui::Text("该窗口用于显示波形");
 
+    showRecorder();
+    if (ScopeGpuLine::supported()) {
+        bool gpu = ScopeGpuLine::enabled();
+        if (ImGui::Checkbox("GPU绘制曲线", &gpu)) ScopeGpuLine::setEnabled(gpu);
+    }
+
     for (const auto& scope : m_scopes) {
         scope.second->showOscilloscopeWindow();
     }
+    if (m_recorder) m_recorder->poll();
     ImGui::End();
 }
 
+bool OscilloscopeFactory::startRecording(const std::string& path,
+                                         const RecordConfig& config) {
+    stopRecording();
+    m_recorder.reset(new ScopeRecorder(config));
+    if (!m_recorder->start(path)) return false;
+    for (const auto& scope : m_scopes) {
+        scope.second->setRecorder(m_recorder.get());
+    }
+    return true;
+}
+
+void OscilloscopeFactory::stopRecording() {
+    if (!m_recorder) return;
+    for (const auto& scope : m_scopes) {
+        scope.second->setRecorder(nullptr);
+    }
+    m_recorder->stop();
+}
+
+bool OscilloscopeFactory::recording() const {
+    return m_recorder && m_recorder->recording();
+}
+
+void OscilloscopeFactory::showRecorder() {
+    char path[256];
+    snprintf(path, sizeof(path), "%s", m_recordPath.c_str());
+    ImGui::SetNextItemWidth(300);
+    if (ImGui::InputText("录制文件", path, sizeof(path))) m_recordPath = path;
+    ImGui::SameLine();
+    // 写文件出错后写线程只会丢弃数据，停止录制并显示错误
+    if (m_recorder && m_recorder->failed() && recording()) stopRecording();
+    if (!recording()) {
+        if (ImGui::Button("开始录制")) startRecording(m_recordPath);
+        if (m_recorder && !m_recorder->error().empty()) {
+            ImGui::SameLine();
+            ImGui::Text("录制失败: %s", m_recorder->error().c_str());
+        }
+        return;
+    }
+    if (ImGui::Button("停止录制")) {
+        stopRecording();
+        return;
+    }
+    ImGui::SameLine();
+    ImGui::Text("已写入 %.1f MiB  丢弃 %llu 点",
+                m_recorder->bytesWritten() / 1048576.0,
+                static_cast<unsigned long long>(m_recorder->dropped()));
+}
+
 std::shared_ptr<OscilloscopeWindow> OscilloscopeFactory::createScopes(
     const std::string& fold, const std::string& plot, ImPlotAxisFlags flag,
     float history, float max) {
@@ -23,29 +86,629 @@ std::shared_ptr<OscilloscopeWindow> OscilloscopeFactory::createScopes(
     }
     auto ret =
         std::make_shared<OscilloscopeWindow>(fold, plot, flag, history, max);
+    // 录制中新建的窗口同样加入录制
+    if (recording()) ret->setRecorder(m_recorder.get());
     m_scopes.insert({fold, ret});
     return m_scopes[fold];
 }
 
+void OscilloscopeFactory::removeScopes(const std::string& fold) {
+    auto it = m_scopes.find(fold);
+    if (it == m_scopes.end()) return;
+    // 窗口可能仍被其他地方持有，不能再引用录制器；
+    // 曲线释放后地址可能被新的曲线复用，同时在帧耗时分析中注销
+    it->second->detach();
+    m_scopes.erase(it);
+}
+
 void OscilloscopeWindow::showOscilloscopeWindow() {
+    // 折叠时也要取走数据，避免队列积压
+    auto& profiler = FrameProfiler::getInstance();
+    for (const auto& buffer : m_buffers) {
+        profiler.ingest(buffer.second.get(), m_foldName, buffer.first,
+                        buffer.second->drain());
+    }
+    for (const auto& group : m_groups) {
+        profiler.ingest(group.second.get(), m_foldName, group.first,
+                        group.second->drain());
+    }
+    for (const auto& derived : m_derived) {
+        derived->update();
+    }
+    if (m_xy) m_xy->update();
+    updateStats();
+    updateTrigger();
     if (ImGui::CollapsingHeader(m_foldName.c_str())) {
-        static float history = m_history;
-        ImGui::SliderFloat("History", &history, 1, m_maxTime, "%.1f s");
-        if (ImPlot::BeginPlot(m_plotName.c_str(), ImVec2(-1, 150))) {
-            ImPlot::SetupAxes(NULL, NULL, m_flag, m_flag);
-            ImPlot::SetupAxisLimits(ImAxis_X1, 0, history, ImGuiCond_Always);
-            ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
+        ImGui::PushID(this);
+        showPlaybackConfig();
+        if (m_playback) {
+            showPlayback();
+            ImGui::PopID();
+            return;
+        }
+        int64_t latest = 0;
+        const bool hasData = latestTime(&latest);
+        const bool frozen = m_triggerEnabled && m_trigger.showCapture(latest);
+        if (frozen) {
+            m_origin = m_trigger.captureTime();
+        } else if (m_follow && hasData) {
+            m_origin = latest;
+        }
+        ImGui::Checkbox("跟随", &m_follow);
+        ImGui::SameLine();
+        ImGui::SliderFloat("History", &m_history, 1, m_maxTime, "%.1f s");
+        showTriggerConfig();
+        showSpectrumConfig();
+        showDerivedConfig();
+        showXYConfig();
+        showStats();
+        if (m_spectrum) {
+            size_t channel = 0;
+            const ScopeStore* store = findSource(m_spectrumSource, &channel);
+            if (store != nullptr) m_spectrum->submit(*store, channel);
+        }
+        const int columns = 1 + (m_spectrum ? 1 : 0) + (m_xy ? 1 : 0);
+        if (columns > 1 && ImGui::BeginTable("##layout", columns,
+                                             ImGuiTableFlags_Resizable)) {
+            ImGui::TableNextColumn();
+            showPlot(frozen);
+            if (m_spectrum) {
+                ImGui::TableNextColumn();
+                m_spectrum->show("频谱");
+            }
+            if (m_xy) {
+                ImGui::TableNextColumn();
+                showXY();
+            }
+            ImGui::EndTable();
+        } else {
+            showPlot(frozen);
+        }
+        ImGui::PopID();
+    }
+}
+
+void OscilloscopeWindow::showPlot(bool frozen) {
+    if (ImPlot::BeginPlot(m_plotName.c_str(), ImVec2(-1, 150))) {
+        const auto& cfg = m_trigger.config();
+        ImPlot::SetupAxes(NULL, NULL, m_flag, m_flag);
+        if (frozen) {
+            // 冻结在触发时刻，X轴零点即触发点
+            ImPlot::SetupAxisLimits(ImAxis_X1, -cfg.preTrigger,
+                                    cfg.postTrigger, ImGuiCond_Always);
+        } else {
+            ImPlot::SetupAxisLimits(ImAxis_X1, -m_history, 0,
+                                    m_follow ? ImGuiCond_Always
+                                             : ImGuiCond_Once);
+        }
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
+        const ImPlotRect limits = ImPlot::GetPlotLimits();
+        const int pixels = static_cast<int>(ImPlot::GetPlotSize().x);
+        m_viewMin = limits.X.Min;
+        m_viewMax = limits.X.Max;
+        if (frozen) {
+            if (m_persistence) {
+                // 先画余辉，触发画面叠在上面
+                m_frozenYMin = limits.Y.Min;
+                m_frozenYMax = limits.Y.Max;
+                m_persistence->plot("##persistence");
+            }
+            // 触发画面取自采满时拷贝的数据，历史数据被淘汰后仍可显示
+            m_trigger.plotCapture(limits.X.Min, limits.X.Max, pixels);
+        } else {
             for (const auto& buffer : m_buffers) {
-                const auto& id = buffer.first;
-                const auto& plot = buffer.second;
-                plot->reSpan(history);
-                ImPlot::PlotLine(
-                    plot->id().c_str(), &plot->getBuffer().Data[0].x,
-                    &plot->getBuffer().Data[0].y, plot->getBuffer().Data.size(),
-                    0, 0, 2 * sizeof(float));
+                buffer.second->plotLine(buffer.first.c_str(), m_origin,
+                                        limits.X.Min, limits.X.Max, pixels);
+            }
+            for (const auto& group : m_groups) {
+                group.second->plotLines(m_origin, limits.X.Min, limits.X.Max,
+                                        pixels);
+            }
+            for (const auto& derived : m_derived) {
+                derived->plotLine(m_origin, limits.X.Min, limits.X.Max,
+                                  pixels);
+            }
+        }
+        if (m_triggerEnabled) {
+            const ImVec4 color(1, 0.5f, 0, 1);
+            double level = cfg.level;
+            if (ImPlot::DragLineY(0, &level, color)) {
+                m_trigger.config().level = static_cast<float>(level);
+                m_trigger.arm();
+            }
+            if (frozen) ImPlot::TagX(0, color, "T");
+        }
+        ImPlot::EndPlot();
+    }
+}
+
+void OscilloscopeWindow::setTriggerSource(const std::string& plot) {
+    m_triggerSource = plot;
+    m_triggerEnd = UINT64_MAX;
+    m_trigger.reset();
+    m_trigger.arm();
+}
+
+bool OscilloscopeWindow::latestTime(int64_t* latest) const {
+    bool found = false;
+    auto check = [&](const ScopeStore& store) {
+        if (store.empty()) return;
+        const int64_t last = store.time(store.end() - 1);
+        if (!found || last > *latest) *latest = last;
+        found = true;
+    };
+    for (const auto& buffer : m_buffers) {
+        check(buffer.second->getBuffer());
+    }
+    for (const auto& group : m_groups) {
+        check(group.second->getBuffer());
+    }
+    return found;
+}
+
+const ScopeStore* OscilloscopeWindow::findSource(const std::string& plot,
+                                                 size_t* channel) const {
+    auto buffer = m_buffers.find(plot);
+    if (buffer != m_buffers.end()) {
+        *channel = 0;
+        return &buffer->second->getBuffer();
+    }
+    for (const auto& group : m_groups) {
+        for (size_t c = 0; c < group.second->channels(); ++c) {
+            if (group.second->channelName(c) == plot) {
+                *channel = c;
+                return &group.second->getBuffer();
+            }
+        }
+    }
+    for (const auto& derived : m_derived) {
+        if (derived->name() == plot) {
+            *channel = 0;
+            return &derived->getBuffer();
+        }
+    }
+    return nullptr;
+}
+
+void OscilloscopeWindow::updateTrigger() {
+    if (!m_triggerEnabled) return;
+    size_t channel = 0;
+    const ScopeStore* store = findSource(m_triggerSource, &channel);
+    if (store == nullptr) return;
+    if (m_triggerEnd > store->end()) {
+        // 信号源被清空时丢弃旧的触发画面
+        if (m_triggerEnd != UINT64_MAX) m_trigger.reset();
+        m_triggerEnd = store->end();
+    }
+    const bool captured =
+        m_trigger.process(*store, channel, m_triggerEnd, store->end(),
+                          m_persistence ? &m_captures : nullptr);
+    m_triggerEnd = store->end();
+    if (captured) captureTraces();
+    if (!m_persistence) return;
+    // 每帧衰减一次，代价只与网格大小有关
+    if (m_persistenceTime > 0) {
+        const float dt = ImGui::GetIO().DeltaTime;
+        m_persistence->decay(std::exp(-dt / m_persistenceTime));
+    }
+    const auto& cfg = m_trigger.config();
+    m_persistence->setRange(-cfg.preTrigger, cfg.postTrigger, m_frozenYMin,
+                            m_frozenYMax);
+    for (int64_t t : m_captures) {
+        m_persistence->addSweep(*store, channel, t);
+    }
+    m_captures.clear();
+}
+
+void OscilloscopeWindow::captureTraces() {
+    m_trigger.beginCapture();
+    for (const auto& buffer : m_buffers) {
+        m_trigger.capture(buffer.first, buffer.second->getBuffer(), 0);
+    }
+    for (const auto& group : m_groups) {
+        for (size_t c = 0; c < group.second->channels(); ++c) {
+            m_trigger.capture(group.second->channelName(c),
+                              group.second->getBuffer(), c);
+        }
+    }
+    for (const auto& derived : m_derived) {
+        m_trigger.capture(derived->name(), derived->getBuffer(), 0);
+    }
+}
+
+bool OscilloscopeWindow::sourceCombo(const char* label, std::string* plot) {
+    bool changed = false;
+    ImGui::SetNextItemWidth(200);
+    if (ImGui::BeginCombo(label, plot->c_str())) {
+        auto item = [&](const std::string& name) {
+            if (ImGui::Selectable(name.c_str(), name == *plot)) {
+                changed = name != *plot;
+                *plot = name;
+            }
+        };
+        for (const auto& buffer : m_buffers) {
+            item(buffer.first);
+        }
+        for (const auto& group : m_groups) {
+            for (size_t c = 0; c < group.second->channels(); ++c) {
+                item(group.second->channelName(c));
+            }
+        }
+        for (const auto& derived : m_derived) {
+            item(derived->name());
+        }
+        ImGui::EndCombo();
+    }
+    return changed;
+}
+
+void OscilloscopeWindow::showTriggerConfig() {
+    if (!ImGui::TreeNode("触发")) return;
+    auto& cfg = m_trigger.config();
+    bool changed = false;
+    if (ImGui::Checkbox("启用", &m_triggerEnabled)) changed = true;
+    ImGui::SameLine();
+    std::string source = m_triggerSource;
+    if (sourceCombo("信号源", &source)) setTriggerSource(source);
+
+    static const char* kTypes[] = {"边沿", "电平", "脉宽", "窗口"};
+    static const char* kSlopes[] = {"上升", "下降", "双向"};
+    int type = static_cast<int>(cfg.type);
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("类型", &type, kTypes, IM_ARRAYSIZE(kTypes))) {
+        cfg.type = static_cast<TriggerType>(type);
+        changed = true;
+    }
+    ImGui::SameLine();
+    int slope = static_cast<int>(cfg.slope);
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("方向", &slope, kSlopes, IM_ARRAYSIZE(kSlopes))) {
+        cfg.slope = static_cast<TriggerSlope>(slope);
+        changed = true;
+    }
+    ImGui::SameLine();
+    int mode = static_cast<int>(cfg.mode);
+    changed |= ImGui::RadioButton("Auto", &mode, 0);
+    ImGui::SameLine();
+    changed |= ImGui::RadioButton("Normal", &mode, 1);
+    ImGui::SameLine();
+    changed |= ImGui::RadioButton("Single", &mode, 2);
+    cfg.mode = static_cast<TriggerMode>(mode);
+
+    ImGui::SetNextItemWidth(100);
+    changed |= ImGui::DragFloat("电平", &cfg.level, 0.01f);
+    if (cfg.type == TriggerType::Window) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        changed |= ImGui::DragFloat("上限", &cfg.level2, 0.01f);
+    } else {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        changed |= ImGui::DragFloat("回差", &cfg.hysteresis, 0.001f, 0,
+                                    FLT_MAX, "%.3f");
+    }
+    if (cfg.type == TriggerType::PulseWidth) {
+        float width[2] = {static_cast<float>(cfg.minWidth * 1e3),
+                          static_cast<float>(cfg.maxWidth * 1e3)};
+        ImGui::SetNextItemWidth(200);
+        if (ImGui::DragFloat2("脉宽(ms)", width, 0.01f, 0, FLT_MAX, "%.3f")) {
+            cfg.minWidth = width[0] * 1e-3;
+            cfg.maxWidth = std::max(width[0], width[1]) * 1e-3;
+            changed = true;
+        }
+    }
+    const double zero = 0;
+    ImGui::SetNextItemWidth(100);
+    changed |= ImGui::DragScalar("预触发(s)", ImGuiDataType_Double,
+                                 &cfg.preTrigger, 0.01f, &zero, nullptr,
+                                 "%.3f");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    changed |= ImGui::DragScalar("后触发(s)", ImGuiDataType_Double,
+                                 &cfg.postTrigger, 0.01f, &zero, nullptr,
+                                 "%.3f");
+
+    bool persistence = m_persistence != nullptr;
+    if (ImGui::Checkbox("余辉", &persistence)) {
+        m_persistence.reset(persistence ? new ScopePersistence() : nullptr);
+        m_captures.clear();
+    }
+    if (m_persistence) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        ImGui::DragFloat("余辉时间(s)", &m_persistenceTime, 0.05f, 0, 60,
+                         m_persistenceTime > 0 ? "%.2f" : "无限");
+        ImGui::SameLine();
+        if (ImGui::Button("清除余辉")) m_persistence->clear();
+    }
+
+    if (changed) {
+        m_trigger.arm();
+        if (m_persistence) m_persistence->clear();
+    }
+    if (ImGui::Button("Arm")) m_trigger.arm();
+    ImGui::SameLine();
+    static const char* kStates[] = {"已停止", "等待触发", "已触发"};
+    ImGui::Text("%s  触发次数: %llu",
+                kStates[static_cast<int>(m_trigger.state())],
+                static_cast<unsigned long long>(m_trigger.triggerCount()));
+    ImGui::TreePop();
+}
+
+void OscilloscopeWindow::showSpectrumConfig() {
+    if (!ImGui::TreeNode("频谱")) return;
+    bool enabled = m_spectrum != nullptr;
+    if (ImGui::Checkbox("启用", &enabled)) {
+        // 关闭时释放工作线程和缓冲
+        m_spectrum.reset(enabled ? new ScopeSpectrum() : nullptr);
+    }
+    ImGui::SameLine();
+    if (sourceCombo("信号源", &m_spectrumSource) && m_spectrum) {
+        m_spectrum->reset();
+    }
+    if (!m_spectrum) {
+        ImGui::TreePop();
+        return;
+    }
+    auto& cfg = m_spectrum->config();
+    static const char* kSizes[] = {"256",  "512",   "1024",  "2048", "4096",
+                                   "8192", "16384", "32768", "65536"};
+    int size = 0;
+    while ((size_t(256) << size) < cfg.size && size < 8) ++size;
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("点数", &size, kSizes, IM_ARRAYSIZE(kSizes))) {
+        cfg.size = size_t(256) << size;
+    }
+    ImGui::SameLine();
+    static const char* kWindows[] = {"矩形", "Hann", "Blackman"};
+    int window = static_cast<int>(cfg.window);
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::Combo("窗函数", &window, kWindows, IM_ARRAYSIZE(kWindows))) {
+        cfg.window = static_cast<SpectrumWindow>(window);
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderFloat("重叠", &cfg.overlap, 0, 0.95f, "%.2f");
+
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::SliderInt("平均", &cfg.averages, 1, 64)) m_spectrum->reset();
+    ImGui::SameLine();
+    ImGui::Checkbox("峰值保持", &cfg.peakHold);
+    ImGui::SameLine();
+    if (ImGui::Button("清除")) m_spectrum->reset();
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100);
+    ImGui::SliderInt("瀑布行数", &cfg.waterfallRows, 16, 256);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(200);
+    ImGui::DragFloatRange2("dB", &cfg.minDb, &cfg.maxDb, 1, -200, 100);
+    ImGui::TreePop();
+}
+
+void OscilloscopeWindow::showDerivedConfig() {
+    if (!ImGui::TreeNode("运算通道")) return;
+    std::string remove;
+    for (const auto& derived : m_derived) {
+        ImGui::PushID(derived.get());
+        if (ImGui::SmallButton("删除")) remove = derived->name();
+        ImGui::SameLine();
+        ImGui::Text("%s = %s", derived->name().c_str(),
+                    derived->expression().c_str());
+        ImGui::PopID();
+    }
+    if (!remove.empty()) removeDerived(remove);
+
+    char name[64];
+    char expr[256];
+    snprintf(name, sizeof(name), "%s", m_derivedName.c_str());
+    snprintf(expr, sizeof(expr), "%s", m_derivedExpr.c_str());
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::InputText("名称", name, sizeof(name))) m_derivedName = name;
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(300);
+    if (ImGui::InputText("表达式", expr, sizeof(expr))) m_derivedExpr = expr;
+    ImGui::SameLine();
+    if (ImGui::Button("添加") &&
+        createDerived(m_derivedName, m_derivedExpr, &m_derivedError)) {
+        m_derivedError.clear();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip(
+            "+ - * / abs sqrt min max\n"
+            "avg(x, n) diff(x) integ(x) lpf(x, fc)");
+    }
+    if (!m_derivedError.empty()) ImGui::Text("%s", m_derivedError.c_str());
+    ImGui::TreePop();
+}
+
+void OscilloscopeWindow::showXYConfig() {
+    if (!ImGui::TreeNode("XY")) return;
+    bool enabled = m_xy != nullptr;
+    bool changed = ImGui::Checkbox("启用", &enabled);
+    ImGui::SameLine();
+    changed |= sourceCombo("X", &m_xyX);
+    ImGui::SameLine();
+    changed |= sourceCombo("Y", &m_xyY);
+    if (changed) {
+        if (enabled) {
+            setXY(m_xyX, m_xyY);
+        } else {
+            closeXY();
+        }
+    }
+    ImGui::TreePop();
+}
+
+void OscilloscopeWindow::showXY() {
+    if (ImPlot::BeginPlot("XY", ImVec2(-1, 150))) {
+        ImPlot::SetupAxes(m_xyX.c_str(), m_xyY.c_str(),
+                          ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+        // 与时域图显示同一时间段，点数按绘图区大小限制
+        const ImVec2 size = ImPlot::GetPlotSize();
+        const size_t points = static_cast<size_t>(
+            std::max(size.x + size.y, 64.f) * 4);
+        m_xy->plotLine("##xy", m_origin, m_viewMin, m_viewMax, points);
+        ImPlot::EndPlot();
+    }
+}
+
+void OscilloscopeWindow::updateStats() {
+    if (!m_statsEnabled) return;
+    size_t count = m_buffers.size() + m_derived.size();
+    for (const auto& group : m_groups) {
+        count += group.second->channels();
+    }
+    if (m_stats.size() != count) {
+        // 新建时先处理一遍已有的数据，之后每帧只处理新增的点
+        m_stats.clear();
+        auto add = [this](const std::string& name, const ScopeStore& store,
+                          const ScopeLod& lod, size_t channel) {
+            m_stats.emplace_back(
+                name, std::unique_ptr<ScopeStats>(
+                          new ScopeStats(&store, &lod, channel)));
+        };
+        for (const auto& buffer : m_buffers) {
+            add(buffer.first, buffer.second->getBuffer(),
+                buffer.second->getLod(), 0);
+        }
+        for (const auto& group : m_groups) {
+            for (size_t c = 0; c < group.second->channels(); ++c) {
+                add(group.second->channelName(c), group.second->getBuffer(),
+                    group.second->getLod(c), c);
+            }
+        }
+        for (const auto& derived : m_derived) {
+            add(derived->name(), derived->getBuffer(), derived->getLod(), 0);
+        }
+    }
+    for (const auto& stats : m_stats) {
+        stats.second->update();
+    }
+}
+
+void OscilloscopeWindow::showStats() {
+    if (!ImGui::TreeNode("统计")) return;
+    if (ImGui::Checkbox("启用", &m_statsEnabled) && !m_statsEnabled) {
+        m_stats.clear();
+    }
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders |
+                                  ImGuiTableFlags_RowBg |
+                                  ImGuiTableFlags_SizingFixedFit;
+    if (m_statsEnabled && ImGui::BeginTable("##stats", 9, flags)) {
+        static const char* kHeaders[] = {"通道", "范围",   "最小",
+                                         "最大", "均值",   "RMS",
+                                         "标准差", "峰峰值", "频率(Hz)"};
+        for (const char* header : kHeaders) {
+            ImGui::TableSetupColumn(header);
+        }
+        ImGui::TableHeadersRow();
+        // 可见范围与上一帧时域图的X轴一致
+        const int64_t t0 = m_origin + static_cast<int64_t>(m_viewMin * 1e9);
+        const int64_t t1 = m_origin + static_cast<int64_t>(m_viewMax * 1e9);
+        auto row = [](const char* name, const char* range,
+                      const StatsResult& r) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(range);
+            if (r.count == 0) return;
+            const double values[] = {r.min, r.max,    r.mean,        r.rms,
+                                     r.stddev, r.max - r.min, r.frequency};
+            for (double value : values) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.4g", value);
+            }
+        };
+        for (const auto& stats : m_stats) {
+            row(stats.first.c_str(), "可见", stats.second->window(t0, t1));
+            row("", "会话", stats.second->session());
+        }
+        ImGui::EndTable();
+    }
+    ImGui::TreePop();
+}
+
+bool OscilloscopeWindow::openPlayback(const std::string& path) {
+    std::unique_ptr<ScopePlayback> playback(new ScopePlayback());
+    if (!playback->open(path)) {
+        m_playbackError = playback->error();
+        return false;
+    }
+    m_playbackError.clear();
+    m_playbackPath = path;
+    m_playbackPos = 0;
+    m_playback = std::move(playback);
+    return true;
+}
+
+void OscilloscopeWindow::closePlayback() { m_playback.reset(); }
+
+void OscilloscopeWindow::showPlaybackConfig() {
+    if (!ImGui::TreeNode("回放")) return;
+    char path[256];
+    snprintf(path, sizeof(path), "%s", m_playbackPath.c_str());
+    ImGui::SetNextItemWidth(300);
+    if (ImGui::InputText("文件", path, sizeof(path))) m_playbackPath = path;
+    ImGui::SameLine();
+    if (ImGui::Button("打开")) openPlayback(m_playbackPath);
+    if (m_playback) {
+        ImGui::SameLine();
+        if (ImGui::Button("返回实时")) closePlayback();
+    }
+    if (!m_playbackError.empty()) {
+        ImGui::SameLine();
+        ImGui::Text("打开失败: %s", m_playbackError.c_str());
+    }
+    ImGui::TreePop();
+}
+
+void OscilloscopeWindow::showPlayback() {
+    const double duration = m_playback->duration();
+    const time_t start =
+        static_cast<time_t>(m_playback->startRealTime() / 1000000000);
+    struct tm tm;
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S",
+             localtime_r(&start, &tm));
+    ImGui::Text("回放 %s  开始于 %s  时长 %.1f s",
+                m_playback->path().c_str(), date, duration);
+
+    const double zero = 0;
+    const double maxPos = std::max(duration - m_history, 0.0);
+    ImGui::SetNextItemWidth(300);
+    const bool seek = ImGui::SliderScalar("位置", ImGuiDataType_Double,
+                                          &m_playbackPos, &zero, &maxPos,
+                                          "%.3f s");
+    ImGui::SameLine();
+    ImGui::SliderFloat("History", &m_history, 1, m_maxTime, "%.1f s");
+
+    const auto& streams = m_playback->streams();
+    bool own = false;
+    for (const auto& stream : streams) {
+        own |= stream.window == m_foldName;
+    }
+    if (ImPlot::BeginPlot(m_plotName.c_str(), ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("s", NULL, m_flag, m_flag);
+        ImPlot::SetupAxisLimits(ImAxis_X1, m_playbackPos,
+                                m_playbackPos + m_history,
+                                seek ? ImGuiCond_Always : ImGuiCond_Once);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, 1);
+        const ImPlotRect limits = ImPlot::GetPlotLimits();
+        const int pixels = static_cast<int>(ImPlot::GetPlotSize().x);
+        for (size_t s = 0; s < streams.size(); ++s) {
+            if (own && streams[s].window != m_foldName) continue;
+            for (size_t c = 0; c < streams[s].channels.size(); ++c) {
+                // 不同窗口可能有同名曲线，用编号区分
+                const std::string label =
+                    streams[s].channels[c] + "##" + std::to_string(s);
+                m_playback->plotLine(label.c_str(), s, c, limits.X.Min,
+                                     limits.X.Max, pixels);
             }
-            ImPlot::EndPlot();
         }
+        // 拖动或缩放后同步位置滑条
+        m_playbackPos = limits.X.Min;
+        ImPlot::EndPlot();
     }
 }
 
@@ -61,33 +724,389 @@ void OscilloscopeWindow::setScopeConfig(const std::string& fold,
 }
 
 std::shared_ptr<OscilloscopeBuffer> OscilloscopeWindow::createPlot(
-    const std::string& plot) {
+    const std::string& plot, const ScopeCapacity& capacity) {
     if (m_buffers.find(plot) != m_buffers.end()) {
         return m_buffers[plot];
     }
-    auto ret = std::make_shared<OscilloscopeBuffer>(plot);
+    auto ret = std::make_shared<OscilloscopeBuffer>(plot, capacity);
     m_buffers.insert(std::make_pair(plot, ret));
+    if (m_recorder) {
+        ret->setRecorder(m_recorder,
+                         m_recorder->addStream(m_foldName, plot, {plot}));
+    }
     return ret;
 }
 
+std::shared_ptr<OscilloscopeGroup> OscilloscopeWindow::createGroup(
+    const std::string& group, const std::vector<std::string>& channels,
+    const ScopeCapacity& capacity) {
+    if (m_groups.find(group) != m_groups.end()) {
+        return m_groups[group];
+    }
+    auto ret = std::make_shared<OscilloscopeGroup>(channels, capacity);
+    m_groups.insert(std::make_pair(group, ret));
+    if (m_recorder) {
+        ret->setRecorder(m_recorder,
+                         m_recorder->addStream(m_foldName, group, channels));
+    }
+    return ret;
+}
+
+std::shared_ptr<OscilloscopeDerived> OscilloscopeWindow::createDerived(
+    const std::string& name, const std::string& expression,
+    std::string* error, const ScopeCapacity& capacity) {
+    auto fail = [&](const std::string& message) {
+        if (error) *error = message;
+        return nullptr;
+    };
+    size_t channel = 0;
+    if (name.empty()) return fail("名称不能为空");
+    if (findSource(name, &channel) != nullptr) return fail("名称已存在");
+    ScopeExpr expr;
+    if (!expr.compile(expression)) return fail(expr.error());
+    if (expr.variables().empty()) return fail("表达式没有使用任何通道");
+
+    const ScopeStore* source = nullptr;
+    std::vector<size_t> channels;
+    for (const auto& variable : expr.variables()) {
+        const ScopeStore* store = findSource(variable, &channel);
+        if (store == nullptr) return fail("没有通道 " + variable);
+        if (source != nullptr && store != source) {
+            return fail(variable + " 与其他输入不共用时间轴");
+        }
+        source = store;
+        channels.push_back(channel);
+    }
+    auto ret = std::make_shared<OscilloscopeDerived>(name, expr, source,
+                                                     channels, capacity);
+    m_derived.push_back(ret);
+    return ret;
+}
+
+void OscilloscopeWindow::removeDerived(const std::string& name) {
+    // 依赖只会指向先创建的通道，一次顺序扫描即可找出所有受影响的通道
+    std::vector<const ScopeStore*> removed;
+    auto it = m_derived.begin();
+    while (it != m_derived.end()) {
+        const auto& derived = *it;
+        if (derived->name() == name ||
+            std::find(removed.begin(), removed.end(), derived->source()) !=
+                removed.end()) {
+            removed.push_back(&derived->getBuffer());
+            it = m_derived.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // 统计可能引用了被删除的通道，下一帧重建
+    m_stats.clear();
+    if (m_xy && (std::find(removed.begin(), removed.end(),
+                           m_xy->xSource()) != removed.end() ||
+                 std::find(removed.begin(), removed.end(),
+                           m_xy->ySource()) != removed.end())) {
+        closeXY();
+    }
+}
+
+bool OscilloscopeWindow::setXY(const std::string& x, const std::string& y) {
+    m_xyX = x;
+    m_xyY = y;
+    size_t xChannel = 0;
+    size_t yChannel = 0;
+    const ScopeStore* xStore = findSource(x, &xChannel);
+    const ScopeStore* yStore = findSource(y, &yChannel);
+    if (xStore == nullptr || yStore == nullptr) {
+        m_xy.reset();
+        return false;
+    }
+    m_xy.reset(new ScopeXY(xStore, xChannel, yStore, yChannel));
+    return true;
+}
+
+void OscilloscopeWindow::closeXY() { m_xy.reset(); }
+
+void OscilloscopeWindow::setRecorder(ScopeRecorder* recorder) {
+    m_recorder = recorder;
+    for (const auto& buffer : m_buffers) {
+        const uint32_t stream =
+            recorder ? recorder->addStream(m_foldName, buffer.first,
+                                           {buffer.first})
+                     : 0;
+        buffer.second->setRecorder(recorder, stream);
+    }
+    for (const auto& group : m_groups) {
+        const uint32_t stream =
+            recorder ? recorder->addStream(m_foldName, group.first,
+                                           group.second->channelNames())
+                     : 0;
+        group.second->setRecorder(recorder, stream);
+    }
+}
+
+void OscilloscopeWindow::detach() {
+    setRecorder(nullptr);
+    auto& profiler = FrameProfiler::getInstance();
+    for (const auto& buffer : m_buffers) {
+        profiler.removeSource(buffer.second.get());
+    }
+    for (const auto& group : m_groups) {
+        profiler.removeSource(group.second.get());
+    }
+}
+
 std::string OscilloscopeBuffer::id() const { return m_plotId; }
 
-RollingBuffer OscilloscopeBuffer::getBuffer() const { return m_buffer; }
+const ScopeStore& OscilloscopeBuffer::getBuffer() const { return m_buffer; }
+
+const ScopeLod& OscilloscopeBuffer::getLod() const { return m_lod; }
 
 bool OscilloscopeBuffer::addPoint(float number, float time) {
-    m_time += time;
-    m_buffer.AddPoint(m_time, number);
-    return true;
+    m_time += static_cast<int64_t>(std::llround(time * 1e9));
+    return addPointAt(number, m_time);
 }
 
-bool OscilloscopeBuffer::reSpan(float span) {
-    m_buffer.Span = span;
+bool OscilloscopeBuffer::addPointAt(float number, int64_t monoNs) {
+    if (!m_queue.push(ScopeSample{monoNs, number})) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    FrameScheduler::getInstance().notify();
     return true;
 }
 
+bool OscilloscopeBuffer::addPointAt(float number, const zemb::Time& mono) {
+    return addPointAt(number, mono.secPart() * 1000000000LL +
+                                  mono.usPart() * 1000LL);
+}
+
+size_t OscilloscopeBuffer::addPoints(const float* values,
+                                     const int64_t* monoNs, size_t n) {
+    return addPoints(values, 1, monoNs, n);
+}
+
+size_t OscilloscopeBuffer::addPoints(const float* values, size_t stride,
+                                     const int64_t* monoNs, size_t n) {
+    const size_t ret = m_queue.push(
+        n, [=](ScopeSample* dst, size_t done, size_t count) {
+            const float* src = values + done * stride;
+            for (size_t i = 0; i < count; ++i) {
+                dst[i].time = monoNs[done + i];
+                dst[i].value = src[i * stride];
+            }
+        });
+    if (ret < n) m_dropped.fetch_add(n - ret, std::memory_order_relaxed);
+    if (ret > 0) FrameScheduler::getInstance().notify();
+    return ret;
+}
+
+size_t OscilloscopeBuffer::drain() {
+    if (m_clearPending.exchange(false, std::memory_order_acquire)) {
+        m_buffer.clear();
+    }
+    const uint64_t end = m_buffer.end();
+    const size_t ret =
+        m_queue.drain([this](const ScopeSample* samples, size_t n) {
+            const uint64_t seq = m_buffer.end();
+            m_buffer.append(samples, n);
+            for (size_t i = 0; i < n; ++i) {
+                m_lod.append(seq + i, samples[i].value);
+            }
+        });
+    if (m_recorder && ret > 0) m_recorder->capture(m_stream, m_buffer, end);
+    return ret;
+}
+
+void OscilloscopeBuffer::setRecorder(ScopeRecorder* recorder,
+                                     uint32_t stream) {
+    if (m_recorder) m_recorder->removeStream(m_stream);
+    m_recorder = recorder;
+    m_stream = stream;
+}
+
+void OscilloscopeBuffer::plotLine(const char* label, int64_t origin,
+                                  double xmin, double xmax, int pixels) const {
+    m_lod.plotLine(label, m_buffer, 0, origin, xmin, xmax, pixels);
+}
+
+size_t OscilloscopeBuffer::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
 bool OscilloscopeBuffer::clear() {
-    m_buffer.Data.clear();
+    m_clearPending.store(true, std::memory_order_release);
     return true;
 }
 
+OscilloscopeGroup::OscilloscopeGroup(const std::vector<std::string>& channels,
+                                     const ScopeCapacity& capacity,
+                                     size_t queueSize)
+    : m_names(channels),
+      m_times(queueSize),
+      m_buffer(capacity, channels.size()) {
+    m_values.reserve(channels.size());
+    m_lods.reserve(channels.size());
+    for (size_t i = 0; i < channels.size(); ++i) {
+        m_values.emplace_back(new SpscRing<float>(queueSize));
+        m_lods.emplace_back(m_buffer.capacity());
+    }
+}
+
+size_t OscilloscopeGroup::channels() const { return m_names.size(); }
+
+const std::string& OscilloscopeGroup::channelName(size_t channel) const {
+    return m_names[channel];
+}
+
+const std::vector<std::string>& OscilloscopeGroup::channelNames() const {
+    return m_names;
+}
+
+bool OscilloscopeGroup::addFrame(int64_t monoNs, const float* values) {
+    return addFrames(&monoNs, values, 1) == 1;
+}
+
+size_t OscilloscopeGroup::addFrames(const int64_t* monoNs, const float* frames,
+                                    size_t n) {
+    const size_t stride = m_names.size();
+    size_t count = std::min(n, m_times.writable());
+    for (const auto& ring : m_values) {
+        count = std::min(count, ring->writable());
+    }
+    // 先写各通道数值，最后发布时间戳，GUI线程以时间戳个数为准取数据
+    for (size_t c = 0; c < stride; ++c) {
+        m_values[c]->push(count, [=](float* dst, size_t done, size_t k) {
+            const float* src = frames + done * stride + c;
+            for (size_t i = 0; i < k; ++i) dst[i] = src[i * stride];
+        });
+    }
+    m_times.push(count, [=](int64_t* dst, size_t done, size_t k) {
+        memcpy(dst, monoNs + done, k * sizeof(int64_t));
+    });
+    if (count < n) m_dropped.fetch_add(n - count, std::memory_order_relaxed);
+    if (count > 0) FrameScheduler::getInstance().notify();
+    return count;
+}
+
+size_t OscilloscopeGroup::drain() {
+    if (m_clearPending.exchange(false, std::memory_order_acquire)) {
+        m_buffer.clear();
+    }
+    size_t total = 0;
+    for (;;) {
+        // 每次最多取一块，保证新写入的行在填写数值前不会被淘汰
+        const size_t count =
+            std::min(m_times.readable(), ScopeStore::kChunkSamples);
+        if (count == 0) break;
+        uint64_t seq = m_buffer.end();
+        m_times.drain(
+            [this](const int64_t* times, size_t n) {
+                m_buffer.appendTimes(times, n);
+            },
+            count);
+        for (size_t c = 0; c < m_values.size(); ++c) {
+            uint64_t next = seq;
+            m_values[c]->drain(
+                [&](const float* values, size_t n) {
+                    m_buffer.writeValues(c, next, values, n);
+                    for (size_t i = 0; i < n; ++i) {
+                        m_lods[c].append(next + i, values[i]);
+                    }
+                    next += n;
+                },
+                count);
+        }
+        if (m_recorder) m_recorder->capture(m_stream, m_buffer, seq);
+        total += count;
+    }
+    return total;
+}
+
+void OscilloscopeGroup::setRecorder(ScopeRecorder* recorder, uint32_t stream) {
+    if (m_recorder) m_recorder->removeStream(m_stream);
+    m_recorder = recorder;
+    m_stream = stream;
+}
+
+size_t OscilloscopeGroup::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+bool OscilloscopeGroup::clear() {
+    m_clearPending.store(true, std::memory_order_release);
+    return true;
+}
+
+const ScopeStore& OscilloscopeGroup::getBuffer() const { return m_buffer; }
+
+const ScopeLod& OscilloscopeGroup::getLod(size_t channel) const {
+    return m_lods[channel];
+}
+
+void OscilloscopeGroup::plotLines(int64_t origin, double xmin, double xmax,
+                                  int pixels) const {
+    for (size_t c = 0; c < m_names.size(); ++c) {
+        m_lods[c].plotLine(m_names[c].c_str(), m_buffer, c, origin, xmin, xmax,
+                           pixels);
+    }
+}
+
+OscilloscopeDerived::OscilloscopeDerived(const std::string& name,
+                                         const ScopeExpr& expr,
+                                         const ScopeStore* source,
+                                         const std::vector<size_t>& channels,
+                                         const ScopeCapacity& capacity)
+    : m_name(name),
+      m_expr(expr),
+      m_source(source),
+      m_channels(channels),
+      m_end(source->begin()),
+      m_times(ScopeStore::kChunkSamples),
+      m_inputs(channels.size() * ScopeStore::kChunkSamples),
+      m_columns(channels.size()),
+      m_values(ScopeStore::kChunkSamples),
+      m_buffer(capacity),
+      m_lod(m_buffer.capacity()) {
+    for (size_t v = 0; v < m_columns.size(); ++v) {
+        m_columns[v] = &m_inputs[v * ScopeStore::kChunkSamples];
+    }
+}
+
+size_t OscilloscopeDerived::update() {
+    const ScopeStore& source = *m_source;
+    if (m_end > source.end()) {
+        // 信号源被清空，重新开始
+        m_buffer.clear();
+        m_expr.reset();
+        m_end = source.begin();
+    } else if (m_end < source.begin()) {
+        // 未计算的数据已被淘汰，从最早的数据继续
+        m_expr.reset();
+        m_end = source.begin();
+    }
+    size_t total = 0;
+    while (m_end < source.end()) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(
+            source.end() - m_end, ScopeStore::kChunkSamples));
+        source.copyTimes(m_end, n, m_times.data());
+        for (size_t v = 0; v < m_channels.size(); ++v) {
+            source.copyValues(m_channels[v], m_end, n,
+                              &m_inputs[v * ScopeStore::kChunkSamples]);
+        }
+        m_expr.evaluate(m_times.data(), m_columns.data(), n, m_values.data());
+        const uint64_t seq = m_buffer.end();
+        m_buffer.append(m_times.data(), m_values.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            m_lod.append(seq + i, m_values[i]);
+        }
+        m_end += n;
+        total += n;
+    }
+    return total;
+}
+
+void OscilloscopeDerived::plotLine(int64_t origin, double xmin, double xmax,
+                                   int pixels) const {
+    m_lod.plotLine(m_name.c_str(), m_buffer, 0, origin, xmin, xmax, pixels);
+}
+
 };  // namespace MoproboGui
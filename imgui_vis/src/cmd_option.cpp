@@ -0,0 +1,25 @@
+#include "cmd_option.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace MoproboGui {
+
+const char* option(const char* arg, const char* name) {
+    const size_t len = strlen(name);
+    if (strncmp(arg, name, len) != 0 || arg[len] != '=') return nullptr;
+    return arg + len + 1;
+}
+
+bool parseSize(const char* value, int* width, int* height) {
+    int w = 0;
+    int h = 0;
+    if (sscanf(value, "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+        return false;
+    }
+    *width = w;
+    *height = h;
+    return true;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,203 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+
+#include "imgui.h"
+#include "implot.h"
+
+namespace MoproboGui {
+
+constexpr size_t FrameProfiler::kHistory;
+
+namespace {
+
+const char* const kStageNames[kStageCount] = {
+    "事件",   "NewFrame", "性能分析",       "示波器",
+    "直方图", "Render",   "RenderDrawData", "交换",
+};
+
+// 三条分位线
+const char* const kPercentileNames[3] = {"p50", "p95", "p99"};
+const double kPercentiles[3] = {0.50, 0.95, 0.99};
+
+}  // namespace
+
+FrameProfiler::FrameProfiler() : m_records(1024), m_history(kHistory) {
+    m_sorted.reserve(kHistory);
+}
+
+void FrameProfiler::beginFrame() {
+    m_current = FrameRecord();
+    m_last = Clock::now();
+}
+
+void FrameProfiler::mark(ProfileStage stage) {
+    const auto now = Clock::now();
+    const std::chrono::duration<float, std::milli> elapsed = now - m_last;
+    m_current.stage[stage] += elapsed.count();
+    m_last = now;
+}
+
+void FrameProfiler::endFrame(const ImDrawData* drawData) {
+    float work = 0;
+    for (int i = 0; i < kStageCount; ++i) {
+        if (i != kStageEvents && i != kStageSwap) work += m_current.stage[i];
+    }
+    m_current.work = work;
+    if (drawData != nullptr) {
+        m_current.vertices = drawData->TotalVtxCount;
+        m_current.indices = drawData->TotalIdxCount;
+    }
+    m_records.push(m_current);
+    updateRates(m_last);
+}
+
+void FrameProfiler::ingest(const void* source, const std::string& scope,
+                           const std::string& name, size_t count) {
+    auto it = m_ingestIndex.find(source);
+    if (it == m_ingestIndex.end()) {
+        it = m_ingestIndex.insert({source, m_ingest.size()}).first;
+        m_ingest.push_back(Ingest());
+        m_ingest.back().label = scope + "/" + name;
+    }
+    m_ingest[it->second].count += count;
+}
+
+void FrameProfiler::removeSource(const void* source) {
+    auto it = m_ingestIndex.find(source);
+    if (it == m_ingestIndex.end()) return;
+    const size_t index = it->second;
+    m_ingestIndex.erase(it);
+    m_ingest.erase(m_ingest.begin() + index);
+    for (auto& entry : m_ingestIndex) {
+        if (entry.second > index) --entry.second;
+    }
+}
+
+void FrameProfiler::updateRates(Clock::time_point now) {
+    if (m_rateStart == Clock::time_point()) {
+        m_rateStart = now;
+        return;
+    }
+    const std::chrono::duration<double> elapsed = now - m_rateStart;
+    if (elapsed.count() < 1.0) return;
+    for (auto& source : m_ingest) {
+        source.rate = static_cast<float>(source.count / elapsed.count());
+        source.count = 0;
+    }
+    m_rateStart = now;
+}
+
+void FrameProfiler::collect() {
+    m_records.drain([this](const FrameRecord* records, size_t n) {
+        if (m_paused) return;
+        for (size_t i = 0; i < n; ++i) {
+            m_history[m_next] = records[i];
+            if (++m_next == kHistory) m_next = 0;
+        }
+        m_size = std::min(m_size + n, kHistory);
+    });
+}
+
+void FrameProfiler::percentiles(size_t index, float out[3]) {
+    m_sorted.clear();
+    for (size_t i = 0; i < m_size; ++i) {
+        const FrameRecord& record = m_history[i];
+        m_sorted.push_back(index < kStageCount ? record.stage[index]
+                                               : record.work);
+    }
+    for (int i = 0; i < 3; ++i) {
+        out[i] = 0;
+        if (m_sorted.empty()) continue;
+        // 分位数递增，后一次只需在前一次的位置之后查找
+        const size_t begin =
+            i == 0 ? 0
+                   : static_cast<size_t>(kPercentiles[i - 1] *
+                                         (m_sorted.size() - 1));
+        const size_t k =
+            static_cast<size_t>(kPercentiles[i] * (m_sorted.size() - 1));
+        std::nth_element(m_sorted.begin() + begin, m_sorted.begin() + k,
+                         m_sorted.end());
+        out[i] = m_sorted[k];
+    }
+}
+
+void FrameProfiler::plotSeries(const char* label, const float* first) const {
+    // 历史满后最旧的一帧在m_next处，通过offset从它开始连线
+    const int offset = m_size == kHistory ? static_cast<int>(m_next) : 0;
+    ImPlot::PlotLine(label, first, static_cast<int>(m_size), 1.0, 0.0, 0,
+                     offset, sizeof(FrameRecord));
+}
+
+void FrameProfiler::showFrameProfiler() {
+    // 折叠时也取走记录，历史保持连续
+    collect();
+    if (!ImGui::CollapsingHeader("帧耗时")) return;
+    ImGui::Checkbox("暂停", &m_paused);
+    ImGui::SameLine();
+    if (ImGui::Button("清除")) m_next = m_size = 0;
+    if (m_size == 0) return;
+
+    // 各阶段和合计的分位数每帧只算一次，分位线和表格共用
+    float values[kStageCount + 1][3];
+    for (size_t index = 0; index <= kStageCount; ++index) {
+        percentiles(index, values[index]);
+    }
+    const float* work = values[kStageCount];
+    if (ImPlot::BeginPlot("##帧耗时", ImVec2(-1, 220))) {
+        ImPlot::SetupAxes("帧", "ms", 0, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, kHistory, ImPlotCond_Always);
+        plotSeries("合计", &m_history[0].work);
+        for (int i = 0; i < kStageCount; ++i) {
+            plotSeries(kStageNames[i], &m_history[0].stage[i]);
+        }
+        for (int i = 0; i < 3; ++i) {
+            ImPlot::PlotInfLines(kPercentileNames[i], &work[i], 1,
+                                 ImPlotInfLinesFlags_Horizontal);
+        }
+        ImPlot::EndPlot();
+    }
+
+    const ImGuiTableFlags flags =
+        ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##分位数", 4, flags)) {
+        ImGui::TableSetupColumn("阶段(ms)");
+        for (int i = 0; i < 3; ++i) {
+            ImGui::TableSetupColumn(kPercentileNames[i]);
+        }
+        ImGui::TableHeadersRow();
+        for (size_t index = 0; index <= kStageCount; ++index) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(index < kStageCount ? kStageNames[index]
+                                                       : "合计");
+            for (int i = 0; i < 3; ++i) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", values[index][i]);
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    const FrameRecord& latest =
+        m_history[(m_next + kHistory - 1) % kHistory];
+    ImGui::Text("顶点 %d  索引 %d", latest.vertices, latest.indices);
+    if (ImPlot::BeginPlot("##绘制列表", ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("帧", nullptr, 0, ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, kHistory, ImPlotCond_Always);
+        const int offset = m_size == kHistory ? static_cast<int>(m_next) : 0;
+        ImPlot::PlotLine("顶点", &m_history[0].vertices,
+                         static_cast<int>(m_size), 1.0, 0.0, 0, offset,
+                         sizeof(FrameRecord));
+        ImPlot::PlotLine("索引", &m_history[0].indices,
+                         static_cast<int>(m_size), 1.0, 0.0, 0, offset,
+                         sizeof(FrameRecord));
+        ImPlot::EndPlot();
+    }
+
+    for (const auto& source : m_ingest) {
+        ImGui::Text("%s: %.0f 点/s", source.label.c_str(), source.rate);
+    }
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,98 @@
+#include "frame_scheduler.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "imgui.h"
+
+namespace MoproboGui {
+
+namespace {
+
+int64_t cpuTime(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+void FrameScheduler::waitFrame(WaitFunc wait, PollFunc poll) {
+    if (!m_config.onDemand) {
+        poll();
+        m_pending.store(false, std::memory_order_relaxed);
+        account(false);
+        return;
+    }
+    // 帧率上限：距上一帧不足最小间隔时先休眠，期间到达的数据合并到同一帧
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(m_config.maxFps, 1.f)));
+    std::this_thread::sleep_until(m_lastFrame + interval);
+
+    bool data = m_pending.load(std::memory_order_acquire);
+    if (data || m_settle > 0) {
+        poll();
+        if (m_settle > 0) --m_settle;
+    } else {
+        double timeout = 3600;
+        if (m_config.idleFps > 0) {
+            const std::chrono::duration<double> idle =
+                m_lastFrame - Clock::now();
+            timeout = std::max(1.0 / m_config.idleFps + idle.count(), 0.0);
+        }
+        const auto start = Clock::now();
+        wait(timeout);
+        const std::chrono::duration<double> waited = Clock::now() - start;
+        data = m_pending.load(std::memory_order_acquire);
+        // 既不是新数据也不是超时，就是输入事件
+        if (!data && waited.count() < timeout) m_settle = m_config.settleFrames;
+    }
+    // 在取数据之前清除，本帧绘制期间到达的数据会再次唤醒
+    m_pending.store(false, std::memory_order_release);
+    account(data);
+}
+
+void FrameScheduler::account(bool dataWakeup) {
+    const auto now = Clock::now();
+    m_lastFrame = now;
+    ++m_frames;
+    if (dataWakeup) ++m_dataWakeups;
+    const int64_t process = cpuTime(CLOCK_PROCESS_CPUTIME_ID);
+    const int64_t gui = cpuTime(CLOCK_THREAD_CPUTIME_ID);
+    if (m_statsStart == Clock::time_point()) {
+        m_statsStart = now;
+        m_processCpu = process;
+        m_guiCpu = gui;
+        return;
+    }
+    const std::chrono::duration<double> elapsed = now - m_statsStart;
+    if (elapsed.count() < 1.0) return;
+    const double ns = elapsed.count() * 1e9;
+    m_stats.fps = static_cast<float>(m_frames / elapsed.count());
+    m_stats.dataWakeups = static_cast<float>(m_dataWakeups / elapsed.count());
+    m_stats.processCpu = static_cast<float>((process - m_processCpu) / ns);
+    m_stats.guiCpu = static_cast<float>((gui - m_guiCpu) / ns);
+    m_statsStart = now;
+    m_processCpu = process;
+    m_guiCpu = gui;
+    m_frames = 0;
+    m_dataWakeups = 0;
+}
+
+void FrameScheduler::showFrameScheduler() {
+    if (!ImGui::CollapsingHeader("帧调度")) return;
+    ImGui::Checkbox("按需刷新", &m_config.onDemand);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(150);
+    ImGui::SliderFloat("最高帧率", &m_config.maxFps, 1, 240, "%.0f");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(150);
+    ImGui::SliderFloat("空闲帧率", &m_config.idleFps, 0, 30, "%.1f");
+    ImGui::Text("%.1f fps  数据唤醒 %.1f/s  CPU: 进程 %.1f%%  GUI线程 %.1f%%",
+                m_stats.fps, m_stats.dataWakeups, m_stats.processCpu * 100,
+                m_stats.guiCpu * 100);
+}
+
+};  // namespace MoproboGui
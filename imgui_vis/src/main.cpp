@@ -1,7 +1,8 @@
 #include <imgui/backends/imgui_impl_glfw.h>
-#include <imgui/backends/imgui_impl_opengl2.h>
+#include <imgui/backends/imgui_impl_opengl3.h>
 #include <imgui/imgui.h>
 
+#include <atomic>
 #include <future>
 #include <iostream>
 
@@ -15,6 +16,9 @@
 
 #include "Implot/imgui_histogram.h"
 #include "Implot/imgui_oscilloscope.h"
+#include "frame_profiler.h"
+#include "frame_scheduler.h"
+#include "render_bench.h"
 
 // [Win32] Our example includes a copy of glfw3.lib pre-compiled with VS2010 to
 // maximize ease of testing and compatibility with old VS compilers. To link
@@ -34,6 +38,21 @@ static void glfw_error_callback(int error, const char *description) {
 int main(int args, char **argv) {
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) return 1;
+
+    // 渲染后端用流式顶点缓冲，每帧只上传一次
+#if defined(__APPLE__)
+    // GL 3.2 + GLSL 150，macOS只提供3.2以上的core profile
+    const char *glsl_version = "#version 150";
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+    // GL 3.0 + GLSL 130
+    const char *glsl_version = "#version 130";
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+#endif
     GLFWwindow *window =
         glfwCreateWindow(1280, 720, "墨派机器人调试工具", NULL, NULL);
     if (window == NULL) {
@@ -64,7 +83,19 @@ int main(int args, char **argv) {
 
     // Setup Platform/Renderer backends
     ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL2_Init();
+
+    // --bench-render: 比较各渲染后端的顶点吞吐量后退出
+    MoproboGui::RenderBenchConfig bench;
+    if (MoproboGui::parseRenderBench(args, argv, &bench)) {
+        const int ret = MoproboGui::runRenderBench(bench);
+        ImGui_ImplGlfw_Shutdown();
+        ImPlot::DestroyContext();
+        ImGui::DestroyContext();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return ret;
+    }
+    ImGui_ImplOpenGL3_Init(glsl_version);
 
     // Our state
     bool show_demo_window = true;
@@ -81,10 +112,11 @@ int main(int args, char **argv) {
     auto plot1 = scope->createPlot("测试数据波形1");
     auto plot2 = scope->createPlot("测试数据波形2");
 
+    std::atomic<bool> running{true};
     std::future<void> scopeThread = std::async(std::launch::async, [&]() {
         int num = 0;
         double time = 0;
-        while (true) {
+        while (running.load(std::memory_order_relaxed)) {
             if (++num > 100) {
                 num -= 100;
             }
@@ -94,6 +126,11 @@ int main(int args, char **argv) {
         }
     });
 
+    // 采样线程写入数据时唤醒主循环，没有输入和新数据时不绘制
+    auto &scheduler = MoproboGui::FrameScheduler::getInstance();
+    scheduler.setWakeup(glfwPostEmptyEvent);
+    auto &profiler = MoproboGui::FrameProfiler::getInstance();
+
     // Main loop
     while (!glfwWindowShouldClose(window)) {
         // Poll and handle events (inputs, window resize, etc.)
@@ -106,18 +143,30 @@ int main(int args, char **argv) {
         // data to your main application, or clear/overwrite your copy of the
         // keyboard data. Generally you may always pass all inputs to dear
         // imgui, and hide them from your application based on those two flags.
-        glfwPollEvents();
+        profiler.beginFrame();
+        scheduler.waitFrame(glfwWaitEventsTimeout, glfwPollEvents);
+        profiler.mark(MoproboGui::kStageEvents);
 
         // Start the Dear ImGui frame
-        ImGui_ImplOpenGL2_NewFrame();
+        ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
-
+        profiler.mark(MoproboGui::kStageNewFrame);
+
+        // 折叠时也要调用，帧耗时记录照常取走
+        ImGui::Begin("性能分析");
+        scheduler.showFrameScheduler();
+        profiler.showFrameProfiler();
+        ImGui::End();
+        profiler.mark(MoproboGui::kStageProfiler);
         MoproboGui::OscilloscopeFactory::getInstance().showMoproboWindow();
+        profiler.mark(MoproboGui::kStageScope);
         MoproboGui::HistogramFactory::getInstance().showHistogram();
+        profiler.mark(MoproboGui::kStageHistogram);
 
         // Rendering
         ImGui::Render();
+        profiler.mark(MoproboGui::kStageRender);
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
         glViewport(0, 0, display_w, display_h);
@@ -125,33 +174,31 @@ int main(int args, char **argv) {
                      clear_color.y * clear_color.w,
                      clear_color.z * clear_color.w, clear_color.w);
         glClear(GL_COLOR_BUFFER_BIT);
-
-        // If you are using this code with non-legacy OpenGL header/contexts
-        // (which you should not, prefer using imgui_impl_opengl3.cpp!!), you
-        // may need to backup/reset/restore other state, e.g. for current shader
-        // using the commented lines below. GLint last_program;
-        // glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-        // glUseProgram(0);
-        ImGui_ImplOpenGL2_RenderDrawData(ImGui::GetDrawData());
-        // glUseProgram(last_program);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        profiler.mark(MoproboGui::kStageDrawData);
 
         glfwMakeContextCurrent(window);
         glfwSwapBuffers(window);
+        profiler.mark(MoproboGui::kStageSwap);
+        profiler.endFrame(ImGui::GetDrawData());
     }
 
     std::cout << "hello imgui" << std::endl;
 
+    // 先停止采样线程，再撤掉唤醒函数，之后不会再有线程调用glfwPostEmptyEvent
+    running = false;
+    if (scopeThread.valid()) {
+        scopeThread.get();
+    }
+    scheduler.setWakeup(nullptr);
+
     // Cleanup
-    ImGui_ImplOpenGL2_Shutdown();
+    ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
     glfwDestroyWindow(window);
     glfwTerminate();
 
-    if (scopeThread.valid()) {
-        scopeThread.get();
-    }
-
     return 0;
 }
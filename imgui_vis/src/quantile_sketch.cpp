@@ -0,0 +1,163 @@
+#include "quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MoproboGui {
+
+void QuantileSketch::Store::add(int index, uint64_t n, size_t maxBins) {
+    if (counts.empty()) {
+        offset = index;
+        counts.assign(1, 0);
+    }
+    const int last = offset + static_cast<int>(counts.size()) - 1;
+    if (index < offset || index > last) {
+        // 扩展到包含index，超出上限时丢掉最低的一段，并入新的最低桶
+        const int hi = std::max(index, last);
+        const int lo = std::max(std::min(index, offset),
+                                hi - static_cast<int>(maxBins) + 1);
+        if (lo != offset || hi != last) {
+            std::vector<uint64_t> resized(hi - lo + 1, 0);
+            for (size_t k = 0; k < counts.size(); ++k) {
+                const int i = std::max(offset + static_cast<int>(k), lo);
+                resized[i - lo] += counts[k];
+            }
+            counts.swap(resized);
+            offset = lo;
+        }
+    }
+    counts[std::max(index, offset) - offset] += n;
+}
+
+void QuantileSketch::Store::merge(const Store& other, size_t maxBins) {
+    if (other.counts.empty()) return;
+    // 先扩展到两端，避免逐桶扩展时反复搬移
+    const int last = other.offset + static_cast<int>(other.counts.size()) - 1;
+    add(last, 0, maxBins);
+    add(other.offset, 0, maxBins);
+    for (size_t k = 0; k < other.counts.size(); ++k) {
+        if (other.counts[k] > 0) {
+            add(other.offset + static_cast<int>(k), other.counts[k], maxBins);
+        }
+    }
+}
+
+QuantileSketch::QuantileSketch(const QuantileSketchConfig& config)
+    : m_config(config) {
+    m_config.accuracy = std::min(std::max(m_config.accuracy, 1e-6), 0.5);
+    m_config.maxBins = std::max<size_t>(m_config.maxBins, 1);
+    m_gamma = (1 + m_config.accuracy) / (1 - m_config.accuracy);
+    m_multiplier = 1 / std::log(m_gamma);
+}
+
+int QuantileSketch::index(double magnitude) const {
+    return static_cast<int>(std::ceil(std::log(magnitude) * m_multiplier));
+}
+
+double QuantileSketch::upper(int index) const {
+    return std::pow(m_gamma, index);
+}
+
+double QuantileSketch::value(int index) const {
+    return 2 * upper(index) / (m_gamma + 1);
+}
+
+void QuantileSketch::add(double value) {
+    if (!std::isfinite(value)) return;
+    if (value > m_config.minValue) {
+        m_positive.add(index(value), 1, m_config.maxBins);
+    } else if (value < -m_config.minValue) {
+        m_negative.add(index(-value), 1, m_config.maxBins);
+    } else {
+        ++m_zero;
+    }
+    if (m_count == 0) {
+        m_min = m_max = value;
+    } else {
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+    }
+    ++m_count;
+    m_sum += value;
+    m_cumulativeValid = false;
+}
+
+void QuantileSketch::add(const float* values, size_t n) {
+    for (size_t i = 0; i < n; ++i) add(static_cast<double>(values[i]));
+}
+
+bool QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.m_config.accuracy != m_config.accuracy ||
+        other.m_config.minValue != m_config.minValue) {
+        return false;
+    }
+    if (other.m_count == 0) return true;
+    m_positive.merge(other.m_positive, m_config.maxBins);
+    m_negative.merge(other.m_negative, m_config.maxBins);
+    m_zero += other.m_zero;
+    if (m_count == 0) {
+        m_min = other.m_min;
+        m_max = other.m_max;
+    } else {
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_cumulativeValid = false;
+    return true;
+}
+
+void QuantileSketch::clear() {
+    m_positive = Store();
+    m_negative = Store();
+    m_zero = 0;
+    m_count = 0;
+    m_sum = 0;
+    m_min = m_max = 0;
+    m_cumulativeValid = false;
+}
+
+double QuantileSketch::min() const { return m_min; }
+
+double QuantileSketch::max() const { return m_max; }
+
+double QuantileSketch::mean() const {
+    return m_count > 0 ? m_sum / m_count : 0;
+}
+
+void QuantileSketch::accumulate() const {
+    const std::vector<uint64_t>& neg = m_negative.counts;
+    const std::vector<uint64_t>& pos = m_positive.counts;
+    m_cumulative.resize(neg.size() + 1 + pos.size());
+    uint64_t seen = 0;
+    size_t j = 0;
+    for (size_t k = neg.size(); k-- > 0;) m_cumulative[j++] = seen += neg[k];
+    m_cumulative[j++] = seen += m_zero;
+    for (size_t k = 0; k < pos.size(); ++k) m_cumulative[j++] = seen += pos[k];
+    m_cumulativeValid = true;
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (m_count == 0) return 0;
+    if (q <= 0) return m_min;
+    if (q >= 1) return m_max;
+    if (!m_cumulativeValid) accumulate();
+    // 排名从0开始，找到累计计数首次超过rank的桶
+    const uint64_t rank = static_cast<uint64_t>(q * (m_count - 1));
+    const size_t j = std::upper_bound(m_cumulative.begin(), m_cumulative.end(),
+                                      rank) -
+                     m_cumulative.begin();
+    const size_t negBins = m_negative.counts.size();
+    double result = m_max;
+    if (j < negBins) {
+        result = -value(m_negative.offset + static_cast<int>(negBins - 1 - j));
+    } else if (j == negBins) {
+        result = 0;
+    } else if (j < m_cumulative.size()) {
+        result = value(m_positive.offset + static_cast<int>(j - negBins - 1));
+    }
+    return std::min(std::max(result, m_min), m_max);
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,177 @@
+#include "render_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "cmd_option.h"
+#include "imgui.h"
+#include "imgui_impl_opengl2.h"
+#include "imgui_impl_opengl3.h"
+#include "implot.h"
+
+#if defined(__APPLE__)
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+namespace MoproboGui {
+
+constexpr int RenderBenchConfig::kMaxPoints;
+
+namespace {
+
+struct Backend {
+    const char* name;
+    int upload;  // <0表示opengl2，否则为ImGui_ImplOpenGL3_Upload_XXX
+};
+
+const Backend kBackends[] = {
+    {"opengl2 客户端数组", -1},
+    {"opengl3 BufferData", ImGui_ImplOpenGL3_Upload_BufferData},
+    {"opengl3 孤立缓冲", ImGui_ImplOpenGL3_Upload_Orphan},
+    {"opengl3 持久映射", ImGui_ImplOpenGL3_Upload_Persistent},
+};
+
+bool initBackend(const Backend& backend) {
+#if defined(__APPLE__)
+    // macOS上是core profile，没有opengl2后端需要的固定管线
+    if (backend.upload < 0) return false;
+#endif
+    if (backend.upload < 0) return ImGui_ImplOpenGL2_Init();
+    if (!ImGui_ImplOpenGL3_Init()) return false;
+    if (ImGui_ImplOpenGL3_SetUploadMode(backend.upload)) return true;
+    ImGui_ImplOpenGL3_Shutdown();
+    return false;
+}
+
+void shutdownBackend(const Backend& backend) {
+    if (backend.upload < 0) {
+        ImGui_ImplOpenGL2_Shutdown();
+    } else {
+        ImGui_ImplOpenGL3_Shutdown();
+    }
+}
+
+}  // namespace
+
+bool parseRenderBench(int argc, char** argv, RenderBenchConfig* config) {
+    bool bench = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        if (strcmp(arg, "--bench-render") == 0) {
+            bench = true;
+        } else if ((value = option(arg, "--frames")) != nullptr) {
+            config->frames = std::max(1, atoi(value));
+        } else if ((value = option(arg, "--lines")) != nullptr) {
+            config->lines = std::max(1, atoi(value));
+        } else if ((value = option(arg, "--points")) != nullptr) {
+            config->points = std::min(std::max(2, atoi(value)),
+                                      RenderBenchConfig::kMaxPoints);
+        } else if ((value = option(arg, "--size")) != nullptr) {
+            parseSize(value, &config->width, &config->height);
+        }
+    }
+    return bench;
+}
+
+int runRenderBench(const RenderBenchConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    // 带噪声的正弦，相邻线段方向各不相同，ImPlot不会合并
+    std::vector<float> xs(config.points);
+    std::vector<std::vector<float>> ys(config.lines,
+                                       std::vector<float>(config.points));
+    for (int i = 0; i < config.points; ++i) {
+        xs[i] = static_cast<float>(i) / (config.points - 1);
+        for (int l = 0; l < config.lines; ++l) {
+            ys[l][i] = static_cast<float>(
+                l + 0.4 * std::sin(2 * M_PI * (l + 3) * xs[i]) +
+                0.05 * std::sin(i * 1.7 + l));
+        }
+    }
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(config.width),
+                            static_cast<float>(config.height));
+    io.DeltaTime = 1.0f / 60;
+    printf("渲染后端基准: %dx%d, %d 条曲线 x %d 点, %d 帧\n", config.width,
+           config.height, config.lines, config.points, config.frames);
+    // 后端名称含中文，放在最后一列以免错位
+    printf("%10s %10s %14s %10s  %s\n", "vtx/frame", "submit ms",
+           "+glFinish ms", "Mvtx/s", "backend");
+
+    for (const Backend& backend : kBackends) {
+        if (!initBackend(backend)) {
+            printf("%10s %10s %14s %10s  %s(当前上下文不支持)\n", "-", "-", "-",
+                   "-", backend.name);
+            continue;
+        }
+        double submitMs = 0;
+        double totalMs = 0;
+        double vertices = 0;
+        for (int frame = 0; frame < config.warmup + config.frames; ++frame) {
+            if (backend.upload < 0) {
+                ImGui_ImplOpenGL2_NewFrame();
+            } else {
+                ImGui_ImplOpenGL3_NewFrame();
+            }
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("渲染基准", nullptr, ImGuiWindowFlags_NoDecoration);
+            // 每条曲线放在单独的子窗口里，各有自己的绘制列表
+            const float height =
+                ImGui::GetContentRegionAvail().y / config.lines;
+            for (int l = 0; l < config.lines; ++l) {
+                const std::string label = "曲线" + std::to_string(l);
+                ImGui::BeginChild(label.c_str(), ImVec2(-1, height));
+                if (ImPlot::BeginPlot(label.c_str(), ImVec2(-1, -1),
+                                      ImPlotFlags_CanvasOnly)) {
+                    ImPlot::SetupAxesLimits(0, 1, l - 0.5, l + 0.5,
+                                            ImPlotCond_Always);
+                    ImPlot::PlotLine(label.c_str(), xs.data(), ys[l].data(),
+                                     config.points);
+                    ImPlot::EndPlot();
+                }
+                ImGui::EndChild();
+            }
+            ImGui::End();
+            ImGui::Render();
+
+            ImDrawData* drawData = ImGui::GetDrawData();
+            glViewport(0, 0, config.width, config.height);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glFinish();
+            const auto start = Clock::now();
+            if (backend.upload < 0) {
+                ImGui_ImplOpenGL2_RenderDrawData(drawData);
+            } else {
+                ImGui_ImplOpenGL3_RenderDrawData(drawData);
+            }
+            const auto submitted = Clock::now();
+            glFinish();
+            const auto end = Clock::now();
+            if (frame < config.warmup) continue;
+            submitMs += Ms(submitted - start).count();
+            totalMs += Ms(end - start).count();
+            vertices += drawData->TotalVtxCount;
+        }
+        shutdownBackend(backend);
+        printf("%10.0f %10.3f %14.3f %10.1f  %s\n", vertices / config.frames,
+               submitMs / config.frames, totalMs / config.frames,
+               vertices / totalMs / 1000, backend.name);
+    }
+    return 0;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,467 @@
+#include "scope_expr.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace MoproboGui {
+
+constexpr size_t ScopeExpr::kBlock;
+
+namespace {
+
+// 无状态运算的向量实现，没有SIMD时退化为逐点计算
+#if defined(__SSE2__)
+using Vec = __m128;
+constexpr size_t kLanes = 4;
+inline Vec load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+inline Vec vadd(Vec a, Vec b) { return _mm_add_ps(a, b); }
+inline Vec vsub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+inline Vec vmul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+inline Vec vdiv(Vec a, Vec b) { return _mm_div_ps(a, b); }
+inline Vec vmin(Vec a, Vec b) { return _mm_min_ps(a, b); }
+inline Vec vmax(Vec a, Vec b) { return _mm_max_ps(a, b); }
+inline Vec vneg(Vec a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+inline Vec vabs(Vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+inline Vec vsqrt(Vec a) { return _mm_sqrt_ps(a); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+using Vec = float32x4_t;
+constexpr size_t kLanes = 4;
+inline Vec load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, Vec v) { vst1q_f32(p, v); }
+inline Vec vadd(Vec a, Vec b) { return vaddq_f32(a, b); }
+inline Vec vsub(Vec a, Vec b) { return vsubq_f32(a, b); }
+inline Vec vmul(Vec a, Vec b) { return vmulq_f32(a, b); }
+inline Vec vdiv(Vec a, Vec b) { return vdivq_f32(a, b); }
+inline Vec vmin(Vec a, Vec b) { return vminq_f32(a, b); }
+inline Vec vmax(Vec a, Vec b) { return vmaxq_f32(a, b); }
+inline Vec vneg(Vec a) { return vnegq_f32(a); }
+inline Vec vabs(Vec a) { return vabsq_f32(a); }
+inline Vec vsqrt(Vec a) { return vsqrtq_f32(a); }
+#else
+using Vec = float;
+constexpr size_t kLanes = 1;
+inline Vec load(const float* p) { return *p; }
+inline void store(float* p, Vec v) { *p = v; }
+inline Vec vadd(Vec a, Vec b) { return a + b; }
+inline Vec vsub(Vec a, Vec b) { return a - b; }
+inline Vec vmul(Vec a, Vec b) { return a * b; }
+inline Vec vdiv(Vec a, Vec b) { return a / b; }
+inline Vec vmin(Vec a, Vec b) { return std::min(a, b); }
+inline Vec vmax(Vec a, Vec b) { return std::max(a, b); }
+inline Vec vneg(Vec a) { return -a; }
+inline Vec vabs(Vec a) { return std::fabs(a); }
+inline Vec vsqrt(Vec a) { return std::sqrt(a); }
+#endif
+
+// a = op(a, b)
+template <typename VecOp, typename ScalarOp>
+void binary(float* a, const float* b, size_t n, VecOp vop, ScalarOp sop) {
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        store(a + i, vop(load(a + i), load(b + i)));
+    }
+    for (; i < n; ++i) a[i] = sop(a[i], b[i]);
+}
+
+// a = op(a)
+template <typename VecOp, typename ScalarOp>
+void unary(float* a, size_t n, VecOp vop, ScalarOp sop) {
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        store(a + i, vop(load(a + i)));
+    }
+    for (; i < n; ++i) a[i] = sop(a[i]);
+}
+
+bool isNameStart(char c) {
+    const unsigned char u = static_cast<unsigned char>(c);
+    return std::isalpha(u) || c == '_' || u >= 0x80;
+}
+
+bool isNameChar(char c) {
+    return isNameStart(c) || std::isdigit(static_cast<unsigned char>(c)) ||
+           c == '.';
+}
+
+// 函数名和参数个数，constArg为true时第二个参数必须是常数
+struct Function {
+    const char* name;
+    int args;
+    bool constArg;
+};
+
+const Function kFunctions[] = {
+    {"abs", 1, false},  {"sqrt", 1, false}, {"min", 2, false},
+    {"max", 2, false},  {"avg", 2, true},   {"diff", 1, false},
+    {"integ", 1, false}, {"lpf", 2, true},
+};
+
+};  // namespace
+
+bool ScopeExpr::compile(const std::string& text) {
+    m_text = text;
+    m_error.clear();
+    m_cursor = 0;
+    m_variables.clear();
+    m_code.clear();
+    m_states.clear();
+    m_depth = 0;
+    m_maxDepth = 0;
+    if (!parseSum()) return false;
+    skipSpace();
+    if (m_cursor < m_text.size()) return fail("多余的字符");
+    m_stack.assign(m_maxDepth * kBlock, 0);
+    return true;
+}
+
+void ScopeExpr::reset() {
+    for (auto& state : m_states) {
+        const size_t n = state.window.size();
+        state = State();
+        state.window.assign(n, 0);
+    }
+}
+
+void ScopeExpr::evaluate(const int64_t* times, const float* const* inputs,
+                         size_t count, float* out) {
+    if (m_code.empty()) return;
+    std::vector<const float*> block(m_variables.size());
+    for (size_t done = 0; done < count; done += kBlock) {
+        const size_t n = std::min(kBlock, count - done);
+        for (size_t v = 0; v < block.size(); ++v) block[v] = inputs[v] + done;
+        run(times + done, block.data(), n);
+        memcpy(out + done, m_stack.data(), n * sizeof(float));
+    }
+}
+
+void ScopeExpr::run(const int64_t* times, const float* const* inputs,
+                    size_t count) {
+    int top = -1;
+    for (const Code& code : m_code) {
+        float* a = &m_stack[(top > 0 ? top - 1 : 0) * kBlock];
+        float* b = &m_stack[(top > 0 ? top : 0) * kBlock];
+        switch (code.op) {
+            case Op::Input:
+                ++top;
+                memcpy(&m_stack[top * kBlock], inputs[code.arg],
+                       count * sizeof(float));
+                break;
+            case Op::Const:
+                ++top;
+                std::fill_n(&m_stack[top * kBlock], count, code.value);
+                break;
+            case Op::Neg:
+                unary(b, count, vneg, [](float x) { return -x; });
+                break;
+            case Op::Abs:
+                unary(b, count, vabs, [](float x) { return std::fabs(x); });
+                break;
+            case Op::Sqrt:
+                unary(b, count, vsqrt, [](float x) { return std::sqrt(x); });
+                break;
+            case Op::Add:
+                binary(a, b, count, vadd,
+                       [](float x, float y) { return x + y; });
+                --top;
+                break;
+            case Op::Sub:
+                binary(a, b, count, vsub,
+                       [](float x, float y) { return x - y; });
+                --top;
+                break;
+            case Op::Mul:
+                binary(a, b, count, vmul,
+                       [](float x, float y) { return x * y; });
+                --top;
+                break;
+            case Op::Div:
+                binary(a, b, count, vdiv,
+                       [](float x, float y) { return x / y; });
+                --top;
+                break;
+            case Op::Min:
+                binary(a, b, count, vmin,
+                       [](float x, float y) { return std::min(x, y); });
+                --top;
+                break;
+            case Op::Max:
+                binary(a, b, count, vmax,
+                       [](float x, float y) { return std::max(x, y); });
+                --top;
+                break;
+            case Op::Avg: {
+                // 滑动窗口求和，每个点O(1)
+                State& s = m_states[code.arg];
+                const size_t n = s.window.size();
+                for (size_t i = 0; i < count; ++i) {
+                    s.sum += b[i] - s.window[s.pos];
+                    s.window[s.pos] = b[i];
+                    if (++s.pos == n) s.pos = 0;
+                    if (s.filled < n) ++s.filled;
+                    b[i] = static_cast<float>(s.sum / s.filled);
+                }
+                break;
+            }
+            case Op::Diff: {
+                State& s = m_states[code.arg];
+                for (size_t i = 0; i < count; ++i) {
+                    const double x = b[i];
+                    if (s.started && times[i] > s.lastTime) {
+                        s.sum = (x - s.last) / ((times[i] - s.lastTime) * 1e-9);
+                    }
+                    s.started = true;
+                    s.last = x;
+                    s.lastTime = times[i];
+                    b[i] = static_cast<float>(s.sum);
+                }
+                break;
+            }
+            case Op::Integ: {
+                State& s = m_states[code.arg];
+                for (size_t i = 0; i < count; ++i) {
+                    const double x = b[i];
+                    if (s.started) {
+                        const double dt = (times[i] - s.lastTime) * 1e-9;
+                        s.sum += 0.5 * (x + s.last) * dt;
+                    }
+                    s.started = true;
+                    s.last = x;
+                    s.lastTime = times[i];
+                    b[i] = static_cast<float>(s.sum);
+                }
+                break;
+            }
+            case Op::Lpf: {
+                // 按实际采样间隔计算系数，采样不均匀时截止频率不变；
+                // 间隔不变时沿用上一次的系数
+                State& s = m_states[code.arg];
+                const double w = 2 * M_PI * code.value;
+                for (size_t i = 0; i < count; ++i) {
+                    const double x = b[i];
+                    if (!s.started) {
+                        s.started = true;
+                        s.sum = x;
+                    } else {
+                        const int64_t step = times[i] - s.lastTime;
+                        if (step != s.step) {
+                            s.step = step;
+                            s.gain = 1 - std::exp(-w * step * 1e-9);
+                        }
+                        s.sum += s.gain * (x - s.sum);
+                    }
+                    s.lastTime = times[i];
+                    b[i] = static_cast<float>(s.sum);
+                }
+                break;
+            }
+        }
+    }
+}
+
+bool ScopeExpr::parseSum() {
+    if (!parseProduct()) return false;
+    for (;;) {
+        skipSpace();
+        if (m_cursor >= m_text.size()) return true;
+        const char c = m_text[m_cursor];
+        if (c != '+' && c != '-') return true;
+        ++m_cursor;
+        if (!parseProduct()) return false;
+        emit(c == '+' ? Op::Add : Op::Sub);
+    }
+}
+
+bool ScopeExpr::parseProduct() {
+    if (!parseUnary()) return false;
+    for (;;) {
+        skipSpace();
+        if (m_cursor >= m_text.size()) return true;
+        const char c = m_text[m_cursor];
+        if (c != '*' && c != '/') return true;
+        ++m_cursor;
+        if (!parseUnary()) return false;
+        emit(c == '*' ? Op::Mul : Op::Div);
+    }
+}
+
+bool ScopeExpr::parseUnary() {
+    skipSpace();
+    if (m_cursor < m_text.size() && m_text[m_cursor] == '-') {
+        ++m_cursor;
+        if (!parseUnary()) return false;
+        // 常数直接取负，不生成指令
+        if (!m_code.empty() && m_code.back().op == Op::Const) {
+            m_code.back().value = -m_code.back().value;
+        } else {
+            emit(Op::Neg);
+        }
+        return true;
+    }
+    if (m_cursor < m_text.size() && m_text[m_cursor] == '+') ++m_cursor;
+    return parsePrimary();
+}
+
+bool ScopeExpr::parsePrimary() {
+    skipSpace();
+    if (m_cursor >= m_text.size()) return fail("表达式不完整");
+    const char c = m_text[m_cursor];
+    if (c == '(') {
+        ++m_cursor;
+        return parseSum() && expect(')');
+    }
+    if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+        float value = 0;
+        if (!parseNumber(&value)) return false;
+        emit(Op::Const, 0, value);
+        return true;
+    }
+    // 反引号括起的总是通道名
+    const bool quoted = c == '`';
+    std::string name;
+    if (!parseName(&name)) return false;
+    skipSpace();
+    if (!quoted && m_cursor < m_text.size() &&
+        m_text[m_cursor] == '(') {
+        return parseCall(name);
+    }
+    auto it = std::find(m_variables.begin(), m_variables.end(), name);
+    const size_t index = it - m_variables.begin();
+    if (it == m_variables.end()) m_variables.push_back(name);
+    emit(Op::Input, static_cast<uint32_t>(index));
+    return true;
+}
+
+bool ScopeExpr::parseCall(const std::string& name) {
+    const Function* func = nullptr;
+    for (const auto& f : kFunctions) {
+        if (name == f.name) func = &f;
+    }
+    if (func == nullptr) return fail("未知函数 " + name);
+    ++m_cursor;  // '('
+    if (!parseSum()) return false;
+    float arg = 0;
+    if (func->args == 2) {
+        if (!expect(',')) return false;
+        if (func->constArg) {
+            skipSpace();
+            if (!parseNumber(&arg)) return false;
+        } else if (!parseSum()) {
+            return false;
+        }
+    }
+    if (!expect(')')) return false;
+
+    const std::string fn = func->name;
+    if (fn == "abs") {
+        emit(Op::Abs);
+    } else if (fn == "sqrt") {
+        emit(Op::Sqrt);
+    } else if (fn == "min") {
+        emit(Op::Min);
+    } else if (fn == "max") {
+        emit(Op::Max);
+    } else {
+        State state;
+        Op op = Op::Diff;
+        if (fn == "avg") {
+            if (arg < 1 || arg > (1 << 20) || arg != std::floor(arg)) {
+                return fail("avg的点数应为1~1048576的整数");
+            }
+            state.window.assign(static_cast<size_t>(arg), 0);
+            op = Op::Avg;
+        } else if (fn == "integ") {
+            op = Op::Integ;
+        } else if (fn == "lpf") {
+            if (!(arg > 0)) return fail("lpf的截止频率应大于0");
+            op = Op::Lpf;
+        }
+        m_states.push_back(std::move(state));
+        emit(op, static_cast<uint32_t>(m_states.size() - 1), arg);
+    }
+    return true;
+}
+
+bool ScopeExpr::parseName(std::string* name) {
+    const size_t start = m_cursor;
+    if (m_text[m_cursor] == '`') {
+        const size_t end = m_text.find('`', start + 1);
+        if (end == std::string::npos || end == start + 1) {
+            return fail("反引号不匹配");
+        }
+        *name = m_text.substr(start + 1, end - start - 1);
+        m_cursor = end + 1;
+        return true;
+    }
+    if (!isNameStart(m_text[m_cursor])) {
+        return fail(std::string("无法识别的字符 '") + m_text[m_cursor] + "'");
+    }
+    while (m_cursor < m_text.size() && isNameChar(m_text[m_cursor])) {
+        ++m_cursor;
+    }
+    *name = m_text.substr(start, m_cursor - start);
+    return true;
+}
+
+bool ScopeExpr::parseNumber(float* value) {
+    const char* begin = m_text.c_str() + m_cursor;
+    char* end = nullptr;
+    const double v = strtod(begin, &end);
+    if (end == begin) return fail("应为数字");
+    m_cursor += end - begin;
+    *value = static_cast<float>(v);
+    return true;
+}
+
+bool ScopeExpr::expect(char c) {
+    skipSpace();
+    if (m_cursor >= m_text.size() || m_text[m_cursor] != c) {
+        return fail(std::string("缺少 '") + c + "'");
+    }
+    ++m_cursor;
+    return true;
+}
+
+void ScopeExpr::skipSpace() {
+    while (m_cursor < m_text.size() &&
+           std::isspace(static_cast<unsigned char>(m_text[m_cursor]))) {
+        ++m_cursor;
+    }
+}
+
+bool ScopeExpr::fail(const std::string& message) {
+    m_error = message + "(第" + std::to_string(m_cursor + 1) + "个字符)";
+    m_code.clear();
+    return false;
+}
+
+void ScopeExpr::emit(Op op, uint32_t arg, float value) {
+    m_code.push_back({op, arg, value});
+    switch (op) {
+        case Op::Input:
+        case Op::Const:
+            m_maxDepth = std::max(m_maxDepth, ++m_depth);
+            break;
+        case Op::Add:
+        case Op::Sub:
+        case Op::Mul:
+        case Op::Div:
+        case Op::Min:
+        case Op::Max:
+            --m_depth;
+            break;
+        default:
+            break;
+    }
+}
+
+};  // namespace MoproboGui
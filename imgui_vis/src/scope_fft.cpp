@@ -0,0 +1,131 @@
+#include "scope_fft.h"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace MoproboGui {
+
+RealFft::RealFft(size_t size)
+    : m_size(size),
+      m_half(size / 2),
+      m_bitrev(m_half),
+      m_twRe(m_half),
+      m_twIm(m_half),
+      m_splitRe(m_half),
+      m_splitIm(m_half),
+      m_re(m_half),
+      m_im(m_half) {
+    int bits = 0;
+    while ((size_t(1) << bits) < m_half) ++bits;
+    for (size_t i = 0; i < m_half; ++i) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitrev[i] = r;
+    }
+    for (size_t h = 1; h < m_half; h <<= 1) {
+        for (size_t k = 0; k < h; ++k) {
+            const double a = -M_PI * k / h;
+            m_twRe[h + k] = static_cast<float>(std::cos(a));
+            m_twIm[h + k] = static_cast<float>(std::sin(a));
+        }
+    }
+    for (size_t k = 0; k < m_half; ++k) {
+        const double a = -2 * M_PI * k / m_size;
+        m_splitRe[k] = static_cast<float>(std::cos(a));
+        m_splitIm[k] = static_cast<float>(std::sin(a));
+    }
+}
+
+void RealFft::transform() {
+    float* re = m_re.data();
+    float* im = m_im.data();
+    const size_t n = m_half;
+    for (size_t h = 1; h < n; h <<= 1) {
+        const float* wr = &m_twRe[h];
+        const float* wi = &m_twIm[h];
+        for (size_t s = 0; s < n; s += 2 * h) {
+            float* ar = re + s;
+            float* ai = im + s;
+            float* br = ar + h;
+            float* bi = ai + h;
+            size_t k = 0;
+#if defined(__SSE2__)
+            for (; k + 4 <= h; k += 4) {
+                const __m128 xr = _mm_loadu_ps(br + k);
+                const __m128 xi = _mm_loadu_ps(bi + k);
+                const __m128 cr = _mm_loadu_ps(wr + k);
+                const __m128 ci = _mm_loadu_ps(wi + k);
+                const __m128 tr =
+                    _mm_sub_ps(_mm_mul_ps(xr, cr), _mm_mul_ps(xi, ci));
+                const __m128 ti =
+                    _mm_add_ps(_mm_mul_ps(xr, ci), _mm_mul_ps(xi, cr));
+                const __m128 yr = _mm_loadu_ps(ar + k);
+                const __m128 yi = _mm_loadu_ps(ai + k);
+                _mm_storeu_ps(br + k, _mm_sub_ps(yr, tr));
+                _mm_storeu_ps(bi + k, _mm_sub_ps(yi, ti));
+                _mm_storeu_ps(ar + k, _mm_add_ps(yr, tr));
+                _mm_storeu_ps(ai + k, _mm_add_ps(yi, ti));
+            }
+#elif defined(__ARM_NEON)
+            for (; k + 4 <= h; k += 4) {
+                const float32x4_t xr = vld1q_f32(br + k);
+                const float32x4_t xi = vld1q_f32(bi + k);
+                const float32x4_t cr = vld1q_f32(wr + k);
+                const float32x4_t ci = vld1q_f32(wi + k);
+                const float32x4_t tr =
+                    vsubq_f32(vmulq_f32(xr, cr), vmulq_f32(xi, ci));
+                const float32x4_t ti =
+                    vaddq_f32(vmulq_f32(xr, ci), vmulq_f32(xi, cr));
+                const float32x4_t yr = vld1q_f32(ar + k);
+                const float32x4_t yi = vld1q_f32(ai + k);
+                vst1q_f32(br + k, vsubq_f32(yr, tr));
+                vst1q_f32(bi + k, vsubq_f32(yi, ti));
+                vst1q_f32(ar + k, vaddq_f32(yr, tr));
+                vst1q_f32(ai + k, vaddq_f32(yi, ti));
+            }
+#endif
+            // 前两级及不支持SIMD时逐点计算
+            for (; k < h; ++k) {
+                const float tr = br[k] * wr[k] - bi[k] * wi[k];
+                const float ti = br[k] * wi[k] + bi[k] * wr[k];
+                br[k] = ar[k] - tr;
+                bi[k] = ai[k] - ti;
+                ar[k] += tr;
+                ai[k] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float* in, float* re, float* im) {
+    // 偶数点作实部、奇数点作虚部，装入时完成位反转重排
+    for (size_t i = 0; i < m_half; ++i) {
+        m_re[m_bitrev[i]] = in[2 * i];
+        m_im[m_bitrev[i]] = in[2 * i + 1];
+    }
+    transform();
+
+    re[0] = m_re[0] + m_im[0];
+    im[0] = 0;
+    re[m_half] = m_re[0] - m_im[0];
+    im[m_half] = 0;
+    for (size_t k = 1; k < m_half; ++k) {
+        const size_t j = m_half - k;
+        // 偶数序列与奇数序列的频谱
+        const float er = 0.5f * (m_re[k] + m_re[j]);
+        const float ei = 0.5f * (m_im[k] - m_im[j]);
+        const float orr = 0.5f * (m_im[k] + m_im[j]);
+        const float oi = -0.5f * (m_re[k] - m_re[j]);
+        re[k] = er + m_splitRe[k] * orr - m_splitIm[k] * oi;
+        im[k] = ei + m_splitRe[k] * oi + m_splitIm[k] * orr;
+    }
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,355 @@
+#include "scope_gpu_line.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "imgui.h"
+#include "implot.h"
+#include "implot_internal.h"
+
+#define GL_GLEXT_PROTOTYPES
+#if defined(__APPLE__)
+#include <OpenGL/gl3.h>
+#else
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
+
+namespace MoproboGui {
+
+constexpr size_t ScopeGpuLine::kMaxSamples;
+
+namespace {
+
+// 每个实例是一个线段，4个顶点组成三角形带；
+// 两侧各多扩展1像素，片元按到中心线的距离淡出，得到抗锯齿的边缘
+const char* kVertexShader = R"(#version 140
+uniform samplerBuffer Times;
+uniform samplerBuffer Values;
+uniform int First;
+uniform int Ring;
+uniform vec2 Origin;
+uniform vec2 XMap;
+uniform vec3 YMap;
+uniform float HalfWidth;
+uniform vec4 Display;
+out float Across;
+
+vec2 point(int index) {
+    vec2 t = texelFetch(Times, index).xy;
+    float x = (t.x - Origin.x) + (t.y - Origin.y);
+    float y = texelFetch(Values, index).x - YMap.z;
+    return vec2(XMap.x + XMap.y * x, YMap.x + YMap.y * y);
+}
+
+void main() {
+    int i = (First + gl_InstanceID) % Ring;
+    vec2 p0 = point(i);
+    vec2 p1 = point((i + 1) % Ring);
+    vec2 d = p1 - p0;
+    float len = length(d);
+    vec2 dir = len > 0.0 ? d / len : vec2(1.0, 0.0);
+    float side = (gl_VertexID & 1) == 0 ? 1.0 : -1.0;
+    Across = side * (HalfWidth + 1.0);
+    vec2 p = (gl_VertexID < 2 ? p0 : p1) + vec2(-dir.y, dir.x) * Across;
+    vec2 ndc = (p - Display.xy) / Display.zw * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
+)";
+
+const char* kFragmentShader = R"(#version 140
+uniform vec4 Color;
+uniform float HalfWidth;
+in float Across;
+out vec4 FragColor;
+
+void main() {
+    float alpha = clamp(HalfWidth + 0.5 - abs(Across), 0.0, 1.0);
+    FragColor = vec4(Color.rgb, Color.a * alpha);
+}
+)";
+
+// 所有曲线共用的着色器程序和空的VAO(顶点全部在着色器中生成)
+struct Shared {
+    bool checked{false};
+    bool supported{false};
+    bool enabled{true};
+    GLuint program{0};
+    GLuint vao{0};
+    GLint times{-1};
+    GLint values{-1};
+    GLint first{-1};
+    GLint ring{-1};
+    GLint origin{-1};
+    GLint xMap{-1};
+    GLint yMap{-1};
+    GLint halfWidth{-1};
+    GLint display{-1};
+    GLint color{-1};
+};
+
+Shared& shared() {
+    static Shared instance;
+    return instance;
+}
+
+GLuint compile(GLenum type, const char* source) {
+    const GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        char log[1024] = "";
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        fprintf(stderr, "GPU曲线着色器编译失败: %s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool createProgram(Shared* gl) {
+    const GLuint vs = compile(GL_VERTEX_SHADER, kVertexShader);
+    const GLuint fs = compile(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (vs == 0 || fs == 0) {
+        if (vs != 0) glDeleteShader(vs);
+        if (fs != 0) glDeleteShader(fs);
+        return false;
+    }
+    gl->program = glCreateProgram();
+    glAttachShader(gl->program, vs);
+    glAttachShader(gl->program, fs);
+    glLinkProgram(gl->program);
+    glDetachShader(gl->program, vs);
+    glDetachShader(gl->program, fs);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(gl->program, GL_LINK_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        char log[1024] = "";
+        glGetProgramInfoLog(gl->program, sizeof(log), nullptr, log);
+        fprintf(stderr, "GPU曲线着色器链接失败: %s\n", log);
+        glDeleteProgram(gl->program);
+        gl->program = 0;
+        return false;
+    }
+    gl->times = glGetUniformLocation(gl->program, "Times");
+    gl->values = glGetUniformLocation(gl->program, "Values");
+    gl->first = glGetUniformLocation(gl->program, "First");
+    gl->ring = glGetUniformLocation(gl->program, "Ring");
+    gl->origin = glGetUniformLocation(gl->program, "Origin");
+    gl->xMap = glGetUniformLocation(gl->program, "XMap");
+    gl->yMap = glGetUniformLocation(gl->program, "YMap");
+    gl->halfWidth = glGetUniformLocation(gl->program, "HalfWidth");
+    gl->display = glGetUniformLocation(gl->program, "Display");
+    gl->color = glGetUniformLocation(gl->program, "Color");
+    glGenVertexArrays(1, &gl->vao);
+    return true;
+}
+
+// 把秒数拆成高低两个float，两者之和比单个float精确得多
+void split(double seconds, float out[2]) {
+    out[0] = static_cast<float>(seconds);
+    out[1] = static_cast<float>(seconds - out[0]);
+}
+
+}  // namespace
+
+ScopeGpuLine::ScopeGpuLine(size_t capacity)
+    : m_ring(std::max<size_t>(std::min(capacity, kMaxSamples), 2)) {
+    glGenBuffers(2, m_buffers);
+    glGenTextures(2, m_textures);
+    const GLenum formats[2] = {GL_RG32F, GL_R32F};
+    const size_t sizes[2] = {2 * sizeof(float), sizeof(float)};
+    for (int i = 0; i < 2; ++i) {
+        glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, m_ring * sizes[i], nullptr,
+                     GL_DYNAMIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], m_buffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+ScopeGpuLine::~ScopeGpuLine() {
+    // 没有当前上下文时(如程序退出时窗口已销毁)GL调用不做任何事
+    glDeleteTextures(2, m_textures);
+    glDeleteBuffers(2, m_buffers);
+}
+
+bool ScopeGpuLine::supported() {
+    Shared& gl = shared();
+    if (gl.checked) return gl.supported;
+    gl.checked = true;
+    // 只有opengl3后端保证有可用的GL上下文，无界面模式下不会调用任何GL函数
+    const char* backend = ImGui::GetIO().BackendRendererName;
+    if (backend == nullptr || strcmp(backend, "imgui_impl_opengl3") != 0) {
+        return false;
+    }
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major * 10 + minor < 31) return false;
+    gl.supported = createProgram(&gl);
+    return gl.supported;
+}
+
+bool ScopeGpuLine::enabled() { return shared().enabled; }
+
+void ScopeGpuLine::setEnabled(bool enabled) { shared().enabled = enabled; }
+
+void ScopeGpuLine::upload(const ScopeStore& store, size_t channel,
+                          uint64_t seq, size_t count) {
+    m_times.resize(count);
+    m_values.resize(count);
+    m_texels.resize(count * 2);
+    store.copyTimes(seq, count, m_times.data());
+    store.copyValues(channel, seq, count, m_values.data());
+    for (size_t i = 0; i < count; ++i) {
+        split((m_times[i] - m_base) * 1e-9, &m_texels[i * 2]);
+    }
+    const size_t slot = static_cast<size_t>(seq % m_ring);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[0]);
+    glBufferSubData(GL_TEXTURE_BUFFER, slot * 2 * sizeof(float),
+                    count * 2 * sizeof(float), m_texels.data());
+    glBindBuffer(GL_TEXTURE_BUFFER, m_buffers[1]);
+    glBufferSubData(GL_TEXTURE_BUFFER, slot * sizeof(float),
+                    count * sizeof(float), m_values.data());
+}
+
+void ScopeGpuLine::sync(const ScopeStore& store, size_t channel) {
+    const uint64_t end = store.end();
+    // 存储被清空后序号从0重新开始，可能已经超过上次上传的位置
+    const bool reset =
+        m_end > end || (m_end > store.begin() && m_end > m_begin &&
+                        store.time(m_end - 1) != m_lastTime);
+    if (reset || m_end == m_begin) {
+        m_begin = m_end = store.begin();
+        if (!store.empty()) m_base = store.time(store.begin());
+    }
+    if (end == m_end) return;
+
+    // 只上传环形数组放得下的最新部分，之前的点视为已不在GPU上
+    uint64_t seq = std::max(m_end, store.begin());
+    if (end - seq > m_ring) seq = end - m_ring;
+    if (seq > m_end) m_begin = seq;
+    while (seq < end) {
+        // 每次不跨过环形数组的末尾，也不跨过存储的块
+        const uint64_t slot = seq % m_ring;
+        const uint64_t count = std::min<uint64_t>(
+            {end - seq, m_ring - slot,
+             ScopeStore::kChunkSamples - seq % ScopeStore::kChunkSamples});
+        upload(store, channel, seq, static_cast<size_t>(count));
+        seq += count;
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    m_end = end;
+    if (m_end - m_begin > m_ring) m_begin = m_end - m_ring;
+    m_lastTime = store.time(m_end - 1);
+}
+
+bool ScopeGpuLine::plotLine(const char* label, const ScopeStore& store,
+                            size_t channel, int64_t origin, double xmin,
+                            double xmax) {
+    ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+    const ImPlotAxis& xAxis = plot.Axes[plot.CurrentX];
+    const ImPlotAxis& yAxis = plot.Axes[plot.CurrentY];
+    // 自动适配要遍历所有点，非线性坐标轴无法用一次仿射变换表示
+    if (plot.FitThisFrame || xAxis.TransformForward != nullptr ||
+        yAxis.TransformForward != nullptr) {
+        return false;
+    }
+    sync(store, channel);
+    if (store.empty()) return true;
+
+    // 与ScopeLod::plotLine()相同，两端各多取一个点
+    uint64_t lower = 0;
+    uint64_t upper = 0;
+    store.findRange(origin, xmin, xmax, &lower, &upper);
+    const uint64_t first = lower > store.begin() ? lower - 1 : lower;
+    const uint64_t last = std::min(upper + 1, store.end());
+    if (first < m_begin || last > m_end) return false;
+
+    if (!ImPlot::BeginItem(label, 0, ImPlotCol_Line)) return true;
+    const ImPlotNextItemData& s = ImPlot::GetItemData();
+    if (last - first >= 2 && s.RenderLine) {
+        const ImGuiIO& io = ImGui::GetIO();
+        const ImVec2 pos = ImGui::GetMainViewport()->Pos;
+        const ImVec4 color = s.Colors[ImPlotCol_Line];
+        m_draw.first = static_cast<int>(first % m_ring);
+        m_draw.count = static_cast<int>(last - first - 1);
+        // 着色器中的秒数相对X轴左端，数值小，转换为像素时精度足够
+        split((origin - m_base) * 1e-9 + xAxis.Range.Min, m_draw.origin);
+        m_draw.xMap[0] = xAxis.PixelMin;
+        m_draw.xMap[1] = static_cast<float>(xAxis.ScaleToPixel);
+        m_draw.yMap[0] = yAxis.PixelMin;
+        m_draw.yMap[1] = static_cast<float>(yAxis.ScaleToPixel);
+        m_draw.yMap[2] = static_cast<float>(yAxis.Range.Min);
+        m_draw.color[0] = color.x;
+        m_draw.color[1] = color.y;
+        m_draw.color[2] = color.z;
+        m_draw.color[3] = color.w * ImGui::GetStyle().Alpha;
+        m_draw.halfWidth = s.LineWeight * 0.5f;
+        m_draw.display[0] = pos.x;
+        m_draw.display[1] = pos.y;
+        m_draw.display[2] = io.DisplaySize.x;
+        m_draw.display[3] = io.DisplaySize.y;
+        m_draw.scale[0] = io.DisplayFramebufferScale.x;
+        m_draw.scale[1] = io.DisplayFramebufferScale.y;
+        ImDrawList* list = ImPlot::GetPlotDrawList();
+        list->AddCallback(render, this);
+        list->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+    }
+    ImPlot::EndItem();
+    return true;
+}
+
+void ScopeGpuLine::render(const ImDrawList*, const ImDrawCmd* cmd) {
+    const auto* self = static_cast<const ScopeGpuLine*>(cmd->UserCallbackData);
+    const Draw& draw = self->m_draw;
+    const Shared& gl = shared();
+
+    // 后端只在绘制普通命令时设置裁剪，回调需要自己设置
+    const ImVec4& clip = cmd->ClipRect;
+    const float x0 = (clip.x - draw.display[0]) * draw.scale[0];
+    const float y0 = (clip.y - draw.display[1]) * draw.scale[1];
+    const float x1 = (clip.z - draw.display[0]) * draw.scale[0];
+    const float y1 = (clip.w - draw.display[1]) * draw.scale[1];
+    if (x1 <= x0 || y1 <= y0) return;
+    const float height = draw.display[3] * draw.scale[1];
+    glScissor(static_cast<GLint>(x0), static_cast<GLint>(height - y1),
+              static_cast<GLsizei>(x1 - x0), static_cast<GLsizei>(y1 - y0));
+
+    glUseProgram(gl.program);
+    glBindVertexArray(gl.vao);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, self->m_textures[0]);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, self->m_textures[1]);
+    glUniform1i(gl.times, 1);
+    glUniform1i(gl.values, 2);
+    glUniform1i(gl.first, draw.first);
+    glUniform1i(gl.ring, static_cast<GLint>(self->m_ring));
+    glUniform2fv(gl.origin, 1, draw.origin);
+    glUniform2fv(gl.xMap, 1, draw.xMap);
+    glUniform3fv(gl.yMap, 1, draw.yMap);
+    glUniform1f(gl.halfWidth, draw.halfWidth);
+    glUniform4fv(gl.display, 1, draw.display);
+    glUniform4fv(gl.color, 1, draw.color);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, draw.count);
+
+    // 其余状态由随后的ImDrawCallback_ResetRenderState恢复
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+};  // namespace MoproboGui
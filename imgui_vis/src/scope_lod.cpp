@@ -0,0 +1,106 @@
+#include "scope_lod.h"
+
+#include <algorithm>
+
+namespace MoproboGui {
+
+void LodBucket::merge(const LodBucket& later) {
+    const bool loFromThis = lo <= later.lo;
+    const bool hiFromThis = hi >= later.hi;
+    if (!loFromThis && !hiFromThis) {
+        loFirst = later.loFirst;
+    } else if (loFromThis != hiFromThis) {
+        loFirst = loFromThis;
+    }
+    lo = loFromThis ? lo : later.lo;
+    hi = hiFromThis ? hi : later.hi;
+}
+
+namespace {
+
+struct LodView {
+    const ScopeLod* lod;
+    const ScopeStore* store;
+    size_t channel;
+    int64_t origin;
+    int level;
+    uint64_t first;  // 第0层为起始序号，其余为起始桶号
+};
+
+ImPlotPoint rawGetter(int idx, void* data) {
+    const auto& view = *static_cast<const LodView*>(data);
+    const uint64_t seq = view.first + idx;
+    return ImPlotPoint((view.store->time(seq) - view.origin) * 1e-9,
+                       view.store->value(seq, view.channel));
+}
+
+ImPlotPoint lodGetter(int idx, void* data) {
+    const auto& view = *static_cast<const LodView*>(data);
+    const uint64_t index = view.first + (idx >> 1);
+    const uint64_t size = view.lod->bucketSize(view.level);
+    const LodBucket bucket = view.lod->bucket(view.level, index);
+    const bool first = (idx & 1) == 0;
+    const bool useLo = first == bucket.loFirst;
+    // 桶的两端可能已被淘汰或尚未写满，X取仍有效的首尾点
+    const uint64_t seq =
+        first ? std::max(index * size, view.store->begin())
+              : std::min((index + 1) * size, view.store->end()) - 1;
+    return ImPlotPoint((view.store->time(seq) - view.origin) * 1e-9,
+                       useLo ? bucket.lo : bucket.hi);
+}
+
+}  // namespace
+
+ScopeLod::ScopeLod(size_t capacity, int fanout)
+    : m_pyramid(capacity, fanout) {}
+
+void ScopeLod::append(uint64_t seq, float y) {
+    m_pyramid.append(seq, LodBucket{y, y, true});
+}
+
+int ScopeLod::pickLevel(uint64_t first, uint64_t last,
+                        size_t maxPoints) const {
+    if (last - first <= maxPoints) return 0;
+    const int top = levels() - 1;
+    for (int level = 1; level < top; ++level) {
+        const uint64_t size = bucketSize(level);
+        const uint64_t buckets = (last - 1) / size - first / size + 1;
+        if (buckets * 2 <= maxPoints) return level;
+    }
+    return top;
+}
+
+void ScopeLod::plotLine(const char* label, const ScopeStore& store,
+                        size_t channel, int64_t origin, double xmin,
+                        double xmax, int pixels) const {
+    if (ScopeGpuLine::usable()) {
+        if (!m_gpu) m_gpu.reset(new ScopeGpuLine(store.capacity()));
+        if (m_gpu->plotLine(label, store, channel, origin, xmin, xmax)) return;
+    } else if (m_gpu) {
+        // 关闭后释放显存
+        m_gpu.reset();
+    }
+    if (store.empty()) return;
+    // 两端各多取一个点，保证曲线延伸到绘图区边缘
+    uint64_t lower = 0;
+    uint64_t upper = 0;
+    store.findRange(origin, xmin, xmax, &lower, &upper);
+    const uint64_t first = lower > store.begin() ? lower - 1 : lower;
+    const uint64_t last = std::min(upper + 1, store.end());
+    if (last <= first) return;
+
+    LodView view{this, &store, channel, origin, 0, first};
+    view.level =
+        pickLevel(first, last, static_cast<size_t>(std::max(pixels, 1)) * 2);
+    if (view.level == 0) {
+        ImPlot::PlotLineG(label, rawGetter, &view,
+                          static_cast<int>(last - first));
+        return;
+    }
+    const uint64_t size = bucketSize(view.level);
+    view.first = first / size;
+    const uint64_t buckets = (last - 1) / size + 1 - view.first;
+    ImPlot::PlotLineG(label, lodGetter, &view, static_cast<int>(buckets) * 2);
+}
+
+};  // namespace MoproboGui
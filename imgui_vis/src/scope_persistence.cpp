@@ -0,0 +1,159 @@
+#include "scope_persistence.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "implot.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace MoproboGui {
+
+ScopePersistence::ScopePersistence(int width, int height)
+    : m_width(std::max(width, 1)),
+      m_height(std::max(height, 1)),
+      m_grid(m_width * m_height, 0) {}
+
+void ScopePersistence::setRange(double xmin, double xmax, double ymin,
+                                double ymax) {
+    if (xmin == m_xmin && xmax == m_xmax && ymin == m_ymin && ymax == m_ymax) {
+        return;
+    }
+    m_xmin = xmin;
+    m_xmax = xmax;
+    m_ymin = ymin;
+    m_ymax = ymax;
+    clear();
+}
+
+void ScopePersistence::clear() {
+    std::fill(m_grid.begin(), m_grid.end(), 0.f);
+    m_peak = 0;
+}
+
+void ScopePersistence::addSpan(int col, int row0, int row1) {
+    if (col < 0 || col >= m_width) return;
+    row0 = std::max(row0, 0);
+    row1 = std::min(row1, m_height - 1);
+    float* p = &m_grid[col * m_height];
+    int r = row0;
+    float peak = m_peak;
+#if defined(__SSE2__)
+    const __m128 one = _mm_set1_ps(1.f);
+    __m128 top = _mm_set1_ps(peak);
+    for (; r + 4 <= row1 + 1; r += 4) {
+        const __m128 v = _mm_add_ps(_mm_loadu_ps(p + r), one);
+        _mm_storeu_ps(p + r, v);
+        top = _mm_max_ps(top, v);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, top);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(__ARM_NEON)
+    const float32x4_t one = vdupq_n_f32(1.f);
+    float32x4_t top = vdupq_n_f32(peak);
+    for (; r + 4 <= row1 + 1; r += 4) {
+        const float32x4_t v = vaddq_f32(vld1q_f32(p + r), one);
+        vst1q_f32(p + r, v);
+        top = vmaxq_f32(top, v);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, top);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; r <= row1; ++r) {
+        p[r] += 1.f;
+        peak = std::max(peak, p[r]);
+    }
+    m_peak = peak;
+}
+
+void ScopePersistence::addSweep(const ScopeStore& store, size_t channel,
+                                int64_t origin) {
+    if (store.empty() || m_xmax <= m_xmin || m_ymax <= m_ymin) return;
+    const int64_t t0 = origin + static_cast<int64_t>(m_xmin * 1e9);
+    const int64_t t1 = origin + static_cast<int64_t>(m_xmax * 1e9);
+    // 两端各多取一个点，让波形连到网格边缘
+    uint64_t first = store.lowerBound(t0);
+    if (first > store.begin()) --first;
+    const uint64_t last = std::min(store.upperBound(t1) + 1, store.end());
+
+    const double colScale = m_width / (m_xmax - m_xmin);
+    const double rowScale = m_height / (m_ymax - m_ymin);
+    auto toCol = [&](int64_t time) {
+        const double x = ((time - origin) * 1e-9 - m_xmin) * colScale;
+        return static_cast<int>(
+            std::floor(std::min(std::max(x, -1.0), double(m_width))));
+    };
+    auto toRow = [&](float value) {
+        const double y = (m_ymax - value) * rowScale;
+        return static_cast<int>(
+            std::min(std::max(y, 0.0), double(m_height - 1)));
+    };
+
+    // 逐列累计行区间，列发生变化时整列写入；跨过的空列按直线插值
+    int col = INT_MIN;
+    int lo = 0, hi = 0, prev = 0;
+    for (uint64_t seq = first; seq < last; ++seq) {
+        const int c = toCol(store.time(seq));
+        const int r = toRow(store.value(seq, channel));
+        if (c == col) {
+            lo = std::min(lo, r);
+            hi = std::max(hi, r);
+        } else {
+            if (col != INT_MIN) {
+                addSpan(col, lo, hi);
+                for (int g = col + 1; g < c; ++g) {
+                    const int a = prev + (r - prev) * (g - col) / (c - col);
+                    const int b = prev + (r - prev) * (g + 1 - col) / (c - col);
+                    addSpan(g, std::min(a, b), std::max(a, b));
+                }
+                // 与前一列的最后一点相连
+                lo = std::min(r, c == col + 1 ? prev : r);
+                hi = std::max(r, c == col + 1 ? prev : r);
+            } else {
+                lo = hi = r;
+            }
+            col = c;
+        }
+        prev = r;
+    }
+    if (col != INT_MIN) addSpan(col, lo, hi);
+}
+
+void ScopePersistence::decay(float factor) {
+    if (factor >= 1.f) return;
+    float* p = m_grid.data();
+    const size_t count = m_grid.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 f = _mm_set1_ps(factor);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(p + i, _mm_mul_ps(_mm_loadu_ps(p + i), f));
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t f = vdupq_n_f32(factor);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(p + i, vmulq_f32(vld1q_f32(p + i), f));
+    }
+#endif
+    for (; i < count; ++i) p[i] *= factor;
+    m_peak *= factor;
+}
+
+void ScopePersistence::plot(const char* label) const {
+    ImPlot::PushColormap(ImPlotColormap_Hot);
+    ImPlot::PlotHeatmap(label, m_grid.data(), m_height, m_width, 0,
+                        std::max(m_peak, 1e-3f), NULL,
+                        ImPlotPoint(m_xmin, m_ymin),
+                        ImPlotPoint(m_xmax, m_ymax),
+                        ImPlotHeatmapFlags_ColMajor);
+    ImPlot::PopColormap();
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,398 @@
+#include "scope_playback.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "implot.h"
+
+namespace MoproboGui {
+
+ScopePlayback::~ScopePlayback() { close(); }
+
+bool ScopePlayback::open(const std::string& path) {
+    close();
+    m_path = path;
+    m_error.clear();
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+        m_error = strerror(errno);
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size < sizeof(RecordFileHeader)) {
+        m_error = "不是录制文件";
+        close();
+        return false;
+    }
+    void* mem = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (mem == MAP_FAILED) {
+        m_error = strerror(errno);
+        close();
+        return false;
+    }
+    // 按可见范围跳着访问，不需要内核预读
+    madvise(mem, m_size, MADV_RANDOM);
+    m_data = static_cast<const unsigned char*>(mem);
+
+    memcpy(&m_header, m_data, sizeof(m_header));
+    if (memcmp(m_header.magic, kRecordMagic, sizeof(kRecordMagic)) != 0 ||
+        m_header.version != kRecordVersion ||
+        m_header.headerSize < sizeof(m_header) ||
+        m_header.headerSize > m_size) {
+        m_error = "不是录制文件或版本不支持";
+        close();
+        return false;
+    }
+    if (!loadIndex()) rebuildIndex();
+
+    m_endTime = m_header.startMono;
+    for (size_t i = 0; i < m_count; ++i) {
+        const RecordIndexEntry& entry = m_entries[i];
+        if (entry.count == 0) {
+            parseStream(entry);
+        } else if (entry.stream < m_streams.size() &&
+                   !m_streams[entry.stream].channels.empty()) {
+            m_streams[entry.stream].blocks.push_back(static_cast<uint32_t>(i));
+            m_endTime = std::max(m_endTime, entry.lastTime);
+        }
+    }
+    m_cache.resize(m_streams.size());
+    for (size_t s = 0; s < m_streams.size(); ++s) {
+        m_cache[s].resize(m_streams[s].channels.size());
+    }
+    return true;
+}
+
+void ScopePlayback::close() {
+    if (m_data != nullptr) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+    m_entries = nullptr;
+    m_count = 0;
+    m_summary = nullptr;
+    m_summaryCount = 0;
+    m_rebuiltEntries.clear();
+    m_rebuiltSummary.clear();
+    m_streams.clear();
+    m_cache.clear();
+}
+
+double ScopePlayback::duration() const {
+    return std::max<int64_t>(m_endTime - m_header.startMono, 0) * 1e-9;
+}
+
+bool ScopePlayback::loadIndex() {
+    if (m_size < m_header.headerSize + sizeof(RecordTrailer)) return false;
+    RecordTrailer trailer;
+    memcpy(&trailer, m_data + m_size - sizeof(trailer), sizeof(trailer));
+    const uint64_t limit = m_size - sizeof(trailer);
+    if (memcmp(trailer.magic, kRecordMagic, sizeof(kRecordMagic)) != 0 ||
+        trailer.indexOffset % 8 != 0 ||
+        trailer.indexOffset + sizeof(RecordBlockHeader) > limit) {
+        return false;
+    }
+    const auto* header = reinterpret_cast<const RecordBlockHeader*>(
+        m_data + trailer.indexOffset);
+    const uint64_t entries =
+        static_cast<uint64_t>(header->count) * sizeof(RecordIndexEntry);
+    if (header->magic != kRecordBlockMagic || header->type != kRecordIndex ||
+        header->payload < entries ||
+        header->payload > limit - trailer.indexOffset - sizeof(*header)) {
+        return false;
+    }
+    m_entries = reinterpret_cast<const RecordIndexEntry*>(header + 1);
+    m_count = header->count;
+    m_summary = reinterpret_cast<const float*>(m_entries + m_count);
+    m_summaryCount = (header->payload - entries) / sizeof(float);
+    return true;
+}
+
+void ScopePlayback::rebuildIndex() {
+    // 没有索引时顺序扫描块头，数据块的摘要需要读取整个文件
+    std::vector<uint32_t> channels;
+    uint64_t offset = recordAlign(m_header.headerSize);
+    while (offset + sizeof(RecordBlockHeader) <= m_size) {
+        const auto* header =
+            reinterpret_cast<const RecordBlockHeader*>(m_data + offset);
+        // 录制中断时最后一块可能不完整
+        if (header->magic != kRecordBlockMagic ||
+            header->payload > m_size - offset - sizeof(*header)) {
+            break;
+        }
+        if (header->type == kRecordIndex) break;
+        if (header->type == kRecordStream && header->payload >= 4) {
+            if (channels.size() <= header->stream) {
+                channels.resize(header->stream + 1, 0);
+            }
+            memcpy(&channels[header->stream], header + 1, sizeof(uint32_t));
+            m_rebuiltEntries.push_back(
+                RecordIndexEntry{header->stream, 0, 0, 0, offset, 0});
+        } else if (header->type == kRecordData && header->count > 0 &&
+                   header->stream < channels.size()) {
+            const RecordIndexEntry entry{header->stream,    header->count,
+                                         header->firstTime, header->lastTime,
+                                         offset, m_rebuiltSummary.size()};
+            const size_t count = channels[header->stream];
+            for (size_t c = 0; c < count; ++c) {
+                const float* values = blockValues(entry, c, count);
+                if (values == nullptr) break;
+                const auto range =
+                    std::minmax_element(values, values + header->count);
+                m_rebuiltSummary.push_back(*range.first);
+                m_rebuiltSummary.push_back(*range.second);
+            }
+            if (m_rebuiltSummary.size() == entry.summary + 2 * count) {
+                m_rebuiltEntries.push_back(entry);
+            } else {
+                m_rebuiltSummary.resize(entry.summary);
+            }
+        }
+        offset += sizeof(*header) + recordAlign(header->payload);
+    }
+    m_entries = m_rebuiltEntries.data();
+    m_count = m_rebuiltEntries.size();
+    m_summary = m_rebuiltSummary.data();
+    m_summaryCount = m_rebuiltSummary.size();
+}
+
+bool ScopePlayback::parseStream(const RecordIndexEntry& entry) {
+    const RecordBlockHeader* header = blockHeader(entry);
+    if (header == nullptr || header->type != kRecordStream) return false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(header + 1);
+    const unsigned char* end = p + header->payload;
+    auto getU32 = [&](uint32_t* value) {
+        if (end - p < 4) return false;
+        memcpy(value, p, sizeof(*value));
+        p += sizeof(*value);
+        return true;
+    };
+    auto getString = [&](std::string* str) {
+        uint32_t len = 0;
+        if (!getU32(&len) || static_cast<uint32_t>(end - p) < len) {
+            return false;
+        }
+        str->assign(reinterpret_cast<const char*>(p), len);
+        p += len;
+        return true;
+    };
+
+    Stream stream;
+    uint32_t channels = 0;
+    if (!getU32(&channels) || channels == 0 || !getString(&stream.window) ||
+        !getString(&stream.plot)) {
+        return false;
+    }
+    stream.channels.resize(channels);
+    for (auto& name : stream.channels) {
+        if (!getString(&name)) return false;
+    }
+    if (m_streams.size() <= entry.stream) m_streams.resize(entry.stream + 1);
+    m_streams[entry.stream] = std::move(stream);
+    return true;
+}
+
+const RecordBlockHeader* ScopePlayback::blockHeader(
+    const RecordIndexEntry& entry) const {
+    if (entry.offset % 8 != 0 ||
+        entry.offset + sizeof(RecordBlockHeader) > m_size) {
+        return nullptr;
+    }
+    const auto* header =
+        reinterpret_cast<const RecordBlockHeader*>(m_data + entry.offset);
+    if (header->magic != kRecordBlockMagic ||
+        header->payload > m_size - entry.offset - sizeof(*header)) {
+        return nullptr;
+    }
+    return header;
+}
+
+const int64_t* ScopePlayback::blockTimes(const RecordIndexEntry& entry) {
+    const RecordBlockHeader* header = blockHeader(entry);
+    if (header == nullptr || header->count != entry.count) return nullptr;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(header + 1);
+    if (!(header->flags & kRecordTimeVarint)) {
+        if (header->payload < entry.count * sizeof(int64_t)) return nullptr;
+        return reinterpret_cast<const int64_t*>(p);
+    }
+    const unsigned char* end = p + header->payload;
+    m_times.resize(entry.count);
+    int64_t time = header->firstTime;
+    m_times[0] = time;
+    for (size_t i = 1; i < entry.count; ++i) {
+        uint64_t delta = 0;
+        int shift = 0;
+        while (p < end && (*p & 0x80) && shift < 63) {
+            delta |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        if (p == end) return nullptr;
+        delta |= static_cast<uint64_t>(*p++) << shift;
+        time += static_cast<int64_t>(delta);
+        m_times[i] = time;
+    }
+    return m_times.data();
+}
+
+const float* ScopePlayback::blockValues(const RecordIndexEntry& entry,
+                                        size_t channel,
+                                        size_t channels) const {
+    const RecordBlockHeader* header = blockHeader(entry);
+    const uint64_t bytes = entry.count * sizeof(float);
+    if (header == nullptr || header->count != entry.count ||
+        header->payload < channels * bytes) {
+        return nullptr;
+    }
+    // 数值列位于负载末尾
+    const unsigned char* values = reinterpret_cast<const unsigned char*>(
+                                      header + 1) +
+                                  header->payload - channels * bytes;
+    return reinterpret_cast<const float*>(values + channel * bytes);
+}
+
+void ScopePlayback::plotLine(const char* label, size_t stream, size_t channel,
+                             double xmin, double xmax, int pixels) {
+    if (!isOpen() || stream >= m_streams.size() ||
+        channel >= m_streams[stream].channels.size()) {
+        return;
+    }
+    Cache& cache = m_cache[stream][channel];
+    pixels = std::max(pixels, 1);
+    if (cache.xmin != xmin || cache.xmax != xmax || cache.pixels != pixels) {
+        cache.xmin = xmin;
+        cache.xmax = xmax;
+        cache.pixels = pixels;
+        cache.xs.clear();
+        cache.ys.clear();
+
+        const Stream& s = m_streams[stream];
+        const int64_t start = m_header.startMono;
+        const int64_t t0 = start + static_cast<int64_t>(std::floor(xmin * 1e9));
+        const int64_t t1 = start + static_cast<int64_t>(std::ceil(xmax * 1e9));
+        // 块按时间排序，二分查找与可见范围相交的块
+        const size_t first =
+            std::partition_point(s.blocks.begin(), s.blocks.end(),
+                                 [&](uint32_t b) {
+                                     return m_entries[b].lastTime < t0;
+                                 }) -
+            s.blocks.begin();
+        const size_t last =
+            std::partition_point(s.blocks.begin(), s.blocks.end(),
+                                 [&](uint32_t b) {
+                                     return m_entries[b].firstTime <= t1;
+                                 }) -
+            s.blocks.begin();
+        if (last > first + static_cast<size_t>(pixels)) {
+            // 可见块多于像素，只用索引中的摘要，按像素合并
+            const size_t group = (last - first + pixels - 1) / pixels;
+            const size_t channels = s.channels.size();
+            for (size_t g = first; g < last; g += group) {
+                const size_t end = std::min(g + group, last);
+                float lo = INFINITY;
+                float hi = -INFINITY;
+                for (size_t b = g; b < end; ++b) {
+                    const RecordIndexEntry& e = m_entries[s.blocks[b]];
+                    if (e.summary + 2 * channels > m_summaryCount) continue;
+                    lo = std::min(lo, m_summary[e.summary + 2 * channel]);
+                    hi = std::max(hi, m_summary[e.summary + 2 * channel + 1]);
+                }
+                if (lo > hi) continue;
+                const int64_t mid = m_entries[s.blocks[g]].firstTime / 2 +
+                                    m_entries[s.blocks[end - 1]].lastTime / 2;
+                const double x = (mid - start) * 1e-9;
+                cache.xs.push_back(x);
+                cache.ys.push_back(lo);
+                cache.xs.push_back(x);
+                cache.ys.push_back(hi);
+            }
+        } else if (last > first) {
+            decimate(s, channel, first, last, t0, t1, pixels, &cache);
+        }
+    }
+    ImPlot::PlotLine(label, cache.xs.data(), cache.ys.data(),
+                     static_cast<int>(cache.xs.size()));
+}
+
+void ScopePlayback::decimate(const Stream& stream, size_t channel,
+                             size_t first, size_t last, int64_t t0,
+                             int64_t t1, int pixels, Cache* cache) {
+    const size_t channels = stream.channels.size();
+    const RecordIndexEntry& head = m_entries[stream.blocks[first]];
+    const RecordIndexEntry& tail = m_entries[stream.blocks[last - 1]];
+    // 首尾块只取可见部分，两端各多取一个点让曲线延伸到边缘
+    size_t headBegin = 0;
+    size_t tailEnd = tail.count;
+    if (const int64_t* times = blockTimes(head)) {
+        headBegin = std::lower_bound(times, times + head.count, t0) - times;
+        if (headBegin > 0) --headBegin;
+    }
+    if (const int64_t* times = blockTimes(tail)) {
+        tailEnd = std::upper_bound(times, times + tail.count, t1) - times;
+        if (tailEnd < tail.count) ++tailEnd;
+    }
+    uint64_t total = 0;
+    for (size_t b = first; b < last; ++b) {
+        total += m_entries[stream.blocks[b]].count;
+    }
+    total -= headBegin + (tail.count - tailEnd);
+    // 点数不超过两倍像素时直接绘制原始数据，否则每组输出min/max两点
+    const uint64_t bucket =
+        total <= 2 * static_cast<uint64_t>(pixels)
+            ? 1
+            : (total + pixels - 1) / static_cast<uint64_t>(pixels);
+
+    const int64_t start = m_header.startMono;
+    uint64_t fill = 0;
+    size_t loAt = 0, hiAt = 0;
+    int64_t loTime = 0, hiTime = 0;
+    float lo = 0, hi = 0;
+    auto flush = [&]() {
+        if (fill == 0) return;
+        const bool loFirst = loAt <= hiAt;
+        cache->xs.push_back(((loFirst ? loTime : hiTime) - start) * 1e-9);
+        cache->ys.push_back(loFirst ? lo : hi);
+        if (bucket > 1) {
+            cache->xs.push_back(((loFirst ? hiTime : loTime) - start) * 1e-9);
+            cache->ys.push_back(loFirst ? hi : lo);
+        }
+        fill = 0;
+    };
+    size_t order = 0;
+    for (size_t b = first; b < last; ++b) {
+        const RecordIndexEntry& entry = m_entries[stream.blocks[b]];
+        const float* values = blockValues(entry, channel, channels);
+        const int64_t* times = values ? blockTimes(entry) : nullptr;
+        if (times == nullptr) continue;
+        const size_t begin = b == first ? headBegin : 0;
+        const size_t end = b == last - 1 ? tailEnd : entry.count;
+        for (size_t i = begin; i < end; ++i, ++order) {
+            const float v = values[i];
+            if (fill == 0 || v < lo) {
+                lo = v;
+                loTime = times[i];
+                loAt = order;
+            }
+            if (fill == 0 || v > hi) {
+                hi = v;
+                hiTime = times[i];
+                hiAt = order;
+            }
+            if (++fill == bucket) flush();
+        }
+    }
+    flush();
+}
+
+};  // namespace MoproboGui
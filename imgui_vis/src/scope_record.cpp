@@ -0,0 +1,372 @@
+#include "scope_record.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+namespace MoproboGui {
+
+constexpr size_t ScopeRecorder::kBlockSamples;
+
+namespace {
+
+// 写缓冲大小，写线程攒满后一次写盘
+constexpr size_t kOutBytes = 4 << 20;
+
+int64_t clockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void putString(std::string* out, const std::string& str) {
+    const uint32_t len = static_cast<uint32_t>(str.size());
+    out->append(reinterpret_cast<const char*>(&len), sizeof(len));
+    out->append(str);
+}
+
+size_t blockBytes(size_t count, size_t channels) {
+    return count * (sizeof(int64_t) + channels * sizeof(float));
+}
+
+};  // namespace
+
+void ScopeRecorder::OutDeleter::operator()(unsigned char* p) const { free(p); }
+
+ScopeRecorder::ScopeRecorder(const RecordConfig& config) : m_config(config) {}
+
+ScopeRecorder::~ScopeRecorder() { stop(); }
+
+bool ScopeRecorder::start(const std::string& path) {
+    if (recording()) return false;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        m_error = path + ": " + strerror(errno);
+        return false;
+    }
+    m_fd = fd;
+    m_offset = 0;
+    m_index.clear();
+    m_summary.clear();
+    m_error.clear();
+    m_quit = false;
+    m_written = 0;
+    m_dropped = 0;
+    m_failed = false;
+    reserve(kOutBytes);
+
+    RecordFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kRecordMagic, sizeof(header.magic));
+    header.version = kRecordVersion;
+    header.headerSize = sizeof(header);
+    header.startMono = clockNs(CLOCK_MONOTONIC);
+    header.startReal = clockNs(CLOCK_REALTIME);
+    memcpy(m_out.get(), &header, sizeof(header));
+    m_outSize = sizeof(header);
+    m_offset = sizeof(header);
+
+    m_thread = std::thread([this] { run(); });
+    return true;
+}
+
+void ScopeRecorder::stop() {
+    if (!recording()) return;
+    for (auto& stream : m_streams) {
+        if (stream.pending) submit(std::move(stream.pending));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+    m_streams.clear();
+}
+
+std::string ScopeRecorder::error() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+uint32_t ScopeRecorder::addStream(const std::string& window,
+                                  const std::string& plot,
+                                  const std::vector<std::string>& channels) {
+    const uint32_t id = static_cast<uint32_t>(m_streams.size());
+    const uint32_t count =
+        static_cast<uint32_t>(std::max<size_t>(channels.size(), 1));
+    m_streams.push_back(Stream{count, nullptr, {}});
+
+    auto block = takeBlock(id, count);
+    block->type = kRecordStream;
+    block->meta.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    putString(&block->meta, window);
+    putString(&block->meta, plot);
+    for (uint32_t c = 0; c < count; ++c) {
+        putString(&block->meta, c < channels.size() ? channels[c] : plot);
+    }
+    submit(std::move(block));
+    return id;
+}
+
+void ScopeRecorder::removeStream(uint32_t stream) {
+    if (stream >= m_streams.size()) return;
+    Stream& s = m_streams[stream];
+    if (s.pending) submit(std::move(s.pending));
+    s.removed = true;
+}
+
+std::unique_ptr<ScopeRecorder::Block> ScopeRecorder::takeBlock(
+    uint32_t stream, uint32_t channels) {
+    std::unique_ptr<Block> block;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty()) {
+            block = std::move(m_free.back());
+            m_free.pop_back();
+        }
+    }
+    if (!block) block.reset(new Block());
+    block->type = kRecordData;
+    block->stream = stream;
+    block->channels = channels;
+    block->count = 0;
+    block->meta.clear();
+    block->times.resize(kBlockSamples);
+    block->values.resize(channels * kBlockSamples);
+    return block;
+}
+
+void ScopeRecorder::capture(uint32_t stream, const ScopeStore& store,
+                            uint64_t from) {
+    if (!recording() || stream >= m_streams.size()) return;
+    Stream& s = m_streams[stream];
+    if (s.removed) return;
+    // 一次取出的数据超过存储容量时，被淘汰的部分已无法录制
+    uint64_t seq = std::max(from, store.begin());
+    while (seq < store.end()) {
+        if (!s.pending) {
+            s.pending = takeBlock(stream, s.channels);
+            s.since = std::chrono::steady_clock::now();
+        }
+        Block& block = *s.pending;
+        const size_t n = std::min<uint64_t>(store.end() - seq,
+                                            kBlockSamples - block.count);
+        store.copyTimes(seq, n, &block.times[block.count]);
+        for (uint32_t c = 0; c < s.channels; ++c) {
+            store.copyValues(c, seq, n,
+                             &block.values[c * kBlockSamples + block.count]);
+        }
+        block.count += n;
+        seq += n;
+        if (block.count == kBlockSamples) submit(std::move(s.pending));
+    }
+}
+
+void ScopeRecorder::poll() {
+    if (!recording()) return;
+    const auto now = std::chrono::steady_clock::now();
+    const auto timeout = std::chrono::duration<double>(m_config.flushSeconds);
+    for (auto& stream : m_streams) {
+        if (stream.pending && now - stream.since >= timeout) {
+            submit(std::move(stream.pending));
+        }
+    }
+}
+
+void ScopeRecorder::submit(std::unique_ptr<Block> block) {
+    const size_t bytes =
+        blockBytes(block->count, block->channels) + block->meta.size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Stream块必须写入，否则后续数据无法解析
+        if (block->type == kRecordData &&
+            m_queuedBytes + bytes > m_config.queueBytes) {
+            m_dropped += block->count;
+            m_free.push_back(std::move(block));
+            return;
+        }
+        m_queuedBytes += bytes;
+        m_queue.push_back(std::move(block));
+    }
+    m_cond.notify_one();
+}
+
+void ScopeRecorder::run() {
+    std::deque<std::unique_ptr<Block>> jobs;
+    bool quit = false;
+    while (!quit) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+            std::swap(jobs, m_queue);
+            quit = m_quit && jobs.empty();
+        }
+        size_t bytes = 0;
+        for (auto& block : jobs) {
+            if (m_fd >= 0) {
+                encode(*block);
+            } else {
+                m_dropped += block->count;  // 写文件出错后丢弃
+            }
+            bytes +=
+                blockBytes(block->count, block->channels) + block->meta.size();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queuedBytes -= bytes;
+        for (auto& block : jobs) {
+            m_free.push_back(std::move(block));
+        }
+        jobs.clear();
+    }
+    if (m_fd < 0) return;
+
+    // 索引和文件尾
+    RecordBlockHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kRecordBlockMagic;
+    header.type = kRecordIndex;
+    header.count = static_cast<uint32_t>(m_index.size());
+    header.payload = m_index.size() * sizeof(RecordIndexEntry) +
+                     m_summary.size() * sizeof(float);
+    RecordTrailer trailer;
+    trailer.indexOffset = m_offset;
+    memcpy(trailer.magic, kRecordMagic, sizeof(trailer.magic));
+    const uint64_t zero = 0;
+    append(&header, sizeof(header));
+    append(m_index.data(), m_index.size() * sizeof(RecordIndexEntry));
+    append(m_summary.data(), m_summary.size() * sizeof(float));
+    append(&zero, recordAlign(header.payload) - header.payload);
+    append(&trailer, sizeof(trailer));
+    flushOut();
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+}
+
+void ScopeRecorder::reserve(size_t bytes) {
+    if (m_outSize + bytes > m_outCapacity) flushOut();
+    if (bytes > m_outCapacity) {
+        void* mem = nullptr;
+        const size_t capacity = std::max(bytes, kOutBytes);
+        if (posix_memalign(&mem, 4096, capacity) != 0) throw std::bad_alloc();
+        m_out.reset(static_cast<unsigned char*>(mem));
+        m_outCapacity = capacity;
+    }
+}
+
+void ScopeRecorder::append(const void* data, size_t bytes) {
+    const unsigned char* src = static_cast<const unsigned char*>(data);
+    m_offset += bytes;
+    while (bytes > 0) {
+        if (m_outSize == m_outCapacity) flushOut();
+        const size_t n = std::min(bytes, m_outCapacity - m_outSize);
+        memcpy(m_out.get() + m_outSize, src, n);
+        m_outSize += n;
+        src += n;
+        bytes -= n;
+    }
+}
+
+void ScopeRecorder::flushOut() {
+    size_t done = 0;
+    while (done < m_outSize && m_fd >= 0) {
+        const ssize_t n = ::write(m_fd, m_out.get() + done, m_outSize - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = strerror(errno);
+            }
+            ::close(m_fd);
+            m_fd = -1;
+            // 只计入真正写到文件里的部分
+            m_written.store(m_offset - (m_outSize - done),
+                            std::memory_order_relaxed);
+            m_failed.store(true, std::memory_order_relaxed);
+            break;
+        }
+        done += n;
+    }
+    if (m_fd >= 0) m_written.store(m_offset, std::memory_order_relaxed);
+    m_outSize = 0;
+}
+
+void ScopeRecorder::encode(const Block& block) {
+    RecordBlockHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kRecordBlockMagic;
+    header.type = block.type;
+    header.stream = block.stream;
+    header.count = static_cast<uint32_t>(block.count);
+    if (block.type == kRecordStream) {
+        header.payload = block.meta.size();
+        const size_t size = sizeof(header) + recordAlign(header.payload);
+        reserve(size);
+        unsigned char* out = m_out.get() + m_outSize;
+        memset(out, 0, size);
+        memcpy(out, &header, sizeof(header));
+        memcpy(out + sizeof(header), block.meta.data(), block.meta.size());
+        m_index.push_back(
+            RecordIndexEntry{block.stream, 0, 0, 0, m_offset, 0});
+        m_outSize += size;
+        m_offset += size;
+        return;
+    }
+    if (block.count == 0) return;
+
+    header.firstTime = block.times[0];
+    header.lastTime = block.times[block.count - 1];
+    // varint最长10字节，按最坏情况预留
+    const size_t maxTimes = m_config.compressTimes
+                                ? recordAlign(block.count * 10)
+                                : block.count * sizeof(int64_t);
+    const size_t valueBytes = block.count * block.channels * sizeof(float);
+    reserve(sizeof(header) + maxTimes + valueBytes);
+    unsigned char* out = m_out.get() + m_outSize;
+    unsigned char* p = out + sizeof(header);
+    if (m_config.compressTimes) {
+        header.flags |= kRecordTimeVarint;
+        for (size_t i = 1; i < block.count; ++i) {
+            uint64_t delta = block.times[i] - block.times[i - 1];
+            while (delta >= 0x80) {
+                *p++ = static_cast<unsigned char>(delta | 0x80);
+                delta >>= 7;
+            }
+            *p++ = static_cast<unsigned char>(delta);
+        }
+        while ((p - out) & 7) *p++ = 0;
+    } else {
+        memcpy(p, block.times.data(), block.count * sizeof(int64_t));
+        p += block.count * sizeof(int64_t);
+    }
+    for (uint32_t c = 0; c < block.channels; ++c) {
+        memcpy(p, &block.values[c * kBlockSamples],
+               block.count * sizeof(float));
+        p += block.count * sizeof(float);
+    }
+    header.payload = (p - out) - sizeof(header);
+    const size_t size = sizeof(header) + recordAlign(header.payload);
+    while (static_cast<size_t>(p - out) < size) *p++ = 0;
+    memcpy(out, &header, sizeof(header));
+
+    m_index.push_back(RecordIndexEntry{block.stream, header.count,
+                                       header.firstTime, header.lastTime,
+                                       m_offset, m_summary.size()});
+    for (uint32_t c = 0; c < block.channels; ++c) {
+        const auto range =
+            std::minmax_element(&block.values[c * kBlockSamples],
+                                &block.values[c * kBlockSamples] + block.count);
+        m_summary.push_back(*range.first);
+        m_summary.push_back(*range.second);
+    }
+    m_outSize += size;
+    m_offset += size;
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,254 @@
+#include "scope_spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "imgui.h"
+#include "implot.h"
+
+namespace MoproboGui {
+
+constexpr size_t ScopeSpectrum::kMinSize;
+constexpr size_t ScopeSpectrum::kMaxSize;
+constexpr size_t ScopeSpectrum::kWaterfallCols;
+
+ScopeSpectrum::ScopeSpectrum() { m_thread = std::thread([this] { run(); }); }
+
+ScopeSpectrum::~ScopeSpectrum() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+void ScopeSpectrum::reset() {
+    m_resetPending = true;
+    m_lastEnd = 0;
+}
+
+bool ScopeSpectrum::submit(const ScopeStore& store, size_t channel) {
+    size_t size = std::min(std::max(m_config.size, kMinSize), kMaxSize);
+    // 不是2的幂时向下取整
+    while (size & (size - 1)) size &= size - 1;
+    if (store.size() < size) return false;
+
+    const uint64_t end = store.end();
+    if (end < m_lastEnd) m_lastEnd = 0;  // 信号源被清空
+    const float overlap = std::min(std::max(m_config.overlap, 0.f), 0.95f);
+    const uint64_t hop = std::max<uint64_t>(size * (1 - overlap), 1);
+    if (m_lastEnd != 0 && end - m_lastEnd < hop) return false;
+
+    const uint64_t first = end - size;
+    const int64_t span = store.time(end - 1) - store.time(first);
+    if (span <= 0) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_busy || m_hasJob) return false;
+        m_job.samples.resize(size);
+        store.copyValues(channel, first, size, m_job.samples.data());
+        m_job.rate = (size - 1) * 1e9 / span;
+        m_job.config = m_config;
+        m_job.config.size = size;
+        m_job.reset = m_resetPending;
+        m_hasJob = true;
+    }
+    m_cond.notify_one();
+    m_resetPending = false;
+    m_lastEnd = end;
+    return true;
+}
+
+void ScopeSpectrum::run() {
+    Job job;
+    Result result;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this] { return m_quit || m_hasJob; });
+            if (m_quit) return;
+            // 交换而不拷贝，两边的缓冲轮流使用
+            std::swap(job, m_job);
+            m_hasJob = false;
+            m_busy = true;
+        }
+        analyze(job, &result);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(result, m_ready);
+            m_fresh = true;
+            m_busy = false;
+        }
+    }
+}
+
+void ScopeSpectrum::prepare(const Job& job) {
+    const size_t n = job.samples.size();
+    const size_t bins = n / 2 + 1;
+    const bool shape = !m_fft || m_fft->size() != n ||
+                       m_windowType != job.config.window;
+    if (shape) {
+        m_fft.reset(new RealFft(n));
+        m_windowType = job.config.window;
+        m_window.resize(n);
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const double a = 2 * M_PI * i / n;
+            double w = 1;
+            if (m_windowType == SpectrumWindow::Hann) {
+                w = 0.5 - 0.5 * std::cos(a);
+            } else if (m_windowType == SpectrumWindow::Blackman) {
+                w = 0.42 - 0.5 * std::cos(a) + 0.08 * std::cos(2 * a);
+            }
+            m_window[i] = static_cast<float>(w);
+            sum += w;
+        }
+        // 单边幅度谱的归一化系数，正弦波峰值即为其幅值
+        m_windowGain = static_cast<float>(2 / sum);
+        m_input.resize(n);
+        m_re.resize(bins);
+        m_im.resize(bins);
+    }
+    const int rows = std::max(job.config.waterfallRows, 1);
+    if (shape || job.reset || rows != m_waterfallRows) {
+        m_power.assign(bins, 0);
+        m_peak.assign(bins, -1e30f);
+        m_averaged = 0;
+        m_waterfallRows = rows;
+        m_rows.assign(rows * kWaterfallCols, 0);
+        m_rowCount = 0;
+        m_rowHead = 0;
+    }
+}
+
+void ScopeSpectrum::analyze(const Job& job, Result* out) {
+    prepare(job);
+    const size_t n = job.samples.size();
+    const size_t bins = n / 2 + 1;
+    for (size_t i = 0; i < n; ++i) {
+        m_input[i] = job.samples[i] * m_window[i];
+    }
+    m_fft->forward(m_input.data(), m_re.data(), m_im.data());
+
+    m_averaged = std::min(m_averaged + 1, std::max(job.config.averages, 1));
+    const float alpha = 1.f / m_averaged;
+    const float gain2 = m_windowGain * m_windowGain;
+    out->average.resize(bins);
+    for (size_t k = 0; k < bins; ++k) {
+        float p = (m_re[k] * m_re[k] + m_im[k] * m_im[k]) * gain2;
+        // 直流和奈奎斯特频点没有对称的负频率分量
+        if (k == 0 || k == bins - 1) p *= 0.25f;
+        m_power[k] += (p - m_power[k]) * alpha;
+        const float db = 10 * std::log10(m_power[k] + 1e-30f);
+        out->average[k] = db;
+        m_peak[k] = std::max(m_peak[k], db);
+    }
+    out->peakHold = job.config.peakHold;
+    if (out->peakHold) {
+        out->peak = m_peak;
+    } else {
+        std::copy(out->average.begin(), out->average.end(), m_peak.begin());
+        out->peak.clear();
+    }
+
+    // 瀑布图新的一行，多个频点合并为一列时取最大值
+    const size_t cols = std::min(bins, kWaterfallCols);
+    float* row = &m_rows[m_rowHead * kWaterfallCols];
+    for (size_t c = 0; c < cols; ++c) {
+        const size_t b0 = c * bins / cols;
+        const size_t b1 = std::max((c + 1) * bins / cols, b0 + 1);
+        row[c] = *std::max_element(&out->average[b0], &out->average[b1]);
+    }
+    m_rowHead = (m_rowHead + 1) % m_waterfallRows;
+    m_rowCount = std::min(m_rowCount + 1, m_waterfallRows);
+
+    out->waterfall.resize(m_rowCount * cols);
+    for (int r = 0; r < m_rowCount; ++r) {
+        const int src = (m_rowHead - 1 - r + m_waterfallRows) % m_waterfallRows;
+        std::copy(&m_rows[src * kWaterfallCols],
+                  &m_rows[src * kWaterfallCols] + cols,
+                  &out->waterfall[r * cols]);
+    }
+    out->rows = m_rowCount;
+    out->cols = static_cast<int>(cols);
+    out->rate = job.rate;
+    out->bins = bins;
+}
+
+void ScopeSpectrum::show(const char* title) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_fresh) {
+            std::swap(m_front, m_ready);
+            m_fresh = false;
+        }
+    }
+    const Result& res = m_front;
+    if (res.bins == 0) {
+        ImGui::TextUnformatted("等待数据...");
+        return;
+    }
+    const double binHz = res.rate / ((res.bins - 1) * 2);
+    const size_t top = std::max_element(res.average.begin() + 1,
+                                        res.average.end()) -
+                       res.average.begin();
+    ImGui::Text("采样率 %.1f Hz  分辨率 %.3f Hz  峰值 %.2f Hz / %.1f dB",
+                res.rate, binHz, top * binHz, res.average[top]);
+
+    if (ImPlot::BeginPlot(title, ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("Hz", "dB");
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, res.rate / 2, ImGuiCond_Once);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, m_config.minDb, m_config.maxDb,
+                                ImGuiCond_Once);
+        // 按可见频段和绘图区宽度合并频点，每组取最大值以保留谱峰
+        const ImPlotRect limits = ImPlot::GetPlotLimits();
+        const int pixels = std::max(static_cast<int>(ImPlot::GetPlotSize().x),
+                                    1);
+        const size_t first = static_cast<size_t>(std::min<double>(
+            std::max(limits.X.Min / binHz, 0.0), res.bins - 1));
+        const size_t last = static_cast<size_t>(std::min<double>(
+            std::max(limits.X.Max / binHz + 2, first + 1.0), res.bins));
+        const size_t step = std::max<size_t>((last - first) / pixels, 1);
+        m_plotX.clear();
+        m_plotY.clear();
+        m_plotPeak.clear();
+        for (size_t b = first; b < last; b += step) {
+            const size_t e = std::min(b + step, last);
+            const auto it = std::max_element(&res.average[b], &res.average[e]);
+            m_plotX.push_back(static_cast<float>((it - &res.average[0]) *
+                                                 binHz));
+            m_plotY.push_back(*it);
+            if (res.peakHold) {
+                m_plotPeak.push_back(
+                    *std::max_element(&res.peak[b], &res.peak[e]));
+            }
+        }
+        const int count = static_cast<int>(m_plotX.size());
+        ImPlot::PlotLine("平均", m_plotX.data(), m_plotY.data(), count);
+        if (res.peakHold) {
+            ImPlot::PlotLine("峰值保持", m_plotX.data(), m_plotPeak.data(),
+                             count);
+        }
+        ImPlot::EndPlot();
+    }
+
+    char waterfall[128];
+    snprintf(waterfall, sizeof(waterfall), "##%s_waterfall", title);
+    if (ImPlot::BeginPlot(waterfall, ImVec2(-1, 150))) {
+        ImPlot::SetupAxes("Hz", "帧", ImPlotAxisFlags_None,
+                          ImPlotAxisFlags_None);
+        ImPlot::SetupAxesLimits(0, res.rate / 2, -m_config.waterfallRows, 0,
+                                ImGuiCond_Always);
+        ImPlot::PushColormap(ImPlotColormap_Viridis);
+        ImPlot::PlotHeatmap("##waterfall", res.waterfall.data(), res.rows,
+                            res.cols, m_config.minDb, m_config.maxDb, NULL,
+                            ImPlotPoint(0, -res.rows),
+                            ImPlotPoint(res.rate / 2, 0));
+        ImPlot::PopColormap();
+        ImPlot::EndPlot();
+    }
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,198 @@
+#include "scope_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MoproboGui {
+
+constexpr size_t ScopeStats::kStride;
+
+namespace {
+
+// 区间内n个点的均值、RMS、标准差，sum和sumSq按x - offset累计
+void moments(double offset, double sum, double sumSq, size_t n,
+             StatsResult* result) {
+    const double mean = sum / n;
+    const double var = std::max(sumSq / n - mean * mean, 0.0);
+    result->mean = offset + mean;
+    result->stddev = std::sqrt(var);
+    result->rms = std::sqrt(var + result->mean * result->mean);
+}
+
+// 首尾两个上升沿之间的平均频率
+double edgeFrequency(uint64_t edges, int64_t first, int64_t last) {
+    if (edges < 2 || last <= first) return 0;
+    return (edges - 1) / ((last - first) * 1e-9);
+}
+
+}  // namespace
+
+ScopeStats::ScopeStats(const ScopeStore* store, const ScopeLod* lod,
+                       size_t channel)
+    : m_store(store),
+      m_lod(lod),
+      m_channel(channel),
+      m_prefix(store->capacity() / kStride + 2) {
+    restart();
+}
+
+void ScopeStats::restart() {
+    m_start = m_end = m_store->begin();
+    m_count = 0;
+    m_mean = m_m2 = 0;
+    m_min = m_max = 0;
+    m_offset = 0;
+    m_total = Prefix{0, 0};
+    m_high = false;
+    m_edges.clear();
+    m_edgeCount = 0;
+    m_firstEdge = m_lastEdge = 0;
+}
+
+void ScopeStats::update() {
+    const ScopeStore& store = *m_store;
+    if (m_end > store.end()) {
+        // 信号源被清空，会话重新开始
+        restart();
+    } else if (m_end < store.begin()) {
+        // 未处理的数据已被淘汰，跳过，前缀和从这里重新有效
+        m_start = m_end = store.begin();
+    }
+    for (uint64_t seq = m_end; seq < store.end(); ++seq) {
+        const float x = store.value(seq, m_channel);
+        if (m_count == 0) {
+            m_offset = x;
+            m_min = m_max = x;
+        }
+        if (seq % kStride == 0) {
+            m_prefix[(seq / kStride) % m_prefix.size()] = m_total;
+        }
+        const double d = x - m_offset;
+        m_total.sum += d;
+        m_total.sumSq += d * d;
+
+        ++m_count;
+        const double delta = x - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (x - m_mean);
+        m_min = std::min(m_min, x);
+        m_max = std::max(m_max, x);
+
+        // 迟滞取标准差的10%，避免噪声在电平附近产生多余的沿
+        const double hysteresis = 0.1 * std::sqrt(m_m2 / m_count);
+        if (m_high) {
+            m_high = x >= m_mean - hysteresis;
+        } else if (x > m_mean + hysteresis) {
+            m_high = true;
+            const int64_t time = store.time(seq);
+            m_edges.push_back(time);
+            if (m_edgeCount++ == 0) m_firstEdge = time;
+            m_lastEdge = time;
+        }
+    }
+    m_end = store.end();
+    if (!store.empty()) {
+        const int64_t oldest = store.time(store.begin());
+        while (!m_edges.empty() && m_edges.front() < oldest) {
+            m_edges.pop_front();
+        }
+    }
+}
+
+StatsResult ScopeStats::session() const {
+    StatsResult ret;
+    if (m_count == 0) return ret;
+    ret.count = m_count;
+    ret.min = m_min;
+    ret.max = m_max;
+    ret.mean = m_mean;
+    const double var = m_m2 / m_count;
+    ret.stddev = std::sqrt(var);
+    ret.rms = std::sqrt(var + m_mean * m_mean);
+    ret.frequency = edgeFrequency(m_edgeCount, m_firstEdge, m_lastEdge);
+    return ret;
+}
+
+StatsResult ScopeStats::window(int64_t t0, int64_t t1) const {
+    StatsResult ret;
+    const ScopeStore& store = *m_store;
+    const uint64_t first =
+        std::max(store.lowerBound(t0), std::max(m_start, store.begin()));
+    const uint64_t last = std::min(store.upperBound(t1), m_end);
+    if (first >= last) return ret;
+    ret.count = static_cast<size_t>(last - first);
+
+    Prefix sum{0, 0};
+    auto raw = [&](uint64_t from, uint64_t to) {
+        for (uint64_t seq = from; seq < to; ++seq) {
+            const double d = store.value(seq, m_channel) - m_offset;
+            sum.sum += d;
+            sum.sumSq += d * d;
+        }
+    };
+    const uint64_t ka = (first + kStride - 1) / kStride;
+    const uint64_t kb = last / kStride;
+    if (ka < kb) {
+        const Prefix a = prefix(ka);
+        const Prefix b = prefix(kb);
+        sum.sum = b.sum - a.sum;
+        sum.sumSq = b.sumSq - a.sumSq;
+        raw(first, ka * kStride);
+        raw(kb * kStride, last);
+    } else {
+        raw(first, last);
+    }
+    moments(m_offset, sum.sum, sum.sumSq, ret.count, &ret);
+    rangeMinMax(first, last, &ret.min, &ret.max);
+
+    const auto begin = std::lower_bound(m_edges.begin(), m_edges.end(), t0);
+    const auto end = std::upper_bound(begin, m_edges.end(), t1);
+    if (begin != end) {
+        ret.frequency = edgeFrequency(end - begin, *begin, *(end - 1));
+    }
+    return ret;
+}
+
+ScopeStats::Prefix ScopeStats::prefix(uint64_t k) const {
+    if (k * kStride == m_end) return m_total;
+    return m_prefix[k % m_prefix.size()];
+}
+
+void ScopeStats::rangeMinMax(uint64_t first, uint64_t last, float* lo,
+                             float* hi) const {
+    *lo = *hi = m_store->value(first, m_channel);
+    auto visit = [&](int level, uint64_t pos) {
+        if (level == 0) {
+            const float v = m_store->value(pos, m_channel);
+            *lo = std::min(*lo, v);
+            *hi = std::max(*hi, v);
+        } else {
+            const LodBucket b =
+                m_lod->bucket(level, pos / m_lod->bucketSize(level));
+            *lo = std::min(*lo, b.lo);
+            *hi = std::max(*hi, b.hi);
+        }
+    };
+    // 从最细的一层开始，把两端不对齐上一层桶边界的部分逐个取出，
+    // 剩下的区间两端都对齐上一层，再到上一层继续
+    const int top = m_lod->levels() - 1;
+    uint64_t a = first;
+    uint64_t b = last;
+    int level = 0;
+    for (; level < top && a < b; ++level) {
+        const uint64_t size = m_lod->bucketSize(level);
+        const uint64_t next = m_lod->bucketSize(level + 1);
+        while (a < b && a % next != 0) {
+            visit(level, a);
+            a += size;
+        }
+        while (a < b && b % next != 0) {
+            b -= size;
+            visit(level, b);
+        }
+    }
+    const uint64_t size = m_lod->bucketSize(level);
+    for (; a < b; a += size) visit(level, a);
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,213 @@
+#include "scope_store.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+namespace MoproboGui {
+
+constexpr size_t ScopeStore::kChunkSamples;
+
+void ScopeStore::ChunkDeleter::operator()(Chunk* chunk) const { free(chunk); }
+
+ScopeStore::ScopeStore(const ScopeCapacity& capacity, size_t channels)
+    : m_channels(std::max<size_t>(channels, 1)),
+      m_chunkBytes(kTimeBytes + m_channels * kValueBytes),
+      m_retainNs(static_cast<int64_t>(capacity.seconds * 1e9)),
+      m_chunks(std::max<size_t>(capacity.bytes / m_chunkBytes, 2)) {}
+
+ScopeStore::Chunk* ScopeStore::beginChunk(uint64_t index) {
+    auto& slot = m_chunks[index % m_chunks.size()];
+    if (!slot && !m_spare.empty()) {
+        slot = std::move(m_spare.back());
+        m_spare.pop_back();
+    }
+    if (!slot) {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, 64, m_chunkBytes) != 0) {
+            throw std::bad_alloc();
+        }
+        slot.reset(static_cast<Chunk*>(mem));
+    }
+    // 复用最旧的块，整块淘汰
+    if (index >= m_chunks.size()) {
+        m_begin =
+            std::max(m_begin, (index - m_chunks.size() + 1) * kChunkSamples);
+    }
+    return slot.get();
+}
+
+void ScopeStore::evictExpired() {
+    if (m_retainNs <= 0 || empty()) return;
+    const int64_t latest = time(m_end - 1);
+    // 按块淘汰超出保留时长的数据，当前写入的块不淘汰
+    for (;;) {
+        const uint64_t next = (m_begin / kChunkSamples + 1) * kChunkSamples;
+        if (next >= m_end || time(next - 1) >= latest - m_retainNs) break;
+        // 被淘汰的块交给后续写入复用，内存随保留时长而非容量增长
+        m_spare.push_back(std::move(
+            m_chunks[(m_begin / kChunkSamples) % m_chunks.size()]));
+        m_begin = next;
+    }
+}
+
+void ScopeStore::append(int64_t time, float value) {
+    append(&time, &value, 1);
+}
+
+void ScopeStore::append(const ScopeSample* samples, size_t count) {
+    appendBlock(count, [samples](Chunk* chunk, size_t offset, size_t n,
+                                 size_t done, int64_t& last) {
+        int64_t* times = timeColumn(chunk) + offset;
+        float* values = valueColumn(chunk, 0) + offset;
+        for (size_t i = 0; i < n; ++i) {
+            last = std::max(last, samples[done + i].time);
+            times[i] = last;
+            values[i] = samples[done + i].value;
+        }
+    });
+}
+
+void ScopeStore::append(const int64_t* times, const float* values,
+                        size_t count) {
+    appendBlock(count, [times, values](Chunk* chunk, size_t offset, size_t n,
+                                       size_t done, int64_t& last) {
+        memcpy(valueColumn(chunk, 0) + offset, values + done,
+               n * sizeof(float));
+        int64_t* dst = timeColumn(chunk) + offset;
+        for (size_t i = 0; i < n; ++i) {
+            last = std::max(last, times[done + i]);
+            dst[i] = last;
+        }
+    });
+}
+
+uint64_t ScopeStore::appendTimes(const int64_t* times, size_t count) {
+    const uint64_t seq = m_end;
+    appendBlock(count, [times](Chunk* chunk, size_t offset, size_t n,
+                               size_t done, int64_t& last) {
+        int64_t* dst = timeColumn(chunk) + offset;
+        for (size_t i = 0; i < n; ++i) {
+            last = std::max(last, times[done + i]);
+            dst[i] = last;
+        }
+    });
+    return seq;
+}
+
+void ScopeStore::writeValues(size_t channel, uint64_t seq,
+                             const float* values, size_t count) {
+    // 跳过写入期间已被淘汰的行
+    if (seq < m_begin) {
+        const size_t skip = std::min<uint64_t>(m_begin - seq, count);
+        seq += skip;
+        values += skip;
+        count -= skip;
+    }
+    while (count > 0) {
+        const size_t offset = seq % kChunkSamples;
+        const size_t n = std::min(count, kChunkSamples - offset);
+        memcpy(valueColumn(chunk(seq), channel) + offset, values,
+               n * sizeof(float));
+        seq += n;
+        values += n;
+        count -= n;
+    }
+}
+
+void ScopeStore::copyTimes(uint64_t seq, size_t count, int64_t* dst) const {
+    while (count > 0) {
+        const size_t offset = seq % kChunkSamples;
+        const size_t n = std::min(count, kChunkSamples - offset);
+        memcpy(dst, timeColumn(chunk(seq)) + offset, n * sizeof(int64_t));
+        seq += n;
+        dst += n;
+        count -= n;
+    }
+}
+
+void ScopeStore::copyValues(size_t channel, uint64_t seq, size_t count,
+                            float* dst) const {
+    while (count > 0) {
+        const size_t offset = seq % kChunkSamples;
+        const size_t n = std::min(count, kChunkSamples - offset);
+        memcpy(dst, valueColumn(chunk(seq), channel) + offset,
+               n * sizeof(float));
+        seq += n;
+        dst += n;
+        count -= n;
+    }
+}
+
+template <typename Func>
+void ScopeStore::appendBlock(size_t count, Func&& fill) {
+    // 时间戳回退时钳位到上一个点，保证存储内时间有序
+    int64_t last = empty() ? INT64_MIN : time(m_end - 1);
+    size_t done = 0;
+    while (done < count) {
+        const uint64_t index = m_end / kChunkSamples;
+        const size_t offset = m_end % kChunkSamples;
+        Chunk* chunk = offset == 0 ? beginChunk(index) : this->chunk(m_end);
+        const size_t n = std::min(count - done, kChunkSamples - offset);
+        fill(chunk, offset, n, done, last);
+        m_end += n;
+        done += n;
+    }
+    evictExpired();
+}
+
+void ScopeStore::clear() { m_begin = m_end = 0; }
+
+size_t ScopeStore::memoryUsage() const {
+    size_t ret = 0;
+    for (const auto& chunk : m_chunks) {
+        if (chunk) ret += m_chunkBytes;
+    }
+    return ret + m_spare.size() * m_chunkBytes;
+}
+
+uint64_t ScopeStore::lowerBound(int64_t time) const {
+    uint64_t first = m_begin;
+    uint64_t count = m_end - m_begin;
+    while (count > 0) {
+        const uint64_t step = count / 2;
+        if (this->time(first + step) < time) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+uint64_t ScopeStore::upperBound(int64_t time) const {
+    uint64_t first = m_begin;
+    uint64_t count = m_end - m_begin;
+    while (count > 0) {
+        const uint64_t step = count / 2;
+        if (this->time(first + step) <= time) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+void ScopeStore::findRange(int64_t origin, double xmin, double xmax,
+                           uint64_t* first, uint64_t* last) const {
+    // 先在double中截断到不会使origin + ns溢出的范围
+    auto toNs = [](double ns) {
+        return static_cast<int64_t>(std::max(-4e18, std::min(ns, 4e18)));
+    };
+    *first = lowerBound(origin + toNs(std::floor(xmin * 1e9)));
+    *last = upperBound(origin + toNs(std::ceil(xmax * 1e9)));
+}
+
+};  // namespace MoproboGui
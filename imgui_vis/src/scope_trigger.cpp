@@ -0,0 +1,188 @@
+#include "scope_trigger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MoproboGui {
+
+static int64_t toNs(double seconds) {
+    return static_cast<int64_t>(std::llround(seconds * 1e9));
+}
+
+void ScopeTrigger::arm() {
+    m_havePrev = false;
+    m_inPulse = false;
+    m_state = State::Armed;
+}
+
+void ScopeTrigger::stop() { m_state = State::Stopped; }
+
+void ScopeTrigger::reset() {
+    m_havePrev = false;
+    m_inPulse = false;
+    m_hasCapture = false;
+    m_traceCount = 0;
+    if (m_state == State::Triggered) m_state = State::Armed;
+}
+
+bool ScopeTrigger::detect(int64_t time, float value, int64_t* when) {
+    const TriggerConfig& cfg = m_config;
+    if (!m_havePrev) {
+        m_belowArmed = value < cfg.level - cfg.hysteresis;
+        m_aboveArmed = value > cfg.level + cfg.hysteresis;
+        m_wasInside = value >= std::min(cfg.level, cfg.level2) &&
+                      value <= std::max(cfg.level, cfg.level2);
+    }
+
+    // 与level的交叉，回差用于抑制噪声引起的重复触发
+    const bool rising = m_havePrev && m_belowArmed && value >= cfg.level;
+    const bool falling = m_havePrev && m_aboveArmed && value <= cfg.level;
+    if (rising) m_belowArmed = false;
+    if (falling) m_aboveArmed = false;
+    if (value < cfg.level - cfg.hysteresis) m_belowArmed = true;
+    if (value > cfg.level + cfg.hysteresis) m_aboveArmed = true;
+
+    int64_t cross = time;
+    if ((rising || falling) && value != m_prevValue) {
+        const double ratio = (cfg.level - m_prevValue) / (value - m_prevValue);
+        cross = m_prevTime + static_cast<int64_t>(
+                                 std::max(0.0, std::min(ratio, 1.0)) *
+                                 static_cast<double>(time - m_prevTime));
+    }
+
+    bool fired = false;
+    switch (cfg.type) {
+        case TriggerType::Edge:
+            fired = (rising && cfg.slope != TriggerSlope::Falling) ||
+                    (falling && cfg.slope != TriggerSlope::Rising);
+            *when = cross;
+            break;
+        case TriggerType::Level:
+            fired = cfg.slope == TriggerSlope::Falling ? value <= cfg.level
+                                                       : value >= cfg.level;
+            *when = time;
+            break;
+        case TriggerType::PulseWidth: {
+            // Rising为正脉冲(上升沿开始、下降沿结束)，Falling为负脉冲
+            const bool start =
+                (rising && cfg.slope != TriggerSlope::Falling) ||
+                (falling && cfg.slope != TriggerSlope::Rising);
+            const bool end = m_inPulse && (m_pulsePositive ? falling : rising);
+            if (end) {
+                const int64_t width = cross - m_pulseStart;
+                fired = width >= toNs(cfg.minWidth) &&
+                        width <= toNs(cfg.maxWidth);
+                m_inPulse = false;
+                *when = cross;
+            } else if (start) {
+                m_inPulse = true;
+                m_pulsePositive = rising;
+                m_pulseStart = cross;
+            }
+            break;
+        }
+        case TriggerType::Window: {
+            const bool inside = value >= std::min(cfg.level, cfg.level2) &&
+                                value <= std::max(cfg.level, cfg.level2);
+            const bool exit = m_havePrev && m_wasInside && !inside;
+            const bool enter = m_havePrev && !m_wasInside && inside;
+            fired = (exit && cfg.slope != TriggerSlope::Falling) ||
+                    (enter && cfg.slope != TriggerSlope::Rising);
+            m_wasInside = inside;
+            *when = time;
+            break;
+        }
+    }
+
+    m_havePrev = true;
+    m_prevTime = time;
+    m_prevValue = value;
+    return fired;
+}
+
+ScopeTrigger::Trace::Trace(const std::string& name, size_t capacity)
+    : name(name),
+      store(ScopeCapacity{capacity * (sizeof(int64_t) + sizeof(float)), 0}),
+      lod(store.capacity()) {}
+
+bool ScopeTrigger::process(const ScopeStore& store, size_t channel,
+                           uint64_t first, uint64_t last,
+                           std::vector<int64_t>* captures) {
+    const int64_t post = toNs(m_config.postTrigger);
+    bool captured = false;
+    for (uint64_t seq = std::max(first, store.begin()); seq < last; ++seq) {
+        const int64_t time = store.time(seq);
+        int64_t when = time;
+        const bool fired = detect(time, store.value(seq, channel), &when);
+        if (fired && m_state == State::Armed) {
+            m_state = State::Triggered;
+            m_triggerTime = when;
+            ++m_count;
+        }
+        if (m_state == State::Triggered && time >= m_triggerTime + post) {
+            m_hasCapture = true;
+            m_captureTime = m_triggerTime;
+            captured = true;
+            if (captures != nullptr) captures->push_back(m_triggerTime);
+            m_state = m_config.mode == TriggerMode::Single ? State::Stopped
+                                                           : State::Armed;
+        }
+    }
+    return captured;
+}
+
+void ScopeTrigger::beginCapture() { m_traceCount = 0; }
+
+void ScopeTrigger::capture(const std::string& name, const ScopeStore& store,
+                           size_t channel) {
+    // 容量与信号源相同，画面内的数据一定放得下
+    if (m_traceCount == m_traces.size() ||
+        m_traces[m_traceCount]->store.capacity() < store.capacity()) {
+        m_traces.resize(std::max(m_traces.size(), m_traceCount + 1));
+        m_traces[m_traceCount].reset(new Trace(name, store.capacity()));
+    }
+    Trace& trace = *m_traces[m_traceCount++];
+    trace.name = name;
+    trace.store.clear();
+    // 两端各多取一个点，曲线延伸到画面边缘
+    uint64_t lower = 0;
+    uint64_t upper = 0;
+    store.findRange(m_captureTime, -m_config.preTrigger, m_config.postTrigger,
+                    &lower, &upper);
+    const uint64_t first = lower > store.begin() ? lower - 1 : lower;
+    const uint64_t last = std::min(upper + 1, store.end());
+    m_times.resize(ScopeStore::kChunkSamples);
+    m_values.resize(ScopeStore::kChunkSamples);
+    for (uint64_t seq = first; seq < last;) {
+        const size_t n = static_cast<size_t>(
+            std::min<uint64_t>(last - seq, ScopeStore::kChunkSamples));
+        store.copyTimes(seq, n, m_times.data());
+        store.copyValues(channel, seq, n, m_values.data());
+        const uint64_t base = trace.store.end();
+        trace.store.append(m_times.data(), m_values.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            trace.lod.append(base + i, m_values[i]);
+        }
+        seq += n;
+    }
+}
+
+void ScopeTrigger::plotCapture(double xmin, double xmax, int pixels) const {
+    if (!m_hasCapture) return;
+    for (size_t i = 0; i < m_traceCount; ++i) {
+        const Trace& trace = *m_traces[i];
+        trace.lod.plotLine(trace.name.c_str(), trace.store, 0, m_captureTime,
+                           xmin, xmax, pixels);
+    }
+}
+
+bool ScopeTrigger::showCapture(int64_t latest) const {
+    if (!m_hasCapture) return false;
+    if (m_config.mode != TriggerMode::Auto) return true;
+    // 自动方式下超时未再触发则恢复滚动显示
+    const double span = m_config.preTrigger + m_config.postTrigger;
+    return latest - m_captureTime <=
+           toNs(m_config.postTrigger + std::max(span, 0.1));
+}
+
+};  // namespace MoproboGui
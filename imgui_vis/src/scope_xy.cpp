@@ -0,0 +1,167 @@
+#include "scope_xy.h"
+
+#include <algorithm>
+
+#include "implot.h"
+
+namespace MoproboGui {
+
+namespace {
+
+struct RawView {
+    const ScopeStore* store;
+    uint64_t first;
+};
+
+ImPlotPoint rawGetter(int idx, void* data) {
+    const auto& view = *static_cast<const RawView*>(data);
+    const uint64_t seq = view.first + idx;
+    return ImPlotPoint(view.store->value(seq, 0), view.store->value(seq, 1));
+}
+
+}  // namespace
+
+void ScopeXY::Bucket::merge(const Bucket& later) {
+    // 相等时保留先出现的点
+    if (later.p[0].x < p[0].x) p[0] = later.p[0];
+    if (later.p[1].x > p[1].x) p[1] = later.p[1];
+    if (later.p[2].y < p[2].y) p[2] = later.p[2];
+    if (later.p[3].y > p[3].y) p[3] = later.p[3];
+}
+
+ScopeXY::ScopeXY(const ScopeStore* x, size_t xChannel, const ScopeStore* y,
+                 size_t yChannel, const ScopeCapacity& capacity, int fanout)
+    : m_buffer(capacity, 2), m_lod(m_buffer.capacity(), fanout) {
+    m_x.store = x;
+    m_x.channel = xChannel;
+    m_x.next = x->begin();
+    m_y.store = y;
+    m_y.channel = yChannel;
+    m_y.next = y->begin();
+    m_times.reserve(ScopeStore::kChunkSamples);
+    m_xs.reserve(ScopeStore::kChunkSamples);
+    m_ys.reserve(ScopeStore::kChunkSamples);
+}
+
+void ScopeXY::resync(Cursor* cursor) {
+    const ScopeStore& store = *cursor->store;
+    if (cursor->next > store.end()) {
+        // 信号源被清空，两路都从头开始对齐
+        m_x.next = m_x.store->begin();
+        m_y.next = m_y.store->begin();
+        m_x.valid = m_y.valid = false;
+        m_times.clear();
+        m_xs.clear();
+        m_ys.clear();
+        m_buffer.clear();
+    } else if (cursor->next < store.begin()) {
+        cursor->next = store.begin();
+        cursor->valid = false;
+    }
+}
+
+float ScopeXY::interpolate(const Cursor& cursor, int64_t time, float next,
+                           int64_t nextTime) {
+    const double t = static_cast<double>(time - cursor.time) /
+                     static_cast<double>(nextTime - cursor.time);
+    return static_cast<float>(cursor.value + (next - cursor.value) * t);
+}
+
+size_t ScopeXY::update() {
+    resync(&m_x);
+    resync(&m_y);
+    const uint64_t start = m_buffer.end();
+    const ScopeStore& xs = *m_x.store;
+    const ScopeStore& ys = *m_y.store;
+    // 两路都有下一个点时才能确定先后，并在另一路的前后两点之间插值
+    while (m_x.next < xs.end() && m_y.next < ys.end()) {
+        const int64_t tx = xs.time(m_x.next);
+        const int64_t ty = ys.time(m_y.next);
+        const float vx = xs.value(m_x.next, m_x.channel);
+        const float vy = ys.value(m_y.next, m_y.channel);
+        if (tx <= ty) {
+            if (tx == ty) {
+                emit(tx, vx, vy);
+            } else if (m_y.valid) {
+                emit(tx, vx, interpolate(m_y, tx, vy, ty));
+            }
+            m_x.valid = true;
+            m_x.time = tx;
+            m_x.value = vx;
+            ++m_x.next;
+        }
+        if (ty <= tx) {
+            if (ty != tx && m_x.valid) {
+                emit(ty, interpolate(m_x, ty, vx, tx), vy);
+            }
+            m_y.valid = true;
+            m_y.time = ty;
+            m_y.value = vy;
+            ++m_y.next;
+        }
+    }
+    flush();
+    return static_cast<size_t>(m_buffer.end() - start);
+}
+
+void ScopeXY::emit(int64_t time, float x, float y) {
+    m_times.push_back(time);
+    m_xs.push_back(x);
+    m_ys.push_back(y);
+    if (m_times.size() == ScopeStore::kChunkSamples) flush();
+}
+
+void ScopeXY::flush() {
+    const size_t n = m_times.size();
+    if (n == 0) return;
+    const uint64_t seq = m_buffer.appendTimes(m_times.data(), n);
+    m_buffer.writeValues(0, seq, m_xs.data(), n);
+    m_buffer.writeValues(1, seq, m_ys.data(), n);
+    for (size_t i = 0; i < n; ++i) {
+        const Point point{m_xs[i], m_ys[i], seq + i};
+        m_lod.append(seq + i, Bucket{{point, point, point, point}});
+    }
+    m_times.clear();
+    m_xs.clear();
+    m_ys.clear();
+}
+
+void ScopeXY::plotLine(const char* label, int64_t origin, double tmin,
+                       double tmax, size_t maxPoints) const {
+    if (m_buffer.empty()) return;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    m_buffer.findRange(origin, tmin, tmax, &first, &last);
+    if (last <= first) return;
+    if (last - first <= maxPoints) {
+        RawView view{&m_buffer, first};
+        ImPlot::PlotLineG(label, rawGetter, &view,
+                          static_cast<int>(last - first));
+        return;
+    }
+    // 每个桶最多输出4个点
+    const int top = m_lod.levels() - 1;
+    int level = 1;
+    for (; level < top; ++level) {
+        const uint64_t size = m_lod.bucketSize(level);
+        if (((last - 1) / size - first / size + 1) * 4 <= maxPoints) break;
+    }
+    const uint64_t size = m_lod.bucketSize(level);
+    m_plotX.clear();
+    m_plotY.clear();
+    for (uint64_t index = first / size; index <= (last - 1) / size; ++index) {
+        Bucket b = m_lod.bucket(level, index);
+        std::sort(b.p, b.p + 4, [](const Point& l, const Point& r) {
+            return l.seq < r.seq;
+        });
+        for (int i = 0; i < 4; ++i) {
+            if (i > 0 && b.p[i].seq == b.p[i - 1].seq) continue;
+            m_plotX.push_back(b.p[i].x);
+            m_plotY.push_back(b.p[i].y);
+        }
+    }
+    ImPlot::PlotLine(label, m_plotX.data(), m_plotY.data(),
+                     static_cast<int>(m_plotX.size()));
+}
+
+};  // namespace MoproboGui
@@ -0,0 +1,253 @@
+#include "soft_raster.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "imgui.h"
+
+namespace MoproboGui {
+
+namespace {
+
+// 有向边a->b与点p的叉积，三角形已调整为正面积
+inline float edge(float ax, float ay, float bx, float by, float px,
+                  float py) {
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// 点正好落在边上时只算入一侧的三角形，相邻三角形的公共边不会重复混合；
+// 公共边在两个三角形中方向相反，判定结果正好相反
+inline bool ownsEdge(float ax, float ay, float bx, float by) {
+    return by > ay || (by == ay && bx < ax);
+}
+
+uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void putBe32(std::vector<uint8_t>* out, uint32_t v) {
+    out->push_back(static_cast<uint8_t>(v >> 24));
+    out->push_back(static_cast<uint8_t>(v >> 16));
+    out->push_back(static_cast<uint8_t>(v >> 8));
+    out->push_back(static_cast<uint8_t>(v));
+}
+
+void putChunk(std::vector<uint8_t>* out, const char* type,
+              const std::vector<uint8_t>& data) {
+    putBe32(out, static_cast<uint32_t>(data.size()));
+    const size_t start = out->size();
+    out->insert(out->end(), type, type + 4);
+    out->insert(out->end(), data.begin(), data.end());
+    putBe32(out, crc32(out->data() + start, out->size() - start));
+}
+
+}  // namespace
+
+SoftRasterizer::SoftRasterizer(int width, int height)
+    : m_width(width), m_height(height), m_pixels(width * height * 3) {}
+
+void SoftRasterizer::setFontTexture(void* id, const unsigned char* rgba,
+                                    int width, int height) {
+    m_fontId = id;
+    m_font = rgba;
+    m_fontWidth = width;
+    m_fontHeight = height;
+}
+
+void SoftRasterizer::clear(float r, float g, float b) {
+    const uint8_t rgb[3] = {static_cast<uint8_t>(r * 255 + 0.5f),
+                            static_cast<uint8_t>(g * 255 + 0.5f),
+                            static_cast<uint8_t>(b * 255 + 0.5f)};
+    for (size_t i = 0; i < m_pixels.size(); i += 3) {
+        memcpy(&m_pixels[i], rgb, 3);
+    }
+}
+
+void SoftRasterizer::render(const ImDrawData* drawData) {
+    const ImVec2 pos = drawData->DisplayPos;
+    const ImVec2 scale = drawData->FramebufferScale;
+    std::vector<Vertex> vertices;
+    for (int n = 0; n < drawData->CmdListsCount; ++n) {
+        const ImDrawList* list = drawData->CmdLists[n];
+        vertices.resize(list->VtxBuffer.Size);
+        for (int i = 0; i < list->VtxBuffer.Size; ++i) {
+            const ImDrawVert& src = list->VtxBuffer[i];
+            Vertex& dst = vertices[i];
+            dst.x = (src.pos.x - pos.x) * scale.x;
+            dst.y = (src.pos.y - pos.y) * scale.y;
+            dst.u = src.uv.x;
+            dst.v = src.uv.y;
+            for (int c = 0; c < 4; ++c) {
+                dst.color[c] = ((src.col >> (8 * c)) & 0xff) / 255.f;
+            }
+        }
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            // 回调通常直接调用图形接口，软件光栅化时跳过
+            if (cmd.UserCallback != nullptr) continue;
+            int clip[4] = {
+                std::max(0, static_cast<int>((cmd.ClipRect.x - pos.x) *
+                                             scale.x)),
+                std::max(0, static_cast<int>((cmd.ClipRect.y - pos.y) *
+                                             scale.y)),
+                std::min(m_width, static_cast<int>(std::ceil(
+                                      (cmd.ClipRect.z - pos.x) * scale.x))),
+                std::min(m_height, static_cast<int>(std::ceil(
+                                       (cmd.ClipRect.w - pos.y) * scale.y))),
+            };
+            if (clip[2] <= clip[0] || clip[3] <= clip[1]) continue;
+            const bool textured =
+                m_font != nullptr && cmd.GetTexID() == m_fontId;
+            const ImDrawIdx* idx = list->IdxBuffer.Data + cmd.IdxOffset;
+            for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                drawTriangle(vertices[cmd.VtxOffset + idx[i]],
+                             vertices[cmd.VtxOffset + idx[i + 1]],
+                             vertices[cmd.VtxOffset + idx[i + 2]], textured,
+                             clip);
+            }
+        }
+    }
+}
+
+void SoftRasterizer::drawTriangle(const Vertex& a, const Vertex& b0,
+                                  const Vertex& c0, bool textured,
+                                  const int clip[4]) {
+    float area = edge(a.x, a.y, b0.x, b0.y, c0.x, c0.y);
+    if (area == 0) return;
+    // 统一为正面积，两种绕序都能绘制
+    const Vertex& b = area > 0 ? b0 : c0;
+    const Vertex& c = area > 0 ? c0 : b0;
+    area = std::fabs(area);
+
+    const int x0 = std::max(
+        clip[0], static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))));
+    const int y0 = std::max(
+        clip[1], static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))));
+    const int x1 = std::min(
+        clip[2], static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))));
+    const int y1 = std::min(
+        clip[3], static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))));
+    const bool ownA = ownsEdge(b.x, b.y, c.x, c.y);
+    const bool ownB = ownsEdge(c.x, c.y, a.x, a.y);
+    const bool ownC = ownsEdge(a.x, a.y, b.x, b.y);
+    const float inv = 1.f / area;
+
+    for (int y = y0; y < y1; ++y) {
+        const float py = y + 0.5f;
+        uint8_t* row = &m_pixels[(static_cast<size_t>(y) * m_width) * 3];
+        for (int x = x0; x < x1; ++x) {
+            const float px = x + 0.5f;
+            const float wa = edge(b.x, b.y, c.x, c.y, px, py);
+            const float wb = edge(c.x, c.y, a.x, a.y, px, py);
+            const float wc = edge(a.x, a.y, b.x, b.y, px, py);
+            if (wa < 0 || wb < 0 || wc < 0) continue;
+            if ((wa == 0 && !ownA) || (wb == 0 && !ownB) ||
+                (wc == 0 && !ownC)) {
+                continue;
+            }
+            const float la = wa * inv;
+            const float lb = wb * inv;
+            const float lc = wc * inv;
+            float color[4];
+            for (int k = 0; k < 4; ++k) {
+                color[k] = a.color[k] * la + b.color[k] * lb + c.color[k] * lc;
+            }
+            if (textured) {
+                const float u = a.u * la + b.u * lb + c.u * lc;
+                const float v = a.v * la + b.v * lb + c.v * lc;
+                const int tx = std::min(
+                    m_fontWidth - 1,
+                    std::max(0, static_cast<int>(u * m_fontWidth)));
+                const int ty = std::min(
+                    m_fontHeight - 1,
+                    std::max(0, static_cast<int>(v * m_fontHeight)));
+                const unsigned char* texel =
+                    m_font + (static_cast<size_t>(ty) * m_fontWidth + tx) * 4;
+                for (int k = 0; k < 4; ++k) color[k] *= texel[k] / 255.f;
+            }
+            const float alpha = color[3];
+            if (alpha <= 0) continue;
+            uint8_t* dst = row + x * 3;
+            for (int k = 0; k < 3; ++k) {
+                const float mixed =
+                    color[k] * 255.f * alpha + dst[k] * (1.f - alpha);
+                dst[k] = static_cast<uint8_t>(
+                    std::min(255.f, std::max(0.f, mixed + 0.5f)));
+            }
+        }
+    }
+}
+
+bool SoftRasterizer::writePng(const std::string& path,
+                              std::string* error) const {
+    // 不压缩的zlib流：每行前加滤波类型0，按不超过65535字节分成存储块
+    std::vector<uint8_t> raw;
+    const size_t stride = static_cast<size_t>(m_width) * 3;
+    raw.reserve((stride + 1) * m_height);
+    for (int y = 0; y < m_height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), m_pixels.begin() + y * stride,
+                   m_pixels.begin() + (y + 1) * stride);
+    }
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    size_t done = 0;
+    do {
+        const size_t n = std::min<size_t>(raw.size() - done, 65535);
+        zlib.push_back(done + n == raw.size() ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(n));
+        zlib.push_back(static_cast<uint8_t>(n >> 8));
+        zlib.push_back(static_cast<uint8_t>(~n));
+        zlib.push_back(static_cast<uint8_t>(~n >> 8));
+        zlib.insert(zlib.end(), raw.begin() + done, raw.begin() + done + n);
+        done += n;
+    } while (done < raw.size());
+    uint32_t s1 = 1;
+    uint32_t s2 = 0;
+    for (uint8_t byte : raw) {
+        s1 = (s1 + byte) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    putBe32(&zlib, (s2 << 16) | s1);
+
+    std::vector<uint8_t> header;
+    putBe32(&header, static_cast<uint32_t>(m_width));
+    putBe32(&header, static_cast<uint32_t>(m_height));
+    // 8位RGB，默认压缩、滤波方式，不隔行
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+
+    std::vector<uint8_t> out = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    putChunk(&out, "IHDR", header);
+    putChunk(&out, "IDAT", zlib);
+    putChunk(&out, "IEND", std::vector<uint8_t>());
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        if (error) *error = path + ": " + strerror(errno);
+        return false;
+    }
+    const bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (fclose(file) != 0 || !ok) {
+        if (error) *error = path + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+};  // namespace MoproboGui
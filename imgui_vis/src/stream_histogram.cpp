@@ -0,0 +1,215 @@
+#include "stream_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace MoproboGui {
+
+namespace {
+
+// 细分桶的边界位置限制在[0, bins]内
+size_t clampEdge(double edge, size_t bins) {
+    if (!(edge > 0)) return 0;
+    if (edge >= static_cast<double>(bins)) return bins;
+    return static_cast<size_t>(edge);
+}
+
+}  // namespace
+
+StreamHistogram::StreamHistogram(const StreamHistogramConfig& config)
+    : m_initMin(config.min),
+      m_min(config.min),
+      m_counts(std::max<size_t>(2, (config.bins + 1) & ~size_t(1))),
+      m_ring(config.window),
+      m_windowCounts(config.window > 0 ? m_counts.size() : 0) {
+    const double span = config.max > config.min ? config.max - config.min : 1;
+    m_initWidth = span / m_counts.size();
+    m_width = m_initWidth;
+    m_inv = 1 / m_width;
+    m_maxWidth = std::ldexp(m_width, static_cast<int>(
+                                         std::min<size_t>(config.maxGrow, 64)));
+}
+
+size_t StreamHistogram::bin(double value) const {
+    // 调用前已保证value在[min(), max())内，只需处理舍入到bins()的情况
+    const size_t b = static_cast<size_t>((value - m_min) * m_inv);
+    return std::min(b, m_counts.size() - 1);
+}
+
+bool StreamHistogram::grow(bool up) {
+    // 加倍后范围超出double时同样视为到达上限
+    const double span = 2 * m_width * m_counts.size();
+    if (2 * m_width > m_maxWidth || !std::isfinite(m_min - span) ||
+        !std::isfinite(m_min + span)) {
+        return false;
+    }
+    const size_t half = m_counts.size() / 2;
+    const auto merge = [&](std::vector<uint64_t>& counts) {
+        if (counts.empty()) return;
+        if (up) {
+            for (size_t i = 0; i < half; ++i) {
+                counts[i] = counts[2 * i] + counts[2 * i + 1];
+            }
+            std::fill(counts.begin() + half, counts.end(), 0);
+        } else {
+            // 从高到低写，目标位置不会覆盖尚未读取的桶
+            for (size_t i = half; i-- > 0;) {
+                counts[half + i] = counts[2 * i] + counts[2 * i + 1];
+            }
+            std::fill(counts.begin(), counts.begin() + half, 0);
+        }
+    };
+    merge(m_counts);
+    merge(m_windowCounts);
+    const uint32_t offset = up ? 0 : static_cast<uint32_t>(half);
+    for (size_t i = 0; i < m_ringSize; ++i) {
+        if (m_ring[i] < kUnderflow) m_ring[i] = offset + m_ring[i] / 2;
+    }
+    if (!up) m_min -= m_width * m_counts.size();
+    m_width *= 2;
+    m_inv = 1 / m_width;
+    return true;
+}
+
+void StreamHistogram::add(double value) {
+    if (!std::isfinite(value)) return;
+    // 加倍到上限也容不下的点直接计为溢出，不为它放大桶宽
+    const double maxSpan = m_maxWidth * m_counts.size();
+    bool fits = value >= max() - maxSpan && value < m_min + maxSpan;
+    while (fits && value < m_min) fits = grow(false);
+    while (fits && value >= max()) fits = grow(true);
+    uint32_t b;
+    if (fits) {
+        b = static_cast<uint32_t>(bin(value));
+        ++m_counts[b];
+    } else if (value < m_min) {
+        b = kUnderflow;
+        ++m_underflow;
+    } else {
+        b = kOverflow;
+        ++m_overflow;
+    }
+    ++m_total;
+    if (m_ring.empty()) return;
+    if (m_ringSize == m_ring.size()) {
+        const uint32_t old = m_ring[m_ringPos];
+        if (old == kUnderflow) {
+            --m_windowUnderflow;
+        } else if (old == kOverflow) {
+            --m_windowOverflow;
+        } else {
+            --m_windowCounts[old];
+        }
+    } else {
+        ++m_ringSize;
+    }
+    m_ring[m_ringPos] = b;
+    if (b == kUnderflow) {
+        ++m_windowUnderflow;
+    } else if (b == kOverflow) {
+        ++m_windowOverflow;
+    } else {
+        ++m_windowCounts[b];
+    }
+    if (++m_ringPos == m_ring.size()) m_ringPos = 0;
+}
+
+void StreamHistogram::add(const float* values, size_t n) {
+    for (size_t i = 0; i < n; ++i) add(static_cast<double>(values[i]));
+}
+
+void StreamHistogram::add(const double* values, size_t n) {
+    for (size_t i = 0; i < n; ++i) add(values[i]);
+}
+
+void StreamHistogram::clear() {
+    m_min = m_initMin;
+    m_width = m_initWidth;
+    m_inv = 1 / m_width;
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    std::fill(m_windowCounts.begin(), m_windowCounts.end(), 0);
+    m_total = 0;
+    m_underflow = m_overflow = 0;
+    m_windowUnderflow = m_windowOverflow = 0;
+    m_ringPos = 0;
+    m_ringSize = 0;
+}
+
+uint64_t StreamHistogram::count(bool windowed) const {
+    return windowed && !m_ring.empty() ? m_ringSize : m_total;
+}
+
+const std::vector<uint64_t>& StreamHistogram::counts(bool windowed) const {
+    return windowed && !m_ring.empty() ? m_windowCounts : m_counts;
+}
+
+uint64_t StreamHistogram::underflow(bool windowed) const {
+    return windowed && !m_ring.empty() ? m_windowUnderflow : m_underflow;
+}
+
+uint64_t StreamHistogram::overflow(bool windowed) const {
+    return windowed && !m_ring.empty() ? m_windowOverflow : m_overflow;
+}
+
+bool StreamHistogram::moments(bool windowed, double* mean,
+                              double* stddev) const {
+    const std::vector<uint64_t>& counts = this->counts(windowed);
+    // 溢出的点没有落在桶内，不参与估计
+    const uint64_t n =
+        count(windowed) - underflow(windowed) - overflow(windowed);
+    if (n == 0) return false;
+    // 以桶号计算，最后再换算成数值，避免范围偏离零点时损失精度
+    double sum = 0;
+    double sumSq = 0;
+    for (size_t b = 0; b < counts.size(); ++b) {
+        const double x = b + 0.5;
+        sum += counts[b] * x;
+        sumSq += counts[b] * x * x;
+    }
+    const double m = sum / n;
+    *mean = m_min + m * m_width;
+    *stddev = std::sqrt(std::max(sumSq / n - m * m, 0.0)) * m_width;
+    return true;
+}
+
+void StreamHistogram::merge(bool windowed, double lo, double hi, int bars,
+                            HistogramBars* out) const {
+    const std::vector<uint64_t>& counts = this->counts(windowed);
+    const size_t n = counts.size();
+    out->centers.clear();
+    out->counts.clear();
+    out->width = 0;
+    out->lastWidth = 0;
+
+    size_t first = 0;
+    size_t last = n;
+    if (lo < hi) {
+        first = clampEdge(std::floor((lo - m_min) * m_inv), n);
+        last = std::max(first, clampEdge(std::ceil((hi - m_min) * m_inv), n));
+    } else {
+        while (first < n && counts[first] == 0) ++first;
+        while (last > first && counts[last - 1] == 0) --last;
+    }
+    out->below = underflow(windowed) +
+                 std::accumulate(counts.begin(), counts.begin() + first,
+                                 uint64_t(0));
+    out->above = overflow(windowed) +
+                 std::accumulate(counts.begin() + last, counts.end(),
+                                 uint64_t(0));
+    if (first == last || bars <= 0) return;
+
+    const size_t group =
+        (last - first + static_cast<size_t>(bars) - 1) / bars;
+    out->width = group * m_width;
+    for (size_t b = first; b < last; b += group) {
+        // 最后一组可能不足group个桶，中心按实际覆盖的桶计算
+        const size_t end = std::min(b + group, last);
+        out->centers.push_back(m_min + (b + end) * 0.5 * m_width);
+        out->lastWidth = (end - b) * m_width;
+        out->counts.push_back(static_cast<double>(std::accumulate(
+            counts.begin() + b, counts.begin() + end, uint64_t(0))));
+    }
+}
+
+};  // namespace MoproboGui
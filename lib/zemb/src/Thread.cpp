@@ -30,6 +30,7 @@
 #include <unistd.h>
 
 #include <chrono>
+#include <thread>
 
 #include "Tracer.h"
 